@@ -0,0 +1,109 @@
+#ifndef AFINA_KEY_HASH_H
+#define AFINA_KEY_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace Afina {
+
+// Building blocks of KeyHash
+namespace KeyHashImpl {
+
+static const uint64_t Secret0 = 0xa0761d6478bd642full;
+static const uint64_t Secret1 = 0xe7037ed1a0b428dbull;
+static const uint64_t Secret2 = 0x8ebc6af09c88c6e3ull;
+static const uint64_t Secret3 = 0x589965cc75374cc3ull;
+
+inline void mum(uint64_t &a, uint64_t &b) {
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    a = static_cast<uint64_t>(r);
+    b = static_cast<uint64_t>(r >> 64);
+}
+
+inline uint64_t mix(uint64_t a, uint64_t b) {
+    mum(a, b);
+    return a ^ b;
+}
+
+inline uint64_t read8(const uint8_t *p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+inline uint64_t read4(const uint8_t *p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+// 1 to 3 bytes: first, middle and last one
+inline uint64_t read3(const uint8_t *p, std::size_t size) {
+    return (uint64_t(p[0]) << 16) | (uint64_t(p[size >> 1]) << 8) | p[size - 1];
+}
+
+} // namespace KeyHashImpl
+
+/**
+ * # Hash of the storage key
+ * Fast non-cryptographic hash from the wyhash family: short keys are read with a few overlapping loads,
+ * longer ones are consumed 16 or 48 bytes at a time, every step is a single 64x64->128 bit multiplication.
+ * All bits of the result are well mixed, so storages may take shard from the low bits and fingerprint
+ * from the high ones of the same value.
+ *
+ * Protocol parser computes it once per key and passes it down along with the key, storages use the same
+ * function for keys that come without hash. Result isn't stable across versions, never persist it
+ */
+inline std::size_t KeyHash(const char *data, std::size_t size) {
+    using namespace KeyHashImpl;
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(data);
+    uint64_t seed = mix(Secret0, Secret1);
+    uint64_t a, b;
+    if (size <= 16) {
+        if (size >= 4) {
+            // Two overlapping pairs of 4 byte reads cover any size from 4 to 16
+            std::size_t shift = (size >> 3) << 2;
+            a = (read4(p) << 32) | read4(p + shift);
+            b = (read4(p + size - 4) << 32) | read4(p + size - 4 - shift);
+        } else if (size > 0) {
+            a = read3(p, size);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        std::size_t left = size;
+        if (left > 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = mix(read8(p) ^ Secret1, read8(p + 8) ^ seed);
+                see1 = mix(read8(p + 16) ^ Secret2, read8(p + 24) ^ see1);
+                see2 = mix(read8(p + 32) ^ Secret3, read8(p + 40) ^ see2);
+                p += 48;
+                left -= 48;
+            } while (left > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (left > 16) {
+            seed = mix(read8(p) ^ Secret1, read8(p + 8) ^ seed);
+            p += 16;
+            left -= 16;
+        }
+        // Last 16 bytes, might overlap with the ones consumed already
+        a = read8(p + left - 16);
+        b = read8(p + left - 8);
+    }
+    a ^= Secret1;
+    b ^= seed;
+    mum(a, b);
+    return static_cast<std::size_t>(mix(a ^ Secret0 ^ size, b ^ Secret1));
+}
+
+// See above
+inline std::size_t KeyHash(const std::string &key) { return KeyHash(key.data(), key.size()); }
+
+} // namespace Afina
+
+#endif // AFINA_KEY_HASH_H
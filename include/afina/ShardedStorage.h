@@ -0,0 +1,42 @@
+#ifndef AFINA_SHARDED_STORAGE_H
+#define AFINA_SHARDED_STORAGE_H
+
+#include <cstddef>
+#include <string>
+
+#include <afina/Storage.h>
+
+namespace Afina {
+
+/**
+ * # Storage split into independent shards without synchronization
+ * Every key belongs to a fixed shard, operation touches only shards of its keys. Storage takes no locks,
+ * instead caller guarantees that each shard is used by one thread at a time, for example by running all
+ * operations of a shard on the thread that owns it (see network/mt_nonblocking).
+ */
+class ShardedStorage : public Storage {
+public:
+    ShardedStorage() {}
+    virtual ~ShardedStorage() {}
+
+    /**
+     * Returns number of shards, it never changes
+     */
+    virtual std::size_t ShardsCount() const = 0;
+
+    /**
+     * Returns shard of the key with the given hash, from 0 to ShardsCount() - 1
+     *
+     * @param hash KeyHash of the key
+     */
+    virtual std::size_t ShardOf(std::size_t hash) const = 0;
+
+    /**
+     * Returns shard the given key belongs to, see above
+     */
+    inline std::size_t ShardOf(const std::string &key) const { return ShardOf(KeyHash(key)); }
+};
+
+} // namespace Afina
+
+#endif // AFINA_SHARDED_STORAGE_H
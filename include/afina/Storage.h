@@ -1,10 +1,80 @@
 #ifndef AFINA_STORAGE_H
 #define AFINA_STORAGE_H
 
+#include <cstdint>
+#include <map>
 #include <string>
+#include <vector>
+
+#include <afina/KeyHash.h>
+#include <afina/StringView.h>
+#include <afina/Value.h>
 
 namespace Afina {
 
+/**
+ * Attributes storage keeps for each item next to its value
+ */
+struct ItemMeta {
+    ItemMeta(uint32_t flags = 0, uint32_t expire = 0, uint64_t cas = 0) : flags(flags), expire(expire), cas(cas) {}
+
+    // Opaque client bits, returned as is
+    uint32_t flags;
+
+    // Unix time in seconds when item expires, 0 if it never does. Expired item isn't visible anymore
+    uint32_t expire;
+
+    // Version of the item for compare-and-swap, changes on every write of the item. Storages without
+    // versioning keep 0. Ignored on writes
+    uint64_t cas;
+};
+
+/**
+ * Outcome of Storage::CompareAndSet and Storage::CompareAndDelete
+ */
+enum class CasResult {
+    // Version matched, new value is stored or item is deleted
+    Stored,
+
+    // Item was changed since the version was taken, nothing is stored
+    Exists,
+
+    // There is no such key
+    NotFound,
+
+    // Value doesn't fit the storage
+    NotStored
+};
+
+/**
+ * Outcome of Storage::Increment and Storage::Decrement
+ */
+enum class IncrResult {
+    // New number is stored
+    Stored,
+
+    // There is no such key
+    NotFound,
+
+    // Value isn't a decimal representation of 64-bit unsigned integer, nothing is changed
+    NotNumber,
+
+    // Value doesn't fit the storage
+    NotStored
+};
+
+/**
+ * Outcome of one lookup of Storage::GetMany
+ */
+struct LookupResult {
+    LookupResult() : found(false) {}
+
+    // Key exists, value and meta are set only in this case
+    bool found;
+    Value value;
+    ItemMeta meta;
+};
+
 /**
  *
  */
@@ -27,8 +97,9 @@ public:
      *
      * @param key to be associated with value
      * @param value to be assigned for the key
+     * @param meta item attributes, such as expiration time
      */
-    virtual bool Put(const std::string &key, const std::string &value) = 0;
+    virtual bool Put(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) = 0;
 
     /**
      * Stores association between given key/value pair if key isn't present in
@@ -40,8 +111,9 @@ public:
      *
      * @param key to be associated with value
      * @param value to be assigned for the key
+     * @param meta item attributes, such as expiration time
      */
-    virtual bool PutIfAbsent(const std::string &key, const std::string &value) = 0;
+    virtual bool PutIfAbsent(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) = 0;
 
     /**
      * Updates existing association between given key/value pair
@@ -53,8 +125,9 @@ public:
      *
      * @param key to be associated with value
      * @param value to be assigned for the key
+     * @param meta new item attributes, such as expiration time
      */
-    virtual bool Set(const std::string &key, const std::string &value) = 0;
+    virtual bool Set(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) = 0;
 
     /**
      * Removes association for the given key
@@ -84,6 +157,331 @@ public:
      * @param value output parameter to copy value to
      */
     virtual bool Get(const std::string &key, std::string &value) = 0;
+
+    /**
+     * Retrive value for the given key without copying it
+     * If there is an association for the given key then method points given handle to the value and
+     * returns true. Handle keeps value bytes alive and unchanged even if association gets updated or
+     * deleted later on.
+     *
+     * Default implementation copies value into private buffer, storages are expected to override it
+     * and return handle to their own memory
+     *
+     * @param key to retrive value for
+     * @param value output parameter to point to the value
+     */
+    virtual bool Get(const std::string &key, Value &value) {
+        std::string copy;
+        if (!Get(key, copy)) {
+            return false;
+        }
+        value = Value::Copy(copy);
+        return true;
+    }
+
+    /**
+     * Same as Get above, but returns item attributes as well
+     *
+     * Default implementation is for storages that keep no attributes, it returns default ones
+     *
+     * @param key to retrive value for
+     * @param value output parameter to point to the value
+     * @param meta output parameter to copy attributes to
+     */
+    virtual bool Get(const std::string &key, Value &value, ItemMeta &meta) {
+        if (!Get(key, value)) {
+            return false;
+        }
+        meta = ItemMeta();
+        return true;
+    }
+
+    /**
+     * Updates existing association only if it wasn't changed since the given version was returned by Get,
+     * so that read-modify-write of a single item needs no lock on the client side
+     *
+     * Default implementation is Get followed by Set, it isn't atomic
+     *
+     * @param key to be associated with value
+     * @param value to be assigned for the key
+     * @param meta new item attributes, such as expiration time
+     * @param cas version of the item the change is based on, see ItemMeta::cas
+     */
+    virtual CasResult CompareAndSet(const std::string &key, const std::string &value, const ItemMeta &meta,
+                                    uint64_t cas) {
+        Value current;
+        ItemMeta current_meta;
+        if (!Get(key, current, current_meta)) {
+            return CasResult::NotFound;
+        }
+        if (current_meta.cas != cas) {
+            return CasResult::Exists;
+        }
+        return Set(key, value, meta) ? CasResult::Stored : CasResult::NotStored;
+    }
+
+    /**
+     * Removes the key only if the item wasn't changed since the given version was returned by Get, so that
+     * newer value written by somebody else survives the delete based on the stale one
+     *
+     * Default implementation is Get followed by Delete, it isn't atomic
+     *
+     * @param key to be removed
+     * @param cas version of the item the delete is based on, see ItemMeta::cas
+     */
+    virtual CasResult CompareAndDelete(const std::string &key, uint64_t cas) {
+        Value current;
+        ItemMeta current_meta;
+        if (!Get(key, current, current_meta)) {
+            return CasResult::NotFound;
+        }
+        if (current_meta.cas != cas) {
+            return CasResult::Exists;
+        }
+        return Delete(key) ? CasResult::Stored : CasResult::NotFound;
+    }
+
+    /**
+     * Treats value of existing key as a decimal 64-bit unsigned integer and adds delta to it, result wraps
+     * around on overflow. Item attributes stay the same
+     *
+     * Default implementation is a loop of Get and CompareAndSet, it is atomic as long as CompareAndSet is
+     *
+     * @param key to change value of
+     * @param delta to be added to the number
+     * @param result output parameter, gets the new number
+     */
+    virtual IncrResult Increment(const std::string &key, uint64_t delta, uint64_t &result) {
+        return addNumber(key, delta, false, result);
+    }
+
+    /**
+     * Same as Increment, but subtracts delta from the number. Result never gets below zero
+     *
+     * @param key to change value of
+     * @param delta to be subtracted from the number
+     * @param result output parameter, gets the new number
+     */
+    virtual IncrResult Decrement(const std::string &key, uint64_t delta, uint64_t &result) {
+        return addNumber(key, delta, true, result);
+    }
+
+    /**
+     * Adds data to the end of the value of existing key, item attributes stay the same
+     * If requested key doesn't present in storage method returns false and doesnt change anything.
+     *
+     * Default implementation is Get followed by Set, it copies the value twice and isn't atomic. Storages
+     * are expected to override it and grow the value in place
+     *
+     * @param key to change value of
+     * @param data to be added to the value
+     */
+    virtual bool Append(const std::string &key, const std::string &data) {
+        Value value;
+        ItemMeta meta;
+        if (!Get(key, value, meta)) {
+            return false;
+        }
+        return Set(key, value.str() + data, meta);
+    }
+
+    /**
+     * Same as Append, but adds data to the beginning of the value
+     *
+     * @param key to change value of
+     * @param data to be added to the value
+     */
+    virtual bool Prepend(const std::string &key, const std::string &data) {
+        Value value;
+        ItemMeta meta;
+        if (!Get(key, value, meta)) {
+            return false;
+        }
+        return Set(key, data + value.str(), meta);
+    }
+
+    /**
+     * Looks up several keys at once, same as calling Get with meta for each of them. Batch lets storage
+     * amortize locking and memory latency over all the keys
+     *
+     * Default implementation is a plain loop over Get
+     *
+     * @param keys to retrive values for
+     * @param results output parameter, gets one result per key in the same order
+     */
+    virtual void GetMany(const std::vector<std::string> &keys, std::vector<LookupResult> &results) {
+        results.clear();
+        results.resize(keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            results[i].found = Get(keys[i], results[i].value, results[i].meta);
+        }
+    }
+
+    /**
+     * Stores several key/value pairs at once, same as calling Put for each of them in order
+     *
+     * Default implementation is a plain loop over Put
+     *
+     * @param keys to be associated with values
+     * @param values to be assigned for the keys, one per key
+     * @param metas item attributes, one per key
+     * @param stored output parameter, gets result of Put for each key in the same order
+     */
+    virtual void PutMany(const std::vector<std::string> &keys, const std::vector<std::string> &values,
+                         const std::vector<ItemMeta> &metas, std::vector<bool> &stored) {
+        stored.assign(keys.size(), false);
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            stored[i] = Put(keys[i], values[i], metas[i]);
+        }
+    }
+
+    /**
+     * Same as Put above, but with the key hash computed by the caller with KeyHash, usually by protocol
+     * parser, so that storage doesn't hash the key once again
+     *
+     * Default implementation ignores the hash
+     *
+     * @param key to be associated with value
+     * @param hash KeyHash of the key
+     * @param value to be assigned for the key
+     * @param meta item attributes, such as expiration time
+     */
+    virtual bool Put(const std::string &key, std::size_t hash, const std::string &value, const ItemMeta &meta) {
+        return Put(key, value, meta);
+    }
+
+    /**
+     * Same as PutIfAbsent above, but with the key hash computed by the caller, see Put
+     */
+    virtual bool PutIfAbsent(const std::string &key, std::size_t hash, const std::string &value,
+                             const ItemMeta &meta) {
+        return PutIfAbsent(key, value, meta);
+    }
+
+    /**
+     * Same as GetMany above, but with hashes[i] equal to KeyHash of keys[i] computed by the caller, see Put
+     */
+    virtual void GetMany(const std::vector<std::string> &keys, const std::vector<std::size_t> &hashes,
+                         std::vector<LookupResult> &results) {
+        GetMany(keys, results);
+    }
+
+    /**
+     * Same as GetMany above, but keys are views into the caller memory, for example into the connection
+     * read buffer, so that batch doesn't copy keys at all. Views must stay valid until the call returns
+     *
+     * Default implementation copies keys into strings
+     */
+    virtual void GetMany(const std::vector<StringView> &keys, const std::vector<std::size_t> &hashes,
+                         std::vector<LookupResult> &results) {
+        std::vector<std::string> copies;
+        copies.reserve(keys.size());
+        for (auto &key : keys) {
+            copies.push_back(key.str());
+        }
+        GetMany(copies, hashes, results);
+    }
+
+    /**
+     * Same as GetMany above, but keys, hashes and results are arrays of count elements, so that caller could
+     * keep them in any container, for example in the request Arena. results are filled by the call
+     *
+     * Default implementation copies keys and hashes into vectors
+     */
+    virtual void GetMany(const StringView *keys, const std::size_t *hashes, std::size_t count,
+                         LookupResult *results) {
+        std::vector<StringView> key_copies(keys, keys + count);
+        std::vector<std::size_t> hash_copies(hashes, hashes + count);
+        std::vector<LookupResult> found;
+        GetMany(key_copies, hash_copies, found);
+        for (std::size_t i = 0; i < count; ++i) {
+            results[i] = std::move(found[i]);
+        }
+    }
+
+    /**
+     * Adds storage counters to the given map, name -> value, values of the same name are summed up. Could
+     * be called concurrently with any other method, counters are approximate
+     */
+    virtual void CollectStats(std::map<std::string, uint64_t> &stats) {}
+
+protected:
+    // Maximum length of decimal 64-bit unsigned integer
+    static const std::size_t MaxNumberLength = 20;
+
+    /**
+     * Parses value of Increment and Decrement: decimal digits only, without sign and spaces
+     */
+    static bool parseNumber(const char *data, std::size_t size, uint64_t &number) {
+        if (size == 0 || size > MaxNumberLength) {
+            return false;
+        }
+        number = 0;
+        for (std::size_t i = 0; i < size; ++i) {
+            if (data[i] < '0' || data[i] > '9') {
+                return false;
+            }
+            uint64_t digit = data[i] - '0';
+            if (number > (UINT64_MAX - digit) / 10) {
+                return false;
+            }
+            number = number * 10 + digit;
+        }
+        return true;
+    }
+
+    /**
+     * Writes decimal representation of the number to out, which must have room for MaxNumberLength bytes.
+     * Returns number of bytes written
+     */
+    static std::size_t formatNumber(uint64_t number, char *out) {
+        char digits[MaxNumberLength];
+        std::size_t size = 0;
+        do {
+            digits[size++] = '0' + number % 10;
+            number /= 10;
+        } while (number != 0);
+        for (std::size_t i = 0; i < size; ++i) {
+            out[i] = digits[size - 1 - i];
+        }
+        return size;
+    }
+
+    // Result of Increment or Decrement of the number
+    static uint64_t applyDelta(uint64_t number, uint64_t delta, bool decrement) {
+        if (decrement) {
+            return number > delta ? number - delta : 0;
+        }
+        return number + delta;
+    }
+
+private:
+    // Default Increment and Decrement
+    IncrResult addNumber(const std::string &key, uint64_t delta, bool decrement, uint64_t &result) {
+        for (;;) {
+            Value value;
+            ItemMeta meta;
+            uint64_t number;
+            if (!Get(key, value, meta)) {
+                return IncrResult::NotFound;
+            }
+            if (!parseNumber(value.data(), value.size(), number)) {
+                return IncrResult::NotNumber;
+            }
+            result = applyDelta(number, delta, decrement);
+            switch (CompareAndSet(key, std::to_string(result), meta, meta.cas)) {
+            case CasResult::Stored:
+                return IncrResult::Stored;
+            case CasResult::NotFound:
+                return IncrResult::NotFound;
+            case CasResult::NotStored:
+                return IncrResult::NotStored;
+            default:
+                // Changed by someone else in between, try again
+                break;
+            }
+        }
+    }
 };
 
 } // namespace Afina
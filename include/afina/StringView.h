@@ -0,0 +1,49 @@
+#ifndef AFINA_STRING_VIEW_H
+#define AFINA_STRING_VIEW_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace Afina {
+
+/**
+ * # Bytes owned by somebody else
+ * Pointer and size of a key that lives in some buffer, for example in the connection read buffer, so that
+ * key could travel from the parser down to the storage lookup without copying. View doesn't keep memory
+ * alive, whoever creates it tells how long it stays valid.
+ */
+class StringView {
+public:
+    StringView() : _data(nullptr), _size(0) {}
+    StringView(const char *data, std::size_t size) : _data(data), _size(size) {}
+    StringView(const std::string &str) : _data(str.data()), _size(str.size()) {}
+
+    inline const char *data() const { return _data; }
+    inline std::size_t size() const { return _size; }
+    inline bool empty() const { return _size == 0; }
+
+    inline const char *begin() const { return _data; }
+    inline const char *end() const { return _data + _size; }
+
+    inline char operator[](std::size_t i) const { return _data[i]; }
+
+    /**
+     * Copy of the bytes
+     */
+    std::string str() const { return std::string(_data, _size); }
+
+private:
+    const char *_data;
+    std::size_t _size;
+};
+
+inline bool operator==(const StringView &a, const StringView &b) {
+    return a.size() == b.size() && (a.size() == 0 || std::memcmp(a.data(), b.data(), a.size()) == 0);
+}
+
+inline bool operator!=(const StringView &a, const StringView &b) { return !(a == b); }
+
+} // namespace Afina
+
+#endif // AFINA_STRING_VIEW_H
@@ -0,0 +1,123 @@
+#ifndef AFINA_VALUE_H
+#define AFINA_VALUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <utility>
+
+namespace Afina {
+
+/**
+ * # Immutable value handle
+ * Points to bytes of the value that are kept alive by reference counter, so that handle remains valid after
+ * storage lock is released and even after the item gets replaced or evicted. Allows to send values from
+ * the storage memory directly without copying it out.
+ *
+ * Handle without buffer references memory that outlives it by itself, for example string literals.
+ */
+class Value {
+public:
+    /**
+     * Reference counted memory block. Storage embeds it into its items, the one who drops the last
+     * reference calls destroy
+     */
+    struct Buffer {
+        std::atomic<uint32_t> refs;
+        void (*destroy)(Buffer *);
+    };
+
+    Value() : _buffer(nullptr), _data(nullptr), _size(0) {}
+
+    /**
+     * Creates handle to the size bytes starting at data, which are owned by the given buffer
+     */
+    Value(Buffer *buffer, const char *data, std::size_t size) : _buffer(buffer), _data(data), _size(size) {
+        acquire();
+    }
+
+    Value(const Value &other) : _buffer(other._buffer), _data(other._data), _size(other._size) { acquire(); }
+
+    Value(Value &&other) : _buffer(other._buffer), _data(other._data), _size(other._size) {
+        other._buffer = nullptr;
+        other._data = nullptr;
+        other._size = 0;
+    }
+
+    ~Value() { release(); }
+
+    Value &operator=(const Value &other) {
+        Value tmp(other);
+        swap(tmp);
+        return *this;
+    }
+
+    Value &operator=(Value &&other) {
+        Value tmp(std::move(other));
+        swap(tmp);
+        return *this;
+    }
+
+    /**
+     * Creates handle to a private copy of the given bytes
+     */
+    static Value Copy(const char *data, std::size_t size);
+    static Value Copy(const std::string &data) { return Copy(data.data(), data.size()); }
+
+    /**
+     * Creates handle to memory that is never released, like string literals
+     */
+    static Value Static(const char *data, std::size_t size) { return Value(nullptr, data, size); }
+
+    inline const char *data() const { return _data; }
+    inline std::size_t size() const { return _size; }
+    inline bool empty() const { return _size == 0; }
+
+    inline std::string str() const { return std::string(_data, _size); }
+
+    void swap(Value &other) {
+        std::swap(_buffer, other._buffer);
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+    }
+
+private:
+    inline void acquire() {
+        if (_buffer != nullptr) {
+            _buffer->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    inline void release() {
+        if (_buffer != nullptr && _buffer->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            _buffer->destroy(_buffer);
+        }
+        _buffer = nullptr;
+    }
+
+    Buffer *_buffer;
+    const char *_data;
+    std::size_t _size;
+};
+
+// See above
+inline Value Value::Copy(const char *data, std::size_t size) {
+    // Buffer header followed by value bytes in a single block
+    Buffer *buffer = new (::operator new(sizeof(Buffer) + size)) Buffer;
+    buffer->refs.store(0, std::memory_order_relaxed);
+    buffer->destroy = [](Buffer *b) {
+        b->~Buffer();
+        ::operator delete(b);
+    };
+
+    char *bytes = reinterpret_cast<char *>(buffer + 1);
+    std::memcpy(bytes, data, size);
+    return Value(buffer, bytes, size);
+}
+
+} // namespace Afina
+
+#endif // AFINA_VALUE_H
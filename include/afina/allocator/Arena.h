@@ -0,0 +1,86 @@
+#ifndef AFINA_ALLOCATOR_ARENA_H
+#define AFINA_ALLOCATOR_ARENA_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <afina/allocator/StlAllocator.h>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * # Monotonic arena
+ * Hands out memory by bumping a pointer through a chunk and never takes single blocks back: everything is
+ * released at once by Reset. Meant for data that lives as long as one request, so that request costs no
+ * malloc and free pairs. Chunks stay for the next round, when a round needed several of them they are
+ * replaced by one as large as all of them, up to max_retained bytes.
+ *
+ * That is NOT thread safe implementaiton!!
+ */
+class Arena {
+public:
+    explicit Arena(std::size_t chunk_size = 4096, std::size_t max_retained = 256 * 1024);
+    ~Arena();
+
+    /**
+     * Returns block of the given size aligned for any type, throws std::bad_alloc if there is no memory
+     */
+    void *Allocate(std::size_t size);
+
+    /**
+     * Does nothing, memory goes back on Reset
+     */
+    void Deallocate(void *, std::size_t) {}
+
+    /**
+     * Releases all blocks, none of them could be used anymore
+     */
+    void Reset();
+
+    /**
+     * Bytes handed out since the last Reset and memory taken for chunks
+     */
+    std::size_t Used() const { return _used; }
+    std::size_t Capacity() const { return _capacity; }
+
+private:
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    struct Chunk {
+        Chunk *next;
+        std::size_t size;
+    };
+
+    // Bytes of chunk header, keeps chunk data aligned
+    static const std::size_t HeaderSize = (sizeof(Chunk) + alignof(std::max_align_t) - 1) /
+                                          alignof(std::max_align_t) * alignof(std::max_align_t);
+
+    // Makes chunk with at least size bytes of data the current one
+    void addChunk(std::size_t size);
+
+    // Releases all chunks
+    void freeChunks();
+
+    const std::size_t _chunk_size;
+    const std::size_t _max_retained;
+
+    // Current chunk is the first one
+    Chunk *_chunks;
+    char *_pos;
+    char *_end;
+
+    std::size_t _used;
+    std::size_t _capacity;
+};
+
+// Containers keeping their memory in Arena
+using ArenaString = std::basic_string<char, std::char_traits<char>, StlAllocator<char, Arena>>;
+template <typename T> using ArenaVector = std::vector<T, StlAllocator<T, Arena>>;
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_ARENA_H
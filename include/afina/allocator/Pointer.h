@@ -7,6 +7,14 @@ namespace Allocator {
 // to avoid expensive macros calculations and increase compile speed
 class Simple;
 
+/**
+ * Handle of the block allocated by Simple. Block could be moved by Simple::realloc and Simple::defrag, so
+ * handle points to the slot of the allocator that always knows where block is now, and get() has to be
+ * called again after any of them.
+ *
+ * Copies of the handle refer to the same block. Simple::free resets the handle it was given, other copies
+ * are left dangling.
+ */
 class Pointer {
 public:
     Pointer();
@@ -17,7 +25,18 @@ public:
     Pointer &operator=(const Pointer &);
     Pointer &operator=(Pointer &&);
 
-    void *get() const { return 0; }
+    /**
+     * Current address of the block, nullptr if handle has none
+     */
+    void *get() const { return _slot == nullptr ? nullptr : *_slot; }
+
+private:
+    friend class Simple;
+
+    explicit Pointer(void **slot) : _slot(slot) {}
+
+    // Slot of the allocator handle table
+    void **_slot;
 };
 
 } // namespace Allocator
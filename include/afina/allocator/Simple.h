@@ -18,44 +18,112 @@ class Pointer;
  * Allocator instance doesn't take ownership of wrapped memmory and do not delete it
  * on destruction. So caller must take care of resource cleaup after allocator stop
  * being needs
+ *
+ * Blocks grow from the beginning of the area, each one has a header and a footer with its size. Table of
+ * handle slots grows from the end of the area, Pointer refers to the slot and slot to the block, so that
+ * blocks could be moved. Free blocks are merged with free neighbours right away and kept in a list
+ * searched first-fit, space between the last block and the table is given out when the list has nothing.
+ *
+ * Compaction slides used blocks down over the holes, hole bubbles up merging with others on the way until
+ * it reaches the end of blocks and joins the space there. It could run in slices of bounded work, see
+ * defrag(std::size_t), and allocations and frees are allowed between the slices.
  */
-// TODO: Implements interface to allow usage as C++ allocators
 class Simple {
 public:
     Simple(void *base, const size_t size);
 
     /**
-     * TODO: semantics
+     * Allocates block of at least N bytes, aligned by pointer size
      * @param N size_t
+     * @throws AllocError of NoMemory type if neither free blocks nor the end of the area fit N bytes,
+     * defrag could help if holes() is large enough
      */
     Pointer alloc(size_t N);
 
     /**
-     * TODO: semantics
+     * Changes size of the block to N bytes, first min(N, old size) bytes are kept. Block stays in place
+     * if it shrinks or could grow into the free space that follows it, otherwise it is moved and p keeps
+     * referring to it. Empty p gets a new block
      * @param p Pointer
      * @param N size_t
+     * @throws AllocError of NoMemory type, p is unchanged then
+     * @throws AllocError of InvalidFree type if p doesn't refer to a live block of this allocator
      */
     void realloc(Pointer &p, size_t N);
 
     /**
-     * TODO: semantics
+     * Releases block and resets p, nothing happens if p is empty
      * @param p Pointer
+     * @throws AllocError of InvalidFree type if p doesn't belong to this allocator
      */
     void free(Pointer &p);
 
     /**
-     * TODO: semantics
+     * Moves all used blocks to the beginning of the area, so that all free space is in one piece
      */
     void defrag();
 
     /**
-     * TODO: semantics
+     * Continues compaction for at most about max_bytes of blocks passed over, returns true once all
+     * holes are gone. Next call starts where previous one stopped
+     */
+    bool defrag(size_t max_bytes);
+
+    /**
+     * Bytes taken by free blocks in between used ones, which only defrag could give out to large blocks
+     */
+    size_t holes() const { return _holes; }
+
+    /**
+     * Bytes that could be allocated in a single block right away, not counting holes
+     */
+    size_t available() const;
+
+    /**
+     * Layout summary: blocks in use and their bytes, holes, space left at the end and handle slots
      */
     std::string dump() const;
 
 private:
+    // Block bytes taken for the payload of N bytes
+    static size_t blockSize(size_t N);
+
+    // Returns block of at least size bytes, taken from a free block or the end of blocks not going above
+    // limit. Returns nullptr if none fits
+    char *takeBlock(size_t size, char *limit);
+
+    // Cuts tail of the used block beyond size bytes off, if it is large enough to be a block
+    void shrinkBlock(char *block, size_t size);
+
+    // Makes range a free block merged with free neighbours, or gives it back to the end of blocks
+    void releaseRange(char *block, size_t size);
+
+    // Block p refers to. Throws AllocError of InvalidFree type if p isn't a slot of this allocator or the
+    // slot was released, that is keeps a link of the slot free list instead of a payload
+    char *usedBlock(const Pointer &p) const;
+
+    // Free list of blocks
+    void linkFree(char *block);
+    void unlinkFree(char *block);
+
     void *_base;
     const size_t _base_len;
+
+    // First block, end of the last one and bounds of the slot table, which ends at the end of area
+    char *_begin;
+    char *_top;
+    char *_slots;
+    char *_end;
+
+    // Released slots, each keeps address of the next one
+    void **_free_slots;
+
+    // Free blocks list
+    char *_free_blocks;
+    size_t _holes;
+
+    // Block compaction continues from, see defrag(size_t)
+    char *_cursor;
 };
 
 } // namespace Allocator
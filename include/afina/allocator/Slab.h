@@ -0,0 +1,201 @@
+#ifndef AFINA_ALLOCATOR_SLAB_H
+#define AFINA_ALLOCATOR_SLAB_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <afina/concurrency/ThreadLocal.h>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * # Slab allocator for small blocks of many sizes
+ * Blocks are rounded up to one of the size classes, growing geometrically by Growth from MinSize up to
+ * MaxSize, and carved out of PageSize pages that are dedicated to one class. Pages are taken from large
+ * mmap chunks and never given back, so blocks of the same class reuse the same memory over and over instead
+ * of fragmenting the heap, and resident memory stays at the peak of live blocks plus rounding. Blocks larger
+ * than MaxSize go straight to operator new.
+ *
+ * Each thread has a magazine of free blocks per class, so allocation and release are a couple of loads
+ * and stores while the magazine has blocks or room. Empty magazine takes a batch of blocks from the shared
+ * free list of its class, full one gives a batch back, both under the lock of that class only.
+ *
+ * Page starts with a header naming the allocator and the class, so that block could be released by any
+ * thread knowing its address and requested size only, see Release. Blocks cached by magazines of finished
+ * threads aren't reused until the allocator is destroyed.
+ */
+class Slab {
+public:
+    // Size of the page blocks of one class are carved from, page address is aligned by it
+    static const std::size_t PageSize = 64 * 1024;
+
+    // Smallest and largest size class
+    static const std::size_t MinSize = 64;
+    static const std::size_t MaxSize = 16 * 1024;
+
+    // Size class is at most Growth times larger than the previous one, in percents
+    static const std::size_t Growth = 125;
+
+    // Blocks are aligned by this
+    static const std::size_t Alignment = 16;
+
+    Slab();
+    ~Slab();
+
+    /**
+     * Process wide allocator, never destroyed so that blocks could be released at any time
+     */
+    static Slab &Default();
+
+    /**
+     * Returns block of at least size bytes, throws std::bad_alloc if there is no memory left
+     */
+    void *Allocate(std::size_t size);
+
+    /**
+     * Releases block returned by Allocate of any Slab, size must be the one it was requested with or any
+     * other not above its UsableSize
+     */
+    static void Release(void *block, std::size_t size);
+
+    /**
+     * Same as Release, lets Slab be a resource of StlAllocator
+     */
+    void Deallocate(void *block, std::size_t size) { Release(block, size); }
+
+    /**
+     * Bytes block requested with the given size really has, all of them could be used
+     */
+    static std::size_t UsableSize(std::size_t size);
+
+    /**
+     * Memory taken from the system for pages, in bytes
+     */
+    std::size_t MemoryUsage() const;
+
+    /**
+     * Report of each class that has pages: block size, pages, blocks in use, cached by thread magazines
+     * and free in the shared list, share of the class pages taken by blocks in use
+     */
+    std::string dump() const;
+
+private:
+    Slab(const Slab &) = delete;
+    Slab &operator=(const Slab &) = delete;
+
+    // Enough for classes from MinSize to MaxSize, see ClassTable
+    static const std::size_t MaxClasses = 32;
+
+    // Blocks kept by thread per class and moved between magazine and shared list at once
+    static const std::size_t MagazineSize = 32;
+    static const std::size_t BatchSize = MagazineSize / 2;
+
+    // Pages are cut from chunks of this many pages
+    static const std::size_t ChunkPages = 64;
+
+    // Beginning of each page
+    struct PageHeader {
+        Slab *owner;
+        std::size_t size_class;
+    };
+
+    // Blocks start after the header, padded to keep them aligned
+    static const std::size_t HeaderSize = 64;
+
+    // Free block in the shared list links to the next one by its first bytes
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    struct SizeClass {
+        std::size_t size;
+        std::size_t per_page;
+
+        // Guards the free list and pages
+        std::mutex mutex;
+        FreeBlock *free;
+        std::size_t free_count;
+        std::size_t pages;
+    };
+
+    struct Magazine {
+        std::size_t count;
+        void *blocks[MagazineSize];
+    };
+
+    // Changed by its thread only, read by dump from any thread
+    class Counter {
+    public:
+        Counter() : _value(0) {}
+
+        inline void Add(uint64_t delta) {
+            _value.store(_value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+        }
+
+        inline uint64_t Load() const { return _value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> _value;
+    };
+
+    struct ThreadCache {
+        ThreadCache() {
+            for (auto &magazine : magazines) {
+                magazine.count = 0;
+            }
+        }
+
+        Magazine magazines[MaxClasses];
+        Counter allocated[MaxClasses];
+        Counter released[MaxClasses];
+    };
+
+    // Size class of the block of size bytes, which is not above MaxSize
+    static inline std::size_t classOf(std::size_t size) {
+        return classTable().index[(size + Alignment - 1) / Alignment];
+    }
+
+    // Classes sizes and lookup of the class by size in Alignment units, same for all instances
+    struct ClassTable {
+        ClassTable();
+
+        std::size_t count;
+        std::size_t sizes[MaxClasses];
+        uint8_t index[MaxSize / Alignment + 1];
+    };
+
+    static const ClassTable &classTable();
+
+    // Puts block into magazine of the calling thread
+    void release(void *block, std::size_t size_class);
+
+    // Fills empty magazine from the shared list, cutting a new page if the list is empty
+    void refill(std::size_t size_class, Magazine &magazine);
+
+    // Moves a batch of blocks from full magazine to the shared list
+    void flush(std::size_t size_class, Magazine &magazine);
+
+    // Returns next unused page, maps a new chunk if needed
+    char *newPage();
+
+    std::unique_ptr<SizeClass[]> _classes;
+    Concurrency::ThreadLocal<ThreadCache> _caches;
+
+    // Guards chunks
+    mutable std::mutex _chunks_mutex;
+    std::vector<char *> _chunks;
+    // Next page of the last chunk and number of pages left in it
+    char *_next_page;
+    std::size_t _pages_left;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_SLAB_H
@@ -0,0 +1,55 @@
+#ifndef AFINA_ALLOCATOR_STL_ALLOCATOR_H
+#define AFINA_ALLOCATOR_STL_ALLOCATOR_H
+
+#include <cstddef>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * # Standard allocator on top of allocator of this library
+ * Lets standard containers take memory from Resource, which has to provide
+ *
+ *   void *Allocate(std::size_t bytes);
+ *   void Deallocate(void *p, std::size_t bytes);
+ *
+ * with blocks aligned for any type, like Arena and Slab do. Allocator only refers to the resource, which
+ * must outlive containers using it. Allocators of the same resource are equal, so containers could swap
+ * and move memory between each other.
+ *
+ * Simple can't be a resource: its blocks move, while containers keep raw pointers.
+ */
+template <typename T, typename Resource> class StlAllocator {
+public:
+    using value_type = T;
+
+    template <typename U> struct rebind { using other = StlAllocator<U, Resource>; };
+
+    explicit StlAllocator(Resource *resource) : _resource(resource) {}
+
+    template <typename U> StlAllocator(const StlAllocator<U, Resource> &other) : _resource(other.resource()) {}
+
+    T *allocate(std::size_t n) { return static_cast<T *>(_resource->Allocate(n * sizeof(T))); }
+
+    void deallocate(T *p, std::size_t n) { _resource->Deallocate(p, n * sizeof(T)); }
+
+    Resource *resource() const { return _resource; }
+
+private:
+    Resource *_resource;
+};
+
+template <typename T, typename U, typename Resource>
+inline bool operator==(const StlAllocator<T, Resource> &a, const StlAllocator<U, Resource> &b) {
+    return a.resource() == b.resource();
+}
+
+template <typename T, typename U, typename Resource>
+inline bool operator!=(const StlAllocator<T, Resource> &a, const StlAllocator<U, Resource> &b) {
+    return a.resource() != b.resource();
+}
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_STL_ALLOCATOR_H
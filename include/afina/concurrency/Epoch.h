@@ -0,0 +1,172 @@
+#ifndef AFINA_CONCURRENCY_EPOCH_H
+#define AFINA_CONCURRENCY_EPOCH_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Epoch based memory reclamation
+ * Lets readers access shared objects without locks while writer unlinks and releases them. Reader
+ * announces current epoch for the time of access (see Guard). Writer unlinks object first and then
+ * retires it, retired object is released only once every reader that could have seen it has left.
+ *
+ * Retire and Reclaim must be serialized by the caller, usually by writers lock. Readers could be any
+ * threads, but only MaxThreads of them at the same time could use the domain, Guard becomes inactive for
+ * the rest so caller must fallback to locking. Guards are not reentrant.
+ */
+class Epoch {
+public:
+    // Number of threads that could read concurrently
+    static const std::size_t MaxThreads = 256;
+
+    // Number of retired objects that triggers reclamation
+    static const std::size_t ReclaimThreshold = 64;
+
+    Epoch() : _epoch(1) {
+        for (auto &slot : _slots) {
+            slot.epoch.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // No readers are expected at this point, everything retired gets released
+    ~Epoch() {
+        for (auto &r : _retired) {
+            r.deleter(r.ptr);
+        }
+    }
+
+    /**
+     * Protects objects reachable from the shared structure for the time of guard life
+     */
+    class Guard {
+    public:
+        explicit Guard(Epoch &e) : _slot(nullptr) {
+            std::size_t index = threadIndex();
+            if (index < MaxThreads) {
+                _slot = &e._slots[index].epoch;
+                _slot->store(e._epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+            }
+        }
+
+        ~Guard() {
+            if (_slot != nullptr) {
+                _slot->store(0, std::memory_order_release);
+            }
+        }
+
+        // Returns false if there are too many reading threads and nothing is protected
+        inline bool active() const { return _slot != nullptr; }
+
+    private:
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+
+        std::atomic<uint64_t> *_slot;
+    };
+
+    /**
+     * Schedules deleter(ptr) to be called once no reader could see ptr anymore. Object must be unlinked
+     * from the shared structure already
+     */
+    void Retire(void *ptr, void (*deleter)(void *)) {
+        _retired.push_back(Retired{ptr, deleter, _epoch.fetch_add(1, std::memory_order_seq_cst)});
+        if (_retired.size() >= ReclaimThreshold) {
+            Reclaim();
+        }
+    }
+
+    /**
+     * Releases retired objects which are not visible to readers anymore
+     */
+    void Reclaim() {
+        uint64_t oldest = std::numeric_limits<uint64_t>::max();
+        for (auto &slot : _slots) {
+            uint64_t e = slot.epoch.load(std::memory_order_seq_cst);
+            if (e != 0 && e < oldest) {
+                oldest = e;
+            }
+        }
+
+        // Reader that entered in epoch e could see everything retired in epochs >= e
+        while (!_retired.empty() && _retired.front().epoch < oldest) {
+            Retired r = _retired.front();
+            _retired.pop_front();
+            r.deleter(r.ptr);
+        }
+    }
+
+    inline std::size_t Pending() const { return _retired.size(); }
+
+private:
+    Epoch(const Epoch &) = delete;
+    Epoch &operator=(const Epoch &) = delete;
+
+    // Epoch announced by a reader, 0 if there is no one. Padded to occupy own cache line
+    struct Slot {
+        std::atomic<uint64_t> epoch;
+        char pad[64 - sizeof(std::atomic<uint64_t>)];
+    };
+
+    struct Retired {
+        void *ptr;
+        void (*deleter)(void *);
+        uint64_t epoch;
+    };
+
+    // Small integer identifying current thread among alive ones, MaxThreads if all are taken
+    static std::size_t threadIndex() {
+        struct Index {
+            Index() : value(acquire()) {}
+            ~Index() { release(value); }
+            std::size_t value;
+        };
+        static thread_local Index index;
+        return index.value;
+    }
+
+    static std::mutex &indexMutex() {
+        static std::mutex m;
+        return m;
+    }
+
+    static std::vector<bool> &usedIndexes() {
+        static std::vector<bool> used(MaxThreads, false);
+        return used;
+    }
+
+    static std::size_t acquire() {
+        std::lock_guard<std::mutex> lock(indexMutex());
+        std::vector<bool> &used = usedIndexes();
+        for (std::size_t i = 0; i < MaxThreads; ++i) {
+            if (!used[i]) {
+                used[i] = true;
+                return i;
+            }
+        }
+        return MaxThreads;
+    }
+
+    static void release(std::size_t index) {
+        if (index < MaxThreads) {
+            std::lock_guard<std::mutex> lock(indexMutex());
+            usedIndexes()[index] = false;
+        }
+    }
+
+    std::atomic<uint64_t> _epoch;
+    Slot _slots[MaxThreads];
+    std::deque<Retired> _retired;
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_EPOCH_H
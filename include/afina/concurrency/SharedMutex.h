@@ -0,0 +1,65 @@
+#ifndef AFINA_CONCURRENCY_SHARED_MUTEX_H
+#define AFINA_CONCURRENCY_SHARED_MUTEX_H
+
+#include <pthread.h>
+#include <stdexcept>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Readers-writer lock
+ * Could be owned exclusively by one writer or shared by many readers. Satisfies Lockable requirements, so
+ * could be used with std::unique_lock for exclusive ownership, see SharedLock for the shared one.
+ *
+ * Writers have preference over readers, so that constant stream of readers can't starve writer
+ */
+class SharedMutex {
+public:
+    SharedMutex() {
+        pthread_rwlockattr_t attr;
+        pthread_rwlockattr_init(&attr);
+        pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+        if (pthread_rwlock_init(&_lock, &attr) != 0) {
+            pthread_rwlockattr_destroy(&attr);
+            throw std::runtime_error("Failed to create rwlock");
+        }
+        pthread_rwlockattr_destroy(&attr);
+    }
+    ~SharedMutex() { pthread_rwlock_destroy(&_lock); }
+
+    void lock() { pthread_rwlock_wrlock(&_lock); }
+    bool try_lock() { return pthread_rwlock_trywrlock(&_lock) == 0; }
+    void unlock() { pthread_rwlock_unlock(&_lock); }
+
+    void lock_shared() { pthread_rwlock_rdlock(&_lock); }
+    bool try_lock_shared() { return pthread_rwlock_tryrdlock(&_lock) == 0; }
+    void unlock_shared() { pthread_rwlock_unlock(&_lock); }
+
+private:
+    SharedMutex(const SharedMutex &) = delete;
+    SharedMutex &operator=(const SharedMutex &) = delete;
+
+    pthread_rwlock_t _lock;
+};
+
+/**
+ * # Shared ownership guard
+ * Same as std::unique_lock, but takes SharedMutex in shared mode
+ */
+class SharedLock {
+public:
+    explicit SharedLock(SharedMutex &m) : _m(m) { _m.lock_shared(); }
+    ~SharedLock() { _m.unlock_shared(); }
+
+private:
+    SharedLock(const SharedLock &) = delete;
+    SharedLock &operator=(const SharedLock &) = delete;
+
+    SharedMutex &_m;
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_SHARED_MUTEX_H
@@ -0,0 +1,87 @@
+#ifndef AFINA_CONCURRENCY_SPSC_QUEUE_H
+#define AFINA_CONCURRENCY_SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Bounded single producer single consumer queue
+ * Lock free ring buffer: producer owns the tail, consumer owns the head, each side reads the other's
+ * index only when its cached copy says the queue is full or empty. Indices live on separate cache lines,
+ * so that producer and consumer running on different cores don't bounce each other's lines.
+ *
+ * Exactly one thread may call Push and exactly one thread may call Pop at a time.
+ */
+template <typename T> class SpscQueue {
+public:
+    // Capacity is rounded up to the power of two
+    explicit SpscQueue(std::size_t capacity = 1024) : _head(0), _tail_cache(0), _tail(0), _head_cache(0) {
+        std::size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        _buffer.reset(new T[size]);
+        _mask = size - 1;
+    }
+
+    /**
+     * Producer side. Returns false and doesn't change anything if queue is full
+     */
+    bool Push(const T &item) {
+        std::size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head_cache > _mask) {
+            _head_cache = _head.load(std::memory_order_acquire);
+            if (tail - _head_cache > _mask) {
+                return false;
+            }
+        }
+        _buffer[tail & _mask] = item;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Consumer side. Returns false if queue is empty
+     */
+    bool Pop(T &item) {
+        std::size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail_cache) {
+            _tail_cache = _tail.load(std::memory_order_acquire);
+            if (head == _tail_cache) {
+                return false;
+            }
+        }
+        item = _buffer[head & _mask];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    static const std::size_t CacheLine = 64;
+
+    std::unique_ptr<T[]> _buffer;
+    std::size_t _mask;
+    char _pad0[CacheLine];
+
+    // Consumer side: next element to pop and the last seen tail
+    std::atomic<std::size_t> _head;
+    std::size_t _tail_cache;
+    char _pad1[CacheLine];
+
+    // Producer side: next free slot and the last seen head
+    std::atomic<std::size_t> _tail;
+    std::size_t _head_cache;
+    char _pad2[CacheLine];
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_SPSC_QUEUE_H
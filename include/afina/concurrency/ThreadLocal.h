@@ -1,10 +1,88 @@
 #ifndef AFINA_CONCURRENCY_THREAD_LOCAL_H
 #define AFINA_CONCURRENCY_THREAD_LOCAL_H
 
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 namespace Afina {
 namespace Concurrency {
 
-template <typename T> class ThreadLocal {};
+// Slots of ThreadLocal objects for the calling thread, indexed by object id
+inline std::vector<void *> &threadLocalSlots() {
+    static thread_local std::vector<void *> slots;
+    return slots;
+}
+
+// Ids are never reused, so that slot of destroyed object is never taken for a new one
+inline std::size_t nextThreadLocalId() {
+    static std::atomic<std::size_t> next(0);
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * # Instance of T per thread
+ * Each thread gets own default constructed T on the first Get, lookup costs a thread local vector access.
+ * Values are padded to cache lines, so that threads updating their values don't invalidate each other's
+ * lines. All values stay alive until ThreadLocal is destroyed, even if their threads are gone, and could be
+ * visited by ForEach from any thread, so T must tolerate concurrent reads, for example by using relaxed
+ * atomics.
+ */
+template <typename T> class ThreadLocal {
+public:
+    ThreadLocal() : _id(nextThreadLocalId()) {}
+
+    /**
+     * Returns value of the calling thread
+     */
+    T &Get() {
+        std::vector<void *> &slots = threadLocalSlots();
+        if (_id < slots.size() && slots[_id] != nullptr) {
+            return static_cast<Slot *>(slots[_id])->value;
+        }
+        return create(slots);
+    }
+
+    /**
+     * Calls fn for the value of each thread that has one, in order threads came in
+     */
+    template <typename F> void ForEach(F fn) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto &slot : _all) {
+            fn(const_cast<const T &>(slot->value));
+        }
+    }
+
+private:
+    ThreadLocal(const ThreadLocal &) = delete;
+    ThreadLocal &operator=(const ThreadLocal &) = delete;
+
+    static const std::size_t CacheLine = 64;
+
+    struct Slot {
+        char pad0[CacheLine];
+        T value;
+        char pad1[CacheLine];
+    };
+
+    T &create(std::vector<void *> &slots) {
+        if (slots.size() <= _id) {
+            slots.resize(_id + 1, nullptr);
+        }
+        std::unique_ptr<Slot> slot(new Slot());
+        T &value = slot->value;
+        slots[_id] = slot.get();
+        std::lock_guard<std::mutex> lock(_mutex);
+        _all.push_back(std::move(slot));
+        return value;
+    }
+
+    const std::size_t _id;
+    mutable std::mutex _mutex;
+    std::vector<std::unique_ptr<Slot>> _all;
+};
 
 } // namespace Concurrency
 } // namespace Afina
@@ -21,9 +21,13 @@ namespace Execute {
 class Add : public InsertCommand {
 public:
     Add(const std::string &key, uint32_t flags, int32_t expire) : InsertCommand(key, flags, expire) {}
+    Add(const std::string &key, uint32_t flags, int32_t expire, std::size_t hash)
+        : InsertCommand(key, flags, expire, hash) {}
     ~Add() {}
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    Metrics::CommandType Type() const override { return Metrics::CommandType::Add; }
 };
 
 } // namespace Execute
@@ -25,6 +25,8 @@ public:
     ~Append() {}
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    Metrics::CommandType Type() const override { return Metrics::CommandType::Append; }
 };
 
 } // namespace Execute
@@ -0,0 +1,44 @@
+#ifndef AFINA_EXECUTE_CAS_H
+#define AFINA_EXECUTE_CAS_H
+
+#include <cstdint>
+#include <string>
+
+#include "InsertCommand.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Compare and swap
+ * Store value for the key, but only if nobody else has changed the item since
+ * client read it by "gets"
+ *
+ * Command must write result to the output, which could be:
+ * - "STORED", to indicate success.
+ * - "EXISTS" to indicate that the item has been modified since it was fetched.
+ * - "NOT_FOUND" to indicate that the item does not exist or has been deleted.
+ * - "NOT_STORED" to indicate the data was not stored, but not because of an
+ * error.
+ */
+class Cas : public InsertCommand {
+public:
+    Cas(const std::string &key, uint32_t flags, int32_t expire, uint64_t cas)
+        : InsertCommand(key, flags, expire), _cas(cas) {}
+    ~Cas() {}
+
+    inline uint64_t cas() const { return _cas; }
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    Metrics::CommandType Type() const override { return Metrics::CommandType::Cas; }
+
+private:
+    // Version of the item returned by "gets"
+    const uint64_t _cas;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_CAS_H
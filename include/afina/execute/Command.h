@@ -2,6 +2,10 @@
 #define AFINA_EXECUTE_COMMAND_H
 
 #include <string>
+#include <vector>
+
+#include <afina/Value.h>
+#include <afina/execute/Metrics.h>
 
 namespace Afina {
 
@@ -15,10 +19,34 @@ namespace Execute {
  */
 class Command {
 public:
-    Command() {}
+    Command() : _noreply(false) {}
     virtual ~Command() {}
 
     virtual void Execute(Storage &storage, const std::string &args, std::string &out) = 0;
+
+    /**
+     * Same as above, but response is appended to out as a sequence of chunks, which could point directly
+     * to the storage memory, so that values aren't copied on the way to the socket. As with string
+     * response, networking layer should add the last \r\n
+     *
+     * Default implementation wraps string response into a single chunk, empty response adds nothing
+     */
+    virtual void Execute(Storage &storage, const std::string &args, std::vector<Value> &out);
+
+    /**
+     * Kind of the command for counters and latency histograms, see Metrics
+     */
+    virtual Metrics::CommandType Type() const { return Metrics::CommandType::Other; }
+
+    /**
+     * Client asked not to send the response: command is executed as usual, but networking layer drops its
+     * output and has nothing to write
+     */
+    inline bool NoReply() const { return _noreply; }
+    inline void SetNoReply(bool noreply) { _noreply = noreply; }
+
+private:
+    bool _noreply;
 };
 
 } // namespace Execute
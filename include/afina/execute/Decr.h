@@ -0,0 +1,43 @@
+#ifndef AFINA_EXECUTE_DECR_H
+#define AFINA_EXECUTE_DECR_H
+
+#include <cstdint>
+#include <string>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Decrement numeric value
+ * Subtracts given amount from the value of the key, which must be a decimal
+ * representation of 64-bit unsigned integer. Value never gets below 0
+ *
+ * Command must write result to the output, which could be:
+ * - "<value>", the new value of the item.
+ * - "NOT_FOUND" to indicate the item with this key was not found.
+ * - "CLIENT_ERROR cannot increment or decrement non-numeric value" if the
+ * value isn't a number.
+ */
+class Decr : public Command {
+public:
+    Decr(const std::string &key, uint64_t delta) : _key(key), _delta(delta) {}
+    ~Decr() {}
+
+    inline const std::string &key() const { return _key; }
+    inline uint64_t delta() const { return _delta; }
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    Metrics::CommandType Type() const override { return Metrics::CommandType::Decr; }
+
+private:
+    const std::string _key;
+    const uint64_t _delta;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_DECR_H
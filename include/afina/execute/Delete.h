@@ -1,6 +1,8 @@
 #ifndef AFINA_EXECUTE_DELETE_H
 #define AFINA_EXECUTE_DELETE_H
 
+#include <string>
+
 #include "Command.h"
 
 namespace Afina {
@@ -17,10 +19,17 @@ namespace Execute {
  */
 class Delete : public Command {
 public:
-    Delete();
-    ~Delete();
+    Delete(const std::string &key) : _key(key) {}
+    ~Delete() {}
+
+    inline const std::string &key() const { return _key; }
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    Metrics::CommandType Type() const override { return Metrics::CommandType::Delete; }
+
+private:
+    const std::string _key;
 };
 
 } // namespace Execute
@@ -2,8 +2,12 @@
 #define AFINA_EXECUTE_GET_H
 
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <afina/Storage.h>
+#include <afina/StringView.h>
+
 #include "Command.h"
 
 namespace Afina {
@@ -18,31 +22,73 @@ namespace Execute {
  * the items have been transmitted, the server sends the string
  *
  * Each item sent by the server looks like this:
- * VALUE <key> <bytes>\r\n
+ * VALUE <key> <flags> <bytes>\r\n
  * <data>\r\n
  * VALUE ....
  * END
  *
- * Where <key> is the key for the value, <bytes> is the number of bytes in the
- * value and <data> is the value text
+ * Where <key> is the key for the value, <flags> are the client flags stored
+ * with the item, <bytes> is the number of bytes in the value and <data> is
+ * the value text
+ *
+ * "gets" adds version of each item to the end of its line, which could be
+ * passed to "cas" later on:
+ * VALUE <key> <flags> <bytes> <cas unique>\r\n
  *
  * If some of the keys appearing in a retrieval request are not sent back
  * by the server in the item list this means that the server does not
  * hold items with such keys (because they were never stored, or stored
  * but deleted to make space for more items, or expired, or explicitly
  * deleted by a client).
+ *
+ * Keys could be views into memory of the caller, so that command is built without copying them, see
+ * constructor taking views.
  */
 class Get : public Command {
 public:
-    Get(const std::vector<std::string> &keys) : _keys(keys) {}
+    Get(const std::vector<std::string> &keys, bool with_cas = false)
+        : _owned(keys), _keys(_owned.begin(), _owned.end()), _with_cas(with_cas) {
+        for (auto &key : _owned) {
+            _hashes.push_back(KeyHash(key));
+        }
+    }
+
+    // Keys come with KeyHash of each one computed by the caller, usually by the parser
+    Get(const std::vector<std::string> &keys, const std::vector<std::size_t> &hashes, bool with_cas = false)
+        : _owned(keys), _keys(_owned.begin(), _owned.end()), _hashes(hashes), _with_cas(with_cas) {}
+
+    // Same as above, but keys aren't copied: views must stay valid until the command is executed and
+    // replied, see Reply
+    Get(std::vector<StringView> &&keys, std::vector<std::size_t> &&hashes, bool with_cas = false)
+        : _keys(std::move(keys)), _hashes(std::move(hashes)), _with_cas(with_cas) {}
     ~Get() {}
 
-    inline const std::vector<std::string> &keys() const { return _keys; }
+    inline const std::vector<StringView> &keys() const { return _keys; }
+    inline const std::vector<std::size_t> &hashes() const { return _hashes; }
+    inline bool withCas() const { return _with_cas; }
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
 
+    void Execute(Storage &storage, const std::string &args, std::vector<Value> &out) override;
+
+    Metrics::CommandType Type() const override { return Metrics::CommandType::Get; }
+
+    /**
+     * Appends response to out given lookup results of the keys, one per key in the same order. Values are
+     * moved out of the results. Lets the caller run lookups on its own, for example split them between
+     * storage shards. Hits and misses are counted here, see Metrics
+     */
+    void Reply(std::vector<LookupResult> &results, std::vector<Value> &out) const;
+
 private:
-    std::vector<std::string> _keys;
+    Get(const Get &) = delete;
+    Get &operator=(const Get &) = delete;
+
+    // Keys given as strings, _keys refer to them
+    std::vector<std::string> _owned;
+    std::vector<StringView> _keys;
+    std::vector<std::size_t> _hashes;
+    bool _with_cas;
 };
 
 } // namespace Execute
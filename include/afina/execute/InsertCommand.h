@@ -2,8 +2,11 @@
 #define AFINA_EXECUTE_INSERT_COMMAND_H
 
 #include <cstdint>
+#include <ctime>
 #include <string>
 
+#include <afina/KeyHash.h>
+
 #include "Command.h"
 
 namespace Afina {
@@ -15,15 +18,43 @@ namespace Execute {
  */
 class InsertCommand : public Command {
 public:
-    InsertCommand(const std::string &key, uint32_t flags, int32_t expire) : _key(key), _flags(flags), _expire(expire) {}
+    InsertCommand(const std::string &key, uint32_t flags, int32_t expire)
+        : _key(key), _hash(KeyHash(key)), _flags(flags), _expire(expire) {}
+
+    // Key comes with KeyHash computed by the caller, usually by the parser
+    InsertCommand(const std::string &key, uint32_t flags, int32_t expire, std::size_t hash)
+        : _key(key), _hash(hash), _flags(flags), _expire(expire) {}
     ~InsertCommand() {}
 
     inline const std::string &key() const { return _key; }
+    inline std::size_t keyHash() const { return _hash; }
     inline const uint32_t flags() const { return _flags; }
     inline const int32_t expire() const { return _expire; }
 
 protected:
+    // Expire times larger than that are unix time, smaller ones are relative to now
+    static const int32_t MaxRelativeExpire = 60 * 60 * 24 * 30;
+
+    /**
+     * Converts protocol expire time to the absolute one of ItemMeta. Returns false if item expires right
+     * away: expire time is negative or in the past
+     */
+    bool expireTime(uint32_t &expire) const {
+        if (_expire == 0) {
+            expire = 0;
+            return true;
+        }
+        int64_t now = std::time(nullptr);
+        int64_t result = _expire > MaxRelativeExpire ? _expire : now + _expire;
+        if (_expire < 0 || result <= now) {
+            return false;
+        }
+        expire = static_cast<uint32_t>(result);
+        return true;
+    }
+
     const std::string _key;
+    const std::size_t _hash;
     const uint32_t _flags;
     const int32_t _expire;
 };
@@ -0,0 +1,50 @@
+#ifndef AFINA_EXECUTE_META_ARITHMETIC_H
+#define AFINA_EXECUTE_META_ARITHMETIC_H
+
+#include <string>
+#include <vector>
+
+#include "MetaCommand.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Increment or decrement numeric value
+ * ma <key> <flags>*
+ *
+ * Flags:
+ * - D<delta>: amount to add or subtract, 1 by default
+ * - M<mode>: I or + increment, default one, D or - decrement
+ * - N<ttl>: create missing item with the given expire time
+ * - J<initial>: value of the created item, 0 by default
+ * - v: return the new value
+ * - k, O, q: see MetaCommand
+ *
+ * Command must write result to the output, which could be:
+ * - "VA <size> <flags>*" followed by the new value if it was asked for
+ * - "HD <flags>*" if value is changed or created, nothing in quiet mode
+ * - "NF <flags>*" if item doesn't exist and N isn't given
+ * - "CLIENT_ERROR cannot increment or decrement non-numeric value" if the value isn't a number
+ */
+class MetaArithmetic : public MetaCommand {
+public:
+    MetaArithmetic(const std::string &key, const std::vector<std::string> &flags) : MetaCommand(key, flags) {}
+    MetaArithmetic(const std::string &key, const std::vector<std::string> &flags, std::size_t hash)
+        : MetaCommand(key, flags, hash) {}
+    ~MetaArithmetic() {}
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    Metrics::CommandType Type() const override {
+        return decrement() ? Metrics::CommandType::Decr : Metrics::CommandType::Incr;
+    }
+
+private:
+    bool decrement() const;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_META_ARITHMETIC_H
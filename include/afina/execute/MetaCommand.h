@@ -0,0 +1,78 @@
+#ifndef AFINA_EXECUTE_META_COMMAND_H
+#define AFINA_EXECUTE_META_COMMAND_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <afina/KeyHash.h>
+#include <afina/Storage.h>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Basic class for meta commands
+ * Meta command is a key followed by flags: single letter tokens, some of them with a value right after the
+ * letter, such as "T30" or "Oabc". Flags tell what to do and which of the item attributes to return, response
+ * carries only those that were asked for:
+ *
+ *     mg foo v f t
+ *     VA 3 f0 t-1
+ *     bar
+ *
+ * Each command accepts its own set of flags, others are answered with "CLIENT_ERROR invalid flag". Common
+ * ones are:
+ * - q: quiet mode, command says nothing when it does what is expected, see each command
+ * - O<token>: opaque, echoed back as is so that client could match responses
+ * - k: return key
+ */
+class MetaCommand : public Command {
+public:
+    MetaCommand(const std::string &key, const std::vector<std::string> &flags)
+        : _key(key), _hash(KeyHash(key)), _flags(flags) {}
+
+    // Key comes with KeyHash computed by the caller, usually by the parser
+    MetaCommand(const std::string &key, const std::vector<std::string> &flags, std::size_t hash)
+        : _key(key), _hash(hash), _flags(flags) {}
+    ~MetaCommand() {}
+
+    inline const std::string &key() const { return _key; }
+    inline std::size_t keyHash() const { return _hash; }
+    inline const std::vector<std::string> &flags() const { return _flags; }
+
+protected:
+    /**
+     * Returns true if flag is given
+     */
+    bool hasFlag(char flag) const;
+
+    /**
+     * Reads number that follows the flag into value, value is kept if there is no such flag. Returns false
+     * if the flag has no number or it doesn't fit the type
+     */
+    bool numberFlag(char flag, int64_t &value) const;
+    bool numberFlag(char flag, uint64_t &value) const;
+
+    /**
+     * Returns false if there is a flag which letter is not among allowed ones
+     */
+    bool checkFlags(const char *allowed) const;
+
+    /**
+     * Appends " <flag><value>" for each flag asking for the attribute, in the order of request: O, k and,
+     * if meta is given, f, t, c and s of the item which value is size bytes long
+     */
+    void appendFlags(std::string &out, const ItemMeta *meta = nullptr, std::size_t size = 0) const;
+
+    const std::string _key;
+    const std::size_t _hash;
+    const std::vector<std::string> _flags;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_META_COMMAND_H
@@ -0,0 +1,40 @@
+#ifndef AFINA_EXECUTE_META_DELETE_H
+#define AFINA_EXECUTE_META_DELETE_H
+
+#include <string>
+#include <vector>
+
+#include "MetaCommand.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Remove association for the key
+ * md <key> <flags>*
+ *
+ * Flags:
+ * - C<cas>: delete only if version of the item is still the given one
+ * - k, O, q: see MetaCommand
+ *
+ * Command must write result to the output, which could be:
+ * - "HD <flags>*" if item is deleted, nothing in quiet mode
+ * - "NF <flags>*" if it doesn't exist
+ * - "EX <flags>*" if item has been changed since version C was taken
+ */
+class MetaDelete : public MetaCommand {
+public:
+    MetaDelete(const std::string &key, const std::vector<std::string> &flags) : MetaCommand(key, flags) {}
+    MetaDelete(const std::string &key, const std::vector<std::string> &flags, std::size_t hash)
+        : MetaCommand(key, flags, hash) {}
+    ~MetaDelete() {}
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    Metrics::CommandType Type() const override { return Metrics::CommandType::Delete; }
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_META_DELETE_H
@@ -0,0 +1,47 @@
+#ifndef AFINA_EXECUTE_META_GET_H
+#define AFINA_EXECUTE_META_GET_H
+
+#include <string>
+#include <vector>
+
+#include "MetaCommand.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Retrive value and attributes of the key
+ * mg <key> <flags>*
+ *
+ * Flags:
+ * - v: return value
+ * - f: return client flags
+ * - t: return seconds left to live, -1 if item never expires
+ * - c: return version of the item for compare-and-swap
+ * - s: return size of the value
+ * - k, O, q: see MetaCommand
+ *
+ * Command must write result to the output, which could be:
+ * - "VA <size> <flags>*" followed by the value if it was asked for
+ * - "HD <flags>*" if item is found
+ * - "EN" if it isn't, nothing in quiet mode
+ */
+class MetaGet : public MetaCommand {
+public:
+    MetaGet(const std::string &key, const std::vector<std::string> &flags) : MetaCommand(key, flags) {}
+    MetaGet(const std::string &key, const std::vector<std::string> &flags, std::size_t hash)
+        : MetaCommand(key, flags, hash) {}
+    ~MetaGet() {}
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    // Value is passed as is, as in Get
+    void Execute(Storage &storage, const std::string &args, std::vector<Value> &out) override;
+
+    Metrics::CommandType Type() const override { return Metrics::CommandType::Get; }
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_META_GET_H
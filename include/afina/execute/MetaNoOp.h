@@ -0,0 +1,29 @@
+#ifndef AFINA_EXECUTE_META_NOOP_H
+#define AFINA_EXECUTE_META_NOOP_H
+
+#include <string>
+
+#include "Command.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Do nothing
+ * mn
+ *
+ * Command writes "MN" to the output. Commands are answered in order, so once client sees it all quiet
+ * commands sent before are done
+ */
+class MetaNoOp : public Command {
+public:
+    MetaNoOp() {}
+    ~MetaNoOp() {}
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_META_NOOP_H
@@ -0,0 +1,49 @@
+#ifndef AFINA_EXECUTE_META_SET_H
+#define AFINA_EXECUTE_META_SET_H
+
+#include <string>
+#include <vector>
+
+#include "MetaCommand.h"
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Store value for the key
+ * ms <key> <datalen> <flags>*
+ * <data>
+ *
+ * Flags:
+ * - T<ttl>: expire time, as of set
+ * - F<flags>: client flags to store
+ * - C<cas>: store only if version of the item is still the given one, as cas does. Set mode only
+ * - M<mode>: S set, default one, E add, A append, P prepend, R replace
+ * - k, O, q: see MetaCommand
+ *
+ * Command must write result to the output, which could be:
+ * - "HD <flags>*" if value is stored, nothing in quiet mode
+ * - "NS <flags>*" if it isn't as condition of the mode wasn't met
+ * - "EX <flags>*" if item has been changed since version C was taken
+ * - "NF <flags>*" if item to swap doesn't exist
+ */
+class MetaSet : public MetaCommand {
+public:
+    MetaSet(const std::string &key, const std::vector<std::string> &flags) : MetaCommand(key, flags) {}
+    MetaSet(const std::string &key, const std::vector<std::string> &flags, std::size_t hash)
+        : MetaCommand(key, flags, hash) {}
+    ~MetaSet() {}
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    Metrics::CommandType Type() const override;
+
+private:
+    // Mode letter, upper case
+    char mode() const;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_META_SET_H
@@ -0,0 +1,164 @@
+#ifndef AFINA_EXECUTE_METRICS_H
+#define AFINA_EXECUTE_METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <afina/concurrency/ThreadLocal.h>
+
+namespace Afina {
+namespace Execute {
+
+/**
+ * # Server counters reported by stats command
+ * Every thread records into its own counters, see Concurrency::ThreadLocal, so hot path never writes shared
+ * memory and takes no locks: increment is a plain load and store of the thread's cache line. Counters of
+ * all threads are merged only when stats are requested.
+ *
+ * Counters are process wide, network layer records connections and command latency, commands record what
+ * they have found.
+ */
+class Metrics {
+public:
+    // Commands with separate counters and latency histograms
+    enum class CommandType { Get, Set, Add, Replace, Append, Prepend, Cas, Incr, Decr, Delete, Stats, Other };
+
+    static const std::size_t CommandTypesCount = static_cast<std::size_t>(CommandType::Other) + 1;
+
+    // Name used in stats output
+    static const char *NameOf(CommandType type);
+
+    /**
+     * Counter changed by one thread and read by any, so increment needs no atomic read-modify-write
+     */
+    class Counter {
+    public:
+        Counter() : _value(0) {}
+
+        inline void Add(uint64_t delta) {
+            _value.store(_value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+        }
+
+        inline uint64_t Load() const { return _value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> _value;
+    };
+
+    /**
+     * Log-linear histogram: values below 2^SubBits have own buckets, above that each power of two is split
+     * into 2^SubBits equal buckets, so that bucket bounds are within 12.5% of any value in it. Recording is
+     * a few shifts and one Counter::Add
+     */
+    class Histogram {
+    public:
+        static const unsigned SubBits = 3;
+        static const std::size_t BucketsCount = (64 - SubBits + 1) << SubBits;
+
+        inline void Record(uint64_t value) { _buckets[BucketOf(value)].Add(1); }
+
+        inline uint64_t Bucket(std::size_t i) const { return _buckets[i].Load(); }
+
+        static inline std::size_t BucketOf(uint64_t value) {
+            if (value < (1u << SubBits)) {
+                return value;
+            }
+            unsigned shift = 63 - __builtin_clzll(value) - SubBits;
+            return ((shift + 1) << SubBits) + ((value >> shift) & ((1u << SubBits) - 1));
+        }
+
+        // Smallest value of the bucket
+        static inline uint64_t LowerBound(std::size_t bucket) {
+            if (bucket < (1u << SubBits)) {
+                return bucket;
+            }
+            unsigned shift = (bucket >> SubBits) - 1;
+            return ((1ull << SubBits) | (bucket & ((1u << SubBits) - 1))) << shift;
+        }
+
+    private:
+        Counter _buckets[BucketsCount];
+    };
+
+    // Counters of one thread
+    struct ThreadCounters {
+        // Executed commands and their latency in nanoseconds
+        Counter commands[CommandTypesCount];
+        Histogram latency[CommandTypesCount];
+
+        // Keys requested by get and gets
+        Counter get_hits;
+        Counter get_misses;
+
+        // Connections accepted and closed by the thread, which could be different ones
+        Counter connections_opened;
+        Counter connections_closed;
+    };
+
+    /**
+     * Counters of the calling thread
+     */
+    static inline ThreadCounters &Local() { return instance()._threads.Get(); }
+
+    /**
+     * Monotonic time in nanoseconds for latency measurement
+     */
+    static inline uint64_t Now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    /**
+     * Records command of the given type started at the given Now()
+     */
+    static inline void CommandDone(CommandType type, uint64_t start) {
+        ThreadCounters &local = Local();
+        std::size_t i = static_cast<std::size_t>(type);
+        local.commands[i].Add(1);
+        local.latency[i].Record(Now() - start);
+    }
+
+    /**
+     * Measures command executed while it is alive
+     */
+    class Timer {
+    public:
+        explicit Timer(CommandType type) : _type(type), _start(Now()) {}
+        ~Timer() { CommandDone(_type, _start); }
+
+    private:
+        CommandType _type;
+        uint64_t _start;
+    };
+
+    /**
+     * Merges counters of all threads into stats name -> value: totals first, then per thread counters named
+     * thread:<n>:<counter> and latency percentiles of each command type that was executed, named
+     * latency:<command>:<percentile>_ns
+     */
+    static void Collect(std::vector<std::pair<std::string, uint64_t>> &stats);
+
+private:
+    Metrics();
+
+    static inline Metrics &instance() {
+        static Metrics metrics;
+        return metrics;
+    }
+
+    Concurrency::ThreadLocal<ThreadCounters> _threads;
+
+    // Unix time the counting has started at
+    uint64_t _started;
+};
+
+} // namespace Execute
+} // namespace Afina
+
+#endif // AFINA_EXECUTE_METRICS_H
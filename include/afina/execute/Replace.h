@@ -25,6 +25,8 @@ public:
     ~Replace() {}
 
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    Metrics::CommandType Type() const override { return Metrics::CommandType::Replace; }
 };
 
 } // namespace Execute
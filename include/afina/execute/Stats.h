@@ -13,6 +13,8 @@ public:
     Stats() {}
     ~Stats() {}
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    Metrics::CommandType Type() const override { return Metrics::CommandType::Stats; }
 };
 
 } // namespace Execute
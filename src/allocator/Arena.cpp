@@ -0,0 +1,75 @@
+#include <afina/allocator/Arena.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace Afina {
+namespace Allocator {
+
+const std::size_t Arena::HeaderSize;
+
+Arena::Arena(std::size_t chunk_size, std::size_t max_retained)
+    : _chunk_size(chunk_size), _max_retained(max_retained), _chunks(nullptr), _pos(nullptr), _end(nullptr),
+      _used(0), _capacity(0) {}
+
+Arena::~Arena() { freeChunks(); }
+
+// See Arena.h
+void *Arena::Allocate(std::size_t size) {
+    const std::size_t align = alignof(std::max_align_t);
+    std::size_t padding = (align - reinterpret_cast<uintptr_t>(_pos) % align) % align;
+    if (_pos == nullptr || static_cast<std::size_t>(_end - _pos) < size + padding) {
+        // Chunks grow geometrically, so that large requests take a few of them
+        addChunk(std::max(size, std::max(_chunk_size, _capacity)));
+        padding = 0;
+    }
+    char *block = _pos + padding;
+    _pos = block + size;
+    _used += size;
+    return block;
+}
+
+// See Arena.h
+void Arena::Reset() {
+    _used = 0;
+    if (_chunks == nullptr) {
+        return;
+    }
+    if (_chunks->next != nullptr || _capacity > _max_retained) {
+        std::size_t size = std::min(_capacity, std::max(_chunk_size, _max_retained));
+        freeChunks();
+        addChunk(size);
+        return;
+    }
+    _pos = reinterpret_cast<char *>(_chunks) + HeaderSize;
+}
+
+void Arena::addChunk(std::size_t size) {
+    void *memory = std::malloc(HeaderSize + size);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    Chunk *chunk = static_cast<Chunk *>(memory);
+    chunk->next = _chunks;
+    chunk->size = size;
+    _chunks = chunk;
+    _pos = static_cast<char *>(memory) + HeaderSize;
+    _end = _pos + size;
+    _capacity += size;
+}
+
+void Arena::freeChunks() {
+    while (_chunks != nullptr) {
+        Chunk *next = _chunks->next;
+        std::free(_chunks);
+        _chunks = next;
+    }
+    _pos = nullptr;
+    _end = nullptr;
+    _capacity = 0;
+}
+
+} // namespace Allocator
+} // namespace Afina
@@ -1,40 +1,352 @@
 #include <afina/allocator/Simple.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <afina/allocator/Error.h>
 #include <afina/allocator/Pointer.h>
 
 namespace Afina {
 namespace Allocator {
 
-Simple::Simple(void *base, size_t size) : _base(base), _base_len(size) {}
-
-/**
- * TODO: semantics
- * @param N size_t
- */
-Pointer Simple::alloc(size_t N) { return Pointer(); }
-
-/**
- * TODO: semantics
- * @param p Pointer
- * @param N size_t
- */
-void Simple::realloc(Pointer &p, size_t N) {}
-
-/**
- * TODO: semantics
- * @param p Pointer
- */
-void Simple::free(Pointer &p) {}
-
-/**
- * TODO: semantics
- */
-void Simple::defrag() {}
-
-/**
- * TODO: semantics
- */
-std::string Simple::dump() const { return ""; }
+namespace {
+
+// Block layout, all fields are words:
+//
+// used: [size][slot][payload ...][size]
+// free: [size | 1][prev free][next free][...][size | 1]
+//
+// Size is of the whole block including header and footer, so both neighbours are found from the block
+const size_t Word = sizeof(void *);
+const size_t HeaderSize = 2 * Word;
+const size_t FooterSize = Word;
+const size_t MinBlock = HeaderSize + Word + FooterSize;
+
+inline size_t &sizeField(char *block) { return *reinterpret_cast<size_t *>(block); }
+inline size_t sizeOf(char *block) { return sizeField(block) & ~size_t(1); }
+inline bool isFree(char *block) { return (sizeField(block) & 1) != 0; }
+
+inline void setBlock(char *block, size_t size, bool free) {
+    sizeField(block) = size | (free ? 1 : 0);
+    *reinterpret_cast<size_t *>(block + size - FooterSize) = size | (free ? 1 : 0);
+}
+
+inline void **&slotOf(char *block) { return *reinterpret_cast<void ***>(block + Word); }
+inline char *&prevFree(char *block) { return *reinterpret_cast<char **>(block + Word); }
+inline char *&nextFree(char *block) { return *reinterpret_cast<char **>(block + 2 * Word); }
+
+inline char *payload(char *block) { return block + HeaderSize; }
+inline char *blockOf(void *payload) { return static_cast<char *>(payload) - HeaderSize; }
+
+inline char *alignUp(char *p) {
+    return reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(p) + Word - 1) & ~uintptr_t(Word - 1));
+}
+
+inline char *alignDown(char *p) {
+    return reinterpret_cast<char *>(reinterpret_cast<uintptr_t>(p) & ~uintptr_t(Word - 1));
+}
+
+// Is there room for size bytes from begin to end
+inline bool fits(char *begin, char *end, size_t size) {
+    return end >= begin && static_cast<size_t>(end - begin) >= size;
+}
+
+} // namespace
+
+Simple::Simple(void *base, size_t size)
+    : _base(base), _base_len(size), _free_slots(nullptr), _free_blocks(nullptr), _holes(0) {
+    _begin = alignUp(static_cast<char *>(base));
+    _end = std::max(_begin, alignDown(static_cast<char *>(base) + size));
+    _top = _begin;
+    _slots = _end;
+    _cursor = _begin;
+}
+
+// See Simple.h
+Pointer Simple::alloc(size_t N) {
+    // Slot is taken from the end of blocks space if there are no released ones
+    char *limit = _slots;
+    if (_free_slots == nullptr) {
+        if (!fits(_top, _slots, Word)) {
+            throw AllocError(AllocErrorType::NoMemory, "No room for the handle slot");
+        }
+        limit -= Word;
+    }
+    char *block = takeBlock(blockSize(N), limit);
+    if (block == nullptr) {
+        throw AllocError(AllocErrorType::NoMemory, "No block of " + std::to_string(N) + " bytes available");
+    }
+
+    void **slot;
+    if (_free_slots != nullptr) {
+        slot = _free_slots;
+        _free_slots = static_cast<void **>(*slot);
+    } else {
+        _slots -= Word;
+        slot = reinterpret_cast<void **>(_slots);
+    }
+    slotOf(block) = slot;
+    *slot = payload(block);
+    return Pointer(slot);
+}
+
+// See Simple.h
+void Simple::realloc(Pointer &p, size_t N) {
+    if (p._slot == nullptr) {
+        p = alloc(N);
+        return;
+    }
+
+    char *block = usedBlock(p);
+    size_t size = blockSize(N);
+    size_t have = sizeOf(block);
+    if (size <= have) {
+        shrinkBlock(block, size);
+        return;
+    }
+
+    // Grow in place into the free space that follows
+    char *next = block + have;
+    if (next == _top) {
+        if (fits(_top, _slots, size - have)) {
+            if (_cursor == _top) {
+                _cursor = block;
+            }
+            _top += size - have;
+            setBlock(block, size, false);
+            return;
+        }
+    } else if (isFree(next) && have + sizeOf(next) >= size) {
+        unlinkFree(next);
+        if (_cursor == next) {
+            _cursor = block;
+        }
+        setBlock(block, have + sizeOf(next), false);
+        shrinkBlock(block, size);
+        return;
+    }
+
+    char *moved = takeBlock(size, _slots);
+    if (moved == nullptr) {
+        throw AllocError(AllocErrorType::NoMemory, "No block of " + std::to_string(N) + " bytes available");
+    }
+    std::memcpy(payload(moved), payload(block), have - HeaderSize - FooterSize);
+    slotOf(moved) = p._slot;
+    *p._slot = payload(moved);
+    releaseRange(block, have);
+}
+
+// See Simple.h
+void Simple::free(Pointer &p) {
+    if (p._slot == nullptr) {
+        return;
+    }
+
+    char *block = usedBlock(p);
+    *p._slot = _free_slots;
+    _free_slots = p._slot;
+    releaseRange(block, sizeOf(block));
+    p._slot = nullptr;
+}
+
+// See Simple.h
+char *Simple::usedBlock(const Pointer &p) const {
+    char *slot = reinterpret_cast<char *>(p._slot);
+    if (slot < _slots || slot >= _end || (slot - _slots) % Word != 0) {
+        throw AllocError(AllocErrorType::InvalidFree, "Pointer doesn't belong to the allocator");
+    }
+    // Released slot keeps either nullptr or address of another slot, never a payload
+    char *data = static_cast<char *>(*p._slot);
+    if (data == nullptr || data < _begin + HeaderSize || data >= _top) {
+        throw AllocError(AllocErrorType::InvalidFree, "Block is already free");
+    }
+    char *block = blockOf(data);
+    if (isFree(block) || slotOf(block) != p._slot) {
+        throw AllocError(AllocErrorType::InvalidFree, "Block is already free");
+    }
+    return block;
+}
+
+// See Simple.h
+void Simple::defrag() { defrag(SIZE_MAX); }
+
+// See Simple.h
+bool Simple::defrag(size_t max_bytes) {
+    size_t passed = 0;
+    for (;;) {
+        if (_cursor >= _top) {
+            // Blocks released behind the cursor since the pass started left holes there
+            _cursor = _begin;
+            if (_holes == 0) {
+                return true;
+            }
+        }
+        if (passed >= max_bytes) {
+            return false;
+        }
+
+        char *block = _cursor;
+        size_t size = sizeOf(block);
+        if (!isFree(block)) {
+            _cursor += size;
+            passed += size;
+            continue;
+        }
+
+        char *next = block + size;
+        unlinkFree(block);
+        if (next == _top) {
+            _top = block;
+            continue;
+        }
+
+        // Free neighbours are always merged, so the next one is used. It moves down and the hole goes
+        // up, merging with whatever is free after it
+        size_t used = sizeOf(next);
+        std::memmove(block, next, used);
+        *slotOf(block) = payload(block);
+        _cursor = block + used;
+        releaseRange(_cursor, size);
+        passed += used;
+    }
+}
+
+// See Simple.h
+size_t Simple::available() const {
+    size_t largest = 0;
+    if (_top + Word <= _slots) {
+        // Room for the slot as well in case there is no released one
+        largest = _slots - _top - (_free_slots == nullptr ? Word : 0);
+    }
+    for (char *block = _free_blocks; block != nullptr; block = nextFree(block)) {
+        largest = std::max(largest, sizeOf(block));
+    }
+    return largest > HeaderSize + FooterSize ? largest - HeaderSize - FooterSize : 0;
+}
+
+// See Simple.h
+std::string Simple::dump() const {
+    size_t used = 0, used_bytes = 0, holes = 0;
+    for (char *block = _begin; block < _top; block += sizeOf(block)) {
+        if (isFree(block)) {
+            holes++;
+        } else {
+            used++;
+            used_bytes += sizeOf(block);
+        }
+    }
+    size_t free_slots = 0;
+    for (void **slot = _free_slots; slot != nullptr; slot = static_cast<void **>(*slot)) {
+        free_slots++;
+    }
+
+    char out[256];
+    std::snprintf(out, sizeof(out),
+                  "%zu bytes: %zu blocks of %zu bytes used, %zu holes of %zu bytes, %zu bytes at the end, %zu "
+                  "slots with %zu free\n",
+                  static_cast<size_t>(_end - _begin), used, used_bytes, holes, _holes,
+                  static_cast<size_t>(_slots - _top), static_cast<size_t>(_end - _slots) / Word, free_slots);
+    return out;
+}
+
+size_t Simple::blockSize(size_t N) {
+    // Requests that large never fit, but block size must not overflow
+    if (N > SIZE_MAX / 2) {
+        return SIZE_MAX / 2;
+    }
+    return std::max(MinBlock, (N + Word - 1) / Word * Word + HeaderSize + FooterSize);
+}
+
+char *Simple::takeBlock(size_t size, char *limit) {
+    for (char *block = _free_blocks; block != nullptr; block = nextFree(block)) {
+        size_t have = sizeOf(block);
+        if (have < size) {
+            continue;
+        }
+        unlinkFree(block);
+        if (have - size >= MinBlock) {
+            // Block after a free one is always used, so the rest needs no merging
+            setBlock(block, size, false);
+            setBlock(block + size, have - size, true);
+            linkFree(block + size);
+        } else {
+            setBlock(block, have, false);
+        }
+        return block;
+    }
+
+    if (!fits(_top, limit, size)) {
+        return nullptr;
+    }
+    char *block = _top;
+    _top += size;
+    setBlock(block, size, false);
+    return block;
+}
+
+void Simple::shrinkBlock(char *block, size_t size) {
+    size_t have = sizeOf(block);
+    if (have - size >= MinBlock) {
+        setBlock(block, size, false);
+        releaseRange(block + size, have - size);
+    }
+}
+
+void Simple::releaseRange(char *block, size_t size) {
+    char *next = block + size;
+    if (next != _top && isFree(next)) {
+        unlinkFree(next);
+        if (_cursor == next) {
+            _cursor = block;
+        }
+        size += sizeOf(next);
+    }
+
+    if (block > _begin) {
+        size_t prev_size = *reinterpret_cast<size_t *>(block - FooterSize);
+        if ((prev_size & 1) != 0) {
+            char *prev = block - (prev_size & ~size_t(1));
+            unlinkFree(prev);
+            if (_cursor == block) {
+                _cursor = prev;
+            }
+            size += block - prev;
+            block = prev;
+        }
+    }
+
+    if (block + size == _top) {
+        _top = block;
+        _cursor = std::min(_cursor, _top);
+        return;
+    }
+    setBlock(block, size, true);
+    linkFree(block);
+}
+
+void Simple::linkFree(char *block) {
+    prevFree(block) = nullptr;
+    nextFree(block) = _free_blocks;
+    if (_free_blocks != nullptr) {
+        prevFree(_free_blocks) = block;
+    }
+    _free_blocks = block;
+    _holes += sizeOf(block);
+}
+
+void Simple::unlinkFree(char *block) {
+    if (prevFree(block) != nullptr) {
+        nextFree(prevFree(block)) = nextFree(block);
+    } else {
+        _free_blocks = nextFree(block);
+    }
+    if (nextFree(block) != nullptr) {
+        prevFree(nextFree(block)) = prevFree(block);
+    }
+    _holes -= sizeOf(block);
+}
 
 } // namespace Allocator
 } // namespace Afina
@@ -0,0 +1,225 @@
+#include <afina/allocator/Slab.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <new>
+#include <sys/mman.h>
+
+namespace Afina {
+namespace Allocator {
+
+const std::size_t Slab::PageSize;
+const std::size_t Slab::MinSize;
+const std::size_t Slab::MaxSize;
+const std::size_t Slab::Growth;
+const std::size_t Slab::Alignment;
+
+Slab::ClassTable::ClassTable() : count(0) {
+    std::size_t size = MinSize;
+    while (true) {
+        sizes[count++] = size;
+        if (size == MaxSize) {
+            break;
+        }
+        // Rounded down, so that rounding up to the class never wastes more than growth promises
+        size = std::min(MaxSize, std::max(size + Alignment, size * Growth / 100 / Alignment * Alignment));
+    }
+    std::size_t size_class = 0;
+    for (std::size_t i = 0; i <= MaxSize / Alignment; ++i) {
+        if (i * Alignment > sizes[size_class]) {
+            size_class++;
+        }
+        index[i] = size_class;
+    }
+}
+
+// See Slab.h
+const Slab::ClassTable &Slab::classTable() {
+    static const ClassTable table;
+    return table;
+}
+
+Slab::Slab() : _classes(new SizeClass[MaxClasses]), _next_page(nullptr), _pages_left(0) {
+    const ClassTable &table = classTable();
+    for (std::size_t i = 0; i < table.count; ++i) {
+        SizeClass &size_class = _classes[i];
+        size_class.size = table.sizes[i];
+        size_class.per_page = (PageSize - HeaderSize) / size_class.size;
+        size_class.free = nullptr;
+        size_class.free_count = 0;
+        size_class.pages = 0;
+    }
+}
+
+Slab::~Slab() {
+    for (char *chunk : _chunks) {
+        munmap(chunk, ChunkPages * PageSize);
+    }
+}
+
+// See Slab.h
+Slab &Slab::Default() {
+    static Slab *slab = new Slab();
+    return *slab;
+}
+
+// See Slab.h
+void *Slab::Allocate(std::size_t size) {
+    if (size > MaxSize) {
+        return ::operator new(size);
+    }
+    std::size_t size_class = classOf(size);
+    ThreadCache &cache = _caches.Get();
+    Magazine &magazine = cache.magazines[size_class];
+    if (magazine.count == 0) {
+        refill(size_class, magazine);
+    }
+    cache.allocated[size_class].Add(1);
+    return magazine.blocks[--magazine.count];
+}
+
+// See Slab.h
+void Slab::Release(void *block, std::size_t size) {
+    if (size > MaxSize) {
+        ::operator delete(block);
+        return;
+    }
+    // Blocks never start at the page boundary, so the page is found by rounding the address down
+    PageHeader *page = reinterpret_cast<PageHeader *>(reinterpret_cast<uintptr_t>(block) & ~(PageSize - 1));
+    page->owner->release(block, page->size_class);
+}
+
+// See Slab.h
+std::size_t Slab::UsableSize(std::size_t size) {
+    if (size > MaxSize) {
+        return size;
+    }
+    return classTable().sizes[classOf(size)];
+}
+
+// See Slab.h
+std::size_t Slab::MemoryUsage() const {
+    std::lock_guard<std::mutex> lock(_chunks_mutex);
+    return _chunks.size() * ChunkPages * PageSize;
+}
+
+// See Slab.h
+std::string Slab::dump() const {
+    const ClassTable &table = classTable();
+    std::vector<uint64_t> used(table.count, 0);
+    _caches.ForEach([&](const ThreadCache &cache) {
+        for (std::size_t i = 0; i < table.count; ++i) {
+            used[i] += cache.allocated[i].Load() - cache.released[i].Load();
+        }
+    });
+
+    std::string out;
+    char line[128];
+    std::snprintf(line, sizeof(line), "%5s %8s %6s %10s %10s %10s %6s\n", "class", "size", "pages", "used", "cached",
+                  "free", "full%");
+    out += line;
+    std::size_t pages = 0;
+    for (std::size_t i = 0; i < table.count; ++i) {
+        SizeClass &size_class = _classes[i];
+        std::size_t class_pages, free;
+        {
+            std::lock_guard<std::mutex> lock(size_class.mutex);
+            class_pages = size_class.pages;
+            free = size_class.free_count;
+        }
+        if (class_pages == 0) {
+            continue;
+        }
+        pages += class_pages;
+
+        // Counters of threads are read one by one, so blocks moving between them could be seen twice
+        uint64_t total = class_pages * size_class.per_page;
+        uint64_t in_use = std::min<uint64_t>(used[i], total - free);
+        std::snprintf(line, sizeof(line), "%5zu %8zu %6zu %10llu %10llu %10zu %6.1f\n", i, size_class.size,
+                      class_pages, static_cast<unsigned long long>(in_use),
+                      static_cast<unsigned long long>(total - free - in_use), free,
+                      100.0 * in_use * size_class.size / (class_pages * PageSize));
+        out += line;
+    }
+    std::snprintf(line, sizeof(line), "total: %zu pages of %zu bytes, %zu bytes mapped\n", pages, PageSize,
+                  MemoryUsage());
+    out += line;
+    return out;
+}
+
+void Slab::release(void *block, std::size_t size_class) {
+    ThreadCache &cache = _caches.Get();
+    Magazine &magazine = cache.magazines[size_class];
+    if (magazine.count == MagazineSize) {
+        flush(size_class, magazine);
+    }
+    cache.released[size_class].Add(1);
+    magazine.blocks[magazine.count++] = block;
+}
+
+void Slab::refill(std::size_t size_class, Magazine &magazine) {
+    SizeClass &cls = _classes[size_class];
+    std::lock_guard<std::mutex> lock(cls.mutex);
+    if (cls.free == nullptr) {
+        char *page = newPage();
+        PageHeader *header = reinterpret_cast<PageHeader *>(page);
+        header->owner = this;
+        header->size_class = size_class;
+        for (std::size_t i = 0; i < cls.per_page; ++i) {
+            FreeBlock *block = reinterpret_cast<FreeBlock *>(page + HeaderSize + i * cls.size);
+            block->next = cls.free;
+            cls.free = block;
+        }
+        cls.free_count += cls.per_page;
+        cls.pages++;
+    }
+    while (magazine.count < BatchSize && cls.free != nullptr) {
+        magazine.blocks[magazine.count++] = cls.free;
+        cls.free = cls.free->next;
+        cls.free_count--;
+    }
+}
+
+void Slab::flush(std::size_t size_class, Magazine &magazine) {
+    SizeClass &cls = _classes[size_class];
+    std::lock_guard<std::mutex> lock(cls.mutex);
+    // Blocks released long ago go back, the recent ones are still warm in cache of this thread
+    for (std::size_t i = 0; i < BatchSize; ++i) {
+        FreeBlock *block = static_cast<FreeBlock *>(magazine.blocks[i]);
+        block->next = cls.free;
+        cls.free = block;
+    }
+    cls.free_count += BatchSize;
+    std::move(magazine.blocks + BatchSize, magazine.blocks + magazine.count, magazine.blocks);
+    magazine.count -= BatchSize;
+}
+
+char *Slab::newPage() {
+    std::lock_guard<std::mutex> lock(_chunks_mutex);
+    if (_pages_left == 0) {
+        // Mapping is aligned by PageSize by trimming the excess at both ends
+        std::size_t size = ChunkPages * PageSize;
+        void *mapped = mmap(nullptr, size + PageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        char *start = static_cast<char *>(mapped);
+        char *aligned = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(start) + PageSize - 1) & ~(PageSize - 1));
+        if (aligned != start) {
+            munmap(start, aligned - start);
+        }
+        if (aligned + size != start + size + PageSize) {
+            munmap(aligned + size, start + size + PageSize - (aligned + size));
+        }
+        _chunks.push_back(aligned);
+        _next_page = aligned;
+        _pages_left = ChunkPages;
+    }
+    char *page = _next_page;
+    _next_page += PageSize;
+    _pages_left--;
+    return page;
+}
+
+} // namespace Allocator
+} // namespace Afina
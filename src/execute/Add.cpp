@@ -10,7 +10,14 @@ namespace Execute {
 // hold data for this key".
 void Add::Execute(Storage &storage, const std::string &args, std::string &out) {
     std::cout << "Add(" << _key << ")" << args << std::endl;
-    out = storage.PutIfAbsent(_key, args) ? "STORED" : "NOT_STORED";
+    uint32_t expire;
+    if (!expireTime(expire)) {
+        // Item would expire at once, so only the result matters
+        std::string value;
+        out = storage.Get(_key, value) ? "NOT_STORED" : "STORED";
+        return;
+    }
+    out = storage.PutIfAbsent(_key, _hash, args, ItemMeta(_flags, expire)) ? "STORED" : "NOT_STORED";
 }
 
 } // namespace Execute
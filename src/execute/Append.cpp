@@ -6,16 +6,11 @@
 namespace Afina {
 namespace Execute {
 
-// memcached protocol: "append" means "add this data to an existing key after existing data".
+// memcached protocol: "append" means "add this data to an existing key after existing data". Flags and
+// expire time of the command are ignored, item keeps its own ones.
 void Append::Execute(Storage &storage, const std::string &args, std::string &out) {
     std::cout << "Append(" << _key << ")" << args << std::endl;
-    std::string value;
-    if (!storage.Get(_key, value)) {
-        out.assign("NOT_STORED");
-        return;
-    }
-    storage.Put(_key, value + args);
-    out.assign("STORED");
+    out.assign(storage.Append(_key, args) ? "STORED" : "NOT_STORED");
 }
 
 } // namespace Execute
@@ -0,0 +1,35 @@
+#include <afina/Storage.h>
+#include <afina/execute/Cas.h>
+
+namespace Afina {
+namespace Execute {
+
+// memcached protocol: "cas" is a check and set operation which means "store this data but only if no one
+// else has updated since I last fetched it."
+void Cas::Execute(Storage &storage, const std::string &args, std::string &out) {
+    uint32_t expire;
+    CasResult result;
+    if (expireTime(expire)) {
+        result = storage.CompareAndSet(_key, args, ItemMeta(_flags, expire), _cas);
+    } else {
+        // Item expires right away, successful swap is the same as delete
+        result = storage.CompareAndDelete(_key, _cas);
+    }
+
+    switch (result) {
+    case CasResult::Stored:
+        out.assign("STORED");
+        break;
+    case CasResult::Exists:
+        out.assign("EXISTS");
+        break;
+    case CasResult::NotFound:
+        out.assign("NOT_FOUND");
+        break;
+    default:
+        out.assign("NOT_STORED");
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -1 +1,16 @@
 #include <afina/execute/Command.h>
+
+namespace Afina {
+namespace Execute {
+
+// See Command.h
+void Command::Execute(Storage &storage, const std::string &args, std::vector<Value> &out) {
+    std::string result;
+    Execute(storage, args, result);
+    if (!result.empty()) {
+        out.push_back(Value::Copy(result));
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -1,10 +1,6 @@
 #include <afina/Storage.h>
 #include <afina/execute/Get.h>
 
-#include <iostream>
-#include <iterator>
-#include <sstream>
-
 namespace Afina {
 namespace Execute {
 
@@ -12,7 +8,7 @@ namespace Execute {
 
 Each item sent by the server looks like this:
 
-VALUE <key> <flags> <bytes>\r\n
+VALUE <key> <flags> <bytes> [<cas unique>]\r\n
 <data block>\r\n
 
 After all the items have been transmitted, the server sends the string
@@ -22,22 +18,47 @@ to indicate the end of response.
 */
 
 void Get::Execute(Storage &storage, const std::string &args, std::string &out) {
-    std::stringstream keyStream;
-    copy(_keys.begin(), _keys.end(), std::ostream_iterator<std::string>(keyStream, " "));
-    std::cout << "Get(" << keyStream.str() << ")" << std::endl;
+    std::vector<Value> chunks;
+    Execute(storage, args, chunks);
 
-    std::stringstream outStream;
+    out.clear();
+    for (auto &chunk : chunks) {
+        out.append(chunk.data(), chunk.size());
+    }
+}
+
+void Get::Execute(Storage &storage, const std::string &args, std::vector<Value> &out) {
+    std::vector<LookupResult> results;
+    storage.GetMany(_keys, _hashes, results);
+    Reply(results, out);
+}
 
-    std::string value;
-    for (auto &key : _keys) {
-        if (!storage.Get(key, value))
+void Get::Reply(std::vector<LookupResult> &results, std::vector<Value> &out) const {
+    // Values are passed as is, text in between of them gets merged into a single chunk:
+    // "\r\nVALUE <key> <flags> <bytes>\r\n"
+    std::string text;
+    uint64_t hits = 0;
+    for (std::size_t i = 0; i < _keys.size(); ++i) {
+        LookupResult &result = results[i];
+        if (!result.found)
             continue;
-        outStream << "VALUE " << key << " 0 " << value.size() << "\r\n";
-        outStream << value << "\r\n";
+        hits++;
+        text.append("VALUE ").append(_keys[i].data(), _keys[i].size()).append(" ").append(std::to_string(result.meta.flags)).append(" ");
+        text.append(std::to_string(result.value.size()));
+        if (_with_cas) {
+            text.append(" ").append(std::to_string(result.meta.cas));
+        }
+        text.append("\r\n");
+        out.push_back(Value::Copy(text));
+        out.push_back(std::move(result.value));
+        text.assign("\r\n");
     }
-    outStream << "END"; // networking layer should add the last \r\n
+    text.append("END"); // networking layer should add the last \r\n
+    out.push_back(Value::Copy(text));
 
-    out = outStream.str();
+    Metrics::ThreadCounters &counters = Metrics::Local();
+    counters.get_hits.Add(hits);
+    counters.get_misses.Add(_keys.size() - hits);
 }
 
 } // namespace Execute
@@ -0,0 +1,27 @@
+#include <afina/Storage.h>
+#include <afina/execute/Incr.h>
+
+namespace Afina {
+namespace Execute {
+
+// memcached protocol: "incr" is used to change data for some item in-place, incrementing it. The data for the item is treated as decimal representation of a 64-bit
+// unsigned integer.
+void Incr::Execute(Storage &storage, const std::string &args, std::string &out) {
+    uint64_t result;
+    switch (storage.Increment(_key, _delta, result)) {
+    case IncrResult::Stored:
+        out.assign(std::to_string(result));
+        break;
+    case IncrResult::NotFound:
+        out.assign("NOT_FOUND");
+        break;
+    case IncrResult::NotNumber:
+        out.assign("CLIENT_ERROR cannot increment or decrement non-numeric value");
+        break;
+    default:
+        out.assign("SERVER_ERROR out of memory storing object");
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -0,0 +1,86 @@
+#include <afina/Storage.h>
+#include <afina/execute/Add.h>
+#include <afina/execute/Decr.h>
+#include <afina/execute/Incr.h>
+#include <afina/execute/MetaArithmetic.h>
+
+#include <cstdint>
+
+namespace Afina {
+namespace Execute {
+
+// See MetaArithmetic.h
+void MetaArithmetic::Execute(Storage &storage, const std::string &args, std::string &out) {
+    if (!checkFlags("DMNJvkOq")) {
+        out.assign("CLIENT_ERROR invalid flag");
+        return;
+    }
+    uint64_t delta = 1, initial = 0;
+    int64_t vivify = 0;
+    if (!numberFlag('D', delta) || !numberFlag('J', initial) || !numberFlag('N', vivify) || vivify < INT32_MIN ||
+        vivify > INT32_MAX) {
+        out.assign("CLIENT_ERROR bad token in command line format");
+        return;
+    }
+    for (auto &token : _flags) {
+        if (token[0] == 'M' && (token.size() != 2 || std::string("IiDd+-").find(token[1]) == std::string::npos)) {
+            out.assign("CLIENT_ERROR invalid mode for ma");
+            return;
+        }
+    }
+
+    // Text commands do the job, missing item is created by add
+    std::string result;
+    for (;;) {
+        if (decrement()) {
+            Decr(_key, delta).Execute(storage, args, result);
+        } else {
+            Incr(_key, delta).Execute(storage, args, result);
+        }
+        if (result != "NOT_FOUND" || !hasFlag('N')) {
+            break;
+        }
+        std::string added;
+        Add(_key, 0, static_cast<int32_t>(vivify), _hash).Execute(storage, std::to_string(initial), added);
+        if (added == "STORED") {
+            result = std::to_string(initial);
+            break;
+        }
+        // Created by somebody else in between, count once again
+    }
+
+    if (result == "NOT_FOUND") {
+        out.assign("NF");
+        appendFlags(out);
+        return;
+    }
+    if (result.empty() || result[0] < '0' || result[0] > '9') {
+        // CLIENT_ERROR or SERVER_ERROR as is
+        out.assign(result);
+        return;
+    }
+    if (hasFlag('v')) {
+        // networking layer should add the last \r\n
+        out.assign("VA ").append(std::to_string(result.size()));
+        appendFlags(out);
+        out.append("\r\n").append(result);
+    } else if (hasFlag('q')) {
+        out.clear();
+    } else {
+        out.assign("HD");
+        appendFlags(out);
+    }
+}
+
+// See MetaArithmetic.h
+bool MetaArithmetic::decrement() const {
+    for (auto &token : _flags) {
+        if (token[0] == 'M') {
+            return token.size() == 2 && (token[1] == 'D' || token[1] == 'd' || token[1] == '-');
+        }
+    }
+    return false;
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -0,0 +1,117 @@
+#include <afina/execute/MetaCommand.h>
+
+#include <cstring>
+#include <ctime>
+#include <limits>
+
+namespace Afina {
+namespace Execute {
+
+// See MetaCommand.h
+bool MetaCommand::hasFlag(char flag) const {
+    for (auto &token : _flags) {
+        if (token[0] == flag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// See MetaCommand.h
+bool MetaCommand::numberFlag(char flag, int64_t &value) const {
+    for (auto &token : _flags) {
+        if (token[0] != flag) {
+            continue;
+        }
+        bool negative = token.size() > 1 && token[1] == '-';
+        uint64_t number;
+        // Magnitude of the smallest one is larger by one
+        uint64_t limit = uint64_t(std::numeric_limits<int64_t>::max()) + (negative ? 1 : 0);
+        std::size_t start = negative ? 2 : 1;
+        if (token.size() == start) {
+            return false;
+        }
+        number = 0;
+        for (std::size_t i = start; i < token.size(); ++i) {
+            if (token[i] < '0' || token[i] > '9') {
+                return false;
+            }
+            uint64_t digit = token[i] - '0';
+            if (number > (limit - digit) / 10) {
+                return false;
+            }
+            number = number * 10 + digit;
+        }
+        value = negative ? int64_t(0 - number) : int64_t(number);
+        return true;
+    }
+    return true;
+}
+
+// See MetaCommand.h
+bool MetaCommand::numberFlag(char flag, uint64_t &value) const {
+    for (auto &token : _flags) {
+        if (token[0] != flag) {
+            continue;
+        }
+        if (token.size() == 1) {
+            return false;
+        }
+        uint64_t number = 0;
+        for (std::size_t i = 1; i < token.size(); ++i) {
+            if (token[i] < '0' || token[i] > '9') {
+                return false;
+            }
+            uint64_t digit = token[i] - '0';
+            if (number > (std::numeric_limits<uint64_t>::max() - digit) / 10) {
+                return false;
+            }
+            number = number * 10 + digit;
+        }
+        value = number;
+        return true;
+    }
+    return true;
+}
+
+// See MetaCommand.h
+bool MetaCommand::checkFlags(const char *allowed) const {
+    for (auto &token : _flags) {
+        if (std::strchr(allowed, token[0]) == nullptr) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// See MetaCommand.h
+void MetaCommand::appendFlags(std::string &out, const ItemMeta *meta, std::size_t size) const {
+    for (auto &token : _flags) {
+        switch (token[0]) {
+        case 'O':
+            out.append(" ").append(token);
+            break;
+        case 'k':
+            out.append(" k").append(_key);
+            break;
+        default:
+            if (meta == nullptr) {
+                break;
+            }
+            if (token[0] == 'f') {
+                out.append(" f").append(std::to_string(meta->flags));
+            } else if (token[0] == 't') {
+                // Seconds left to live, -1 if item never expires
+                int64_t ttl = meta->expire == 0 ? -1 : int64_t(meta->expire) - std::time(nullptr);
+                out.append(" t").append(std::to_string(ttl < -1 ? -1 : ttl));
+            } else if (token[0] == 'c') {
+                out.append(" c").append(std::to_string(meta->cas));
+            } else if (token[0] == 's') {
+                out.append(" s").append(std::to_string(size));
+            }
+        }
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -0,0 +1,52 @@
+#include <afina/Storage.h>
+#include <afina/execute/Delete.h>
+#include <afina/execute/MetaDelete.h>
+
+namespace Afina {
+namespace Execute {
+
+// See MetaDelete.h
+void MetaDelete::Execute(Storage &storage, const std::string &args, std::string &out) {
+    if (!checkFlags("COkq")) {
+        out.assign("CLIENT_ERROR invalid flag");
+        return;
+    }
+    uint64_t cas = 0;
+    if (!numberFlag('C', cas)) {
+        out.assign("CLIENT_ERROR bad token in command line format");
+        return;
+    }
+
+    std::string result;
+    if (hasFlag('C')) {
+        // Version is checked under the storage lock, so the item written after it was taken survives
+        switch (storage.CompareAndDelete(_key, cas)) {
+        case CasResult::Stored:
+            result = "DELETED";
+            break;
+        case CasResult::Exists:
+            result = "EXISTS";
+            break;
+        default:
+            result = "NOT_FOUND";
+        }
+    } else {
+        Delete(_key).Execute(storage, args, result);
+    }
+
+    if (result == "DELETED") {
+        if (hasFlag('q')) {
+            out.clear();
+            return;
+        }
+        out.assign("HD");
+    } else if (result == "EXISTS") {
+        out.assign("EX");
+    } else {
+        out.assign("NF");
+    }
+    appendFlags(out);
+}
+
+} // namespace Execute
+} // namespace Afina
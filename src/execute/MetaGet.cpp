@@ -0,0 +1,54 @@
+#include <afina/Storage.h>
+#include <afina/execute/MetaGet.h>
+
+namespace Afina {
+namespace Execute {
+
+// See MetaGet.h
+void MetaGet::Execute(Storage &storage, const std::string &args, std::string &out) {
+    std::vector<Value> chunks;
+    Execute(storage, args, chunks);
+
+    out.clear();
+    for (auto &chunk : chunks) {
+        out.append(chunk.data(), chunk.size());
+    }
+}
+
+// See MetaGet.h
+void MetaGet::Execute(Storage &storage, const std::string &args, std::vector<Value> &out) {
+    if (!checkFlags("vftcskOq")) {
+        out.push_back(Value::Copy(std::string("CLIENT_ERROR invalid flag")));
+        return;
+    }
+
+    Value value;
+    ItemMeta meta;
+    bool found = storage.Get(_key, value, meta);
+    Metrics::ThreadCounters &counters = Metrics::Local();
+    (found ? counters.get_hits : counters.get_misses).Add(1);
+
+    if (!found) {
+        if (!hasFlag('q')) {
+            out.push_back(Value::Static("EN", 2));
+        }
+        return;
+    }
+
+    // networking layer should add the last \r\n
+    std::string text;
+    if (hasFlag('v')) {
+        text.append("VA ").append(std::to_string(value.size()));
+        appendFlags(text, &meta, value.size());
+        text.append("\r\n");
+        out.push_back(Value::Copy(text));
+        out.push_back(std::move(value));
+    } else {
+        text.append("HD");
+        appendFlags(text, &meta, value.size());
+        out.push_back(Value::Copy(text));
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
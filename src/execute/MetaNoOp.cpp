@@ -0,0 +1,10 @@
+#include <afina/execute/MetaNoOp.h>
+
+namespace Afina {
+namespace Execute {
+
+// See MetaNoOp.h
+void MetaNoOp::Execute(Storage &storage, const std::string &args, std::string &out) { out.assign("MN"); }
+
+} // namespace Execute
+} // namespace Afina
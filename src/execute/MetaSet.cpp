@@ -0,0 +1,107 @@
+#include <afina/Storage.h>
+#include <afina/execute/Add.h>
+#include <afina/execute/Append.h>
+#include <afina/execute/Cas.h>
+#include <afina/execute/MetaSet.h>
+#include <afina/execute/Prepend.h>
+#include <afina/execute/Replace.h>
+#include <afina/execute/Set.h>
+
+#include <cctype>
+#include <cstdint>
+#include <memory>
+
+namespace Afina {
+namespace Execute {
+
+// See MetaSet.h
+void MetaSet::Execute(Storage &storage, const std::string &args, std::string &out) {
+    if (!checkFlags("TFCMqOk")) {
+        out.assign("CLIENT_ERROR invalid flag");
+        return;
+    }
+    int64_t expire = 0;
+    uint64_t flags = 0, cas = 0;
+    if (!numberFlag('T', expire) || expire < INT32_MIN || expire > INT32_MAX || !numberFlag('F', flags) ||
+        flags > UINT32_MAX || !numberFlag('C', cas) || (hasFlag('C') && mode() != 'S')) {
+        out.assign("CLIENT_ERROR bad token in command line format");
+        return;
+    }
+
+    // Text command does the job, see InsertCommand
+    int32_t ttl = static_cast<int32_t>(expire);
+    std::unique_ptr<Command> command;
+    switch (mode()) {
+    case 'S':
+        if (hasFlag('C')) {
+            command.reset(new Cas(_key, flags, ttl, cas));
+        } else {
+            command.reset(new Set(_key, flags, ttl, _hash));
+        }
+        break;
+    case 'E':
+        command.reset(new Add(_key, flags, ttl, _hash));
+        break;
+    case 'A':
+        command.reset(new Append(_key, flags, ttl));
+        break;
+    case 'P':
+        command.reset(new Prepend(_key, flags, ttl));
+        break;
+    case 'R':
+        command.reset(new Replace(_key, flags, ttl));
+        break;
+    default:
+        out.assign("CLIENT_ERROR invalid mode for ms");
+        return;
+    }
+
+    std::string result;
+    command->Execute(storage, args, result);
+    if (result == "STORED") {
+        if (hasFlag('q')) {
+            out.clear();
+            return;
+        }
+        out.assign("HD");
+    } else if (result == "NOT_STORED") {
+        out.assign("NS");
+    } else if (result == "EXISTS") {
+        out.assign("EX");
+    } else if (result == "NOT_FOUND") {
+        out.assign("NF");
+    } else {
+        out.assign(result);
+        return;
+    }
+    appendFlags(out);
+}
+
+// See MetaSet.h
+Metrics::CommandType MetaSet::Type() const {
+    switch (mode()) {
+    case 'E':
+        return Metrics::CommandType::Add;
+    case 'A':
+        return Metrics::CommandType::Append;
+    case 'P':
+        return Metrics::CommandType::Prepend;
+    case 'R':
+        return Metrics::CommandType::Replace;
+    default:
+        return hasFlag('C') ? Metrics::CommandType::Cas : Metrics::CommandType::Set;
+    }
+}
+
+// See MetaSet.h
+char MetaSet::mode() const {
+    for (auto &token : _flags) {
+        if (token[0] == 'M') {
+            return token.size() == 2 ? std::toupper(token[1]) : 0;
+        }
+    }
+    return 'S';
+}
+
+} // namespace Execute
+} // namespace Afina
@@ -0,0 +1,144 @@
+#include <afina/execute/Metrics.h>
+
+#include <ctime>
+
+namespace Afina {
+namespace Execute {
+
+namespace {
+
+// Percentiles reported for each command type, in thousandths
+const std::pair<const char *, uint64_t> Percentiles[] = {
+    {"p50_ns", 500}, {"p90_ns", 900}, {"p99_ns", 990}, {"p999_ns", 999}};
+
+// Largest value of the bucket, so that reported percentile is never below the real one
+uint64_t upperBound(std::size_t bucket) {
+    if (bucket + 1 == Metrics::Histogram::BucketsCount) {
+        return UINT64_MAX;
+    }
+    return Metrics::Histogram::LowerBound(bucket + 1) - 1;
+}
+
+} // namespace
+
+const std::size_t Metrics::CommandTypesCount;
+const unsigned Metrics::Histogram::SubBits;
+const std::size_t Metrics::Histogram::BucketsCount;
+
+Metrics::Metrics() : _started(std::time(nullptr)) {}
+
+// See Metrics.h
+const char *Metrics::NameOf(CommandType type) {
+    switch (type) {
+    case CommandType::Get:
+        return "get";
+    case CommandType::Set:
+        return "set";
+    case CommandType::Add:
+        return "add";
+    case CommandType::Replace:
+        return "replace";
+    case CommandType::Append:
+        return "append";
+    case CommandType::Prepend:
+        return "prepend";
+    case CommandType::Cas:
+        return "cas";
+    case CommandType::Incr:
+        return "incr";
+    case CommandType::Decr:
+        return "decr";
+    case CommandType::Delete:
+        return "delete";
+    case CommandType::Stats:
+        return "stats";
+    default:
+        return "other";
+    }
+}
+
+// See Metrics.h
+void Metrics::Collect(std::vector<std::pair<std::string, uint64_t>> &stats) {
+    Metrics &metrics = instance();
+
+    ThreadCounters total;
+    std::vector<std::pair<std::string, uint64_t>> threads;
+    std::vector<std::vector<uint64_t>> latency(CommandTypesCount, std::vector<uint64_t>(Histogram::BucketsCount));
+    std::size_t n = 0;
+    metrics._threads.ForEach([&](const ThreadCounters &local) {
+        std::string prefix = "thread:" + std::to_string(n++) + ":";
+        uint64_t commands = 0;
+        for (std::size_t i = 0; i < CommandTypesCount; ++i) {
+            uint64_t count = local.commands[i].Load();
+            commands += count;
+            total.commands[i].Add(count);
+            for (std::size_t b = 0; b < Histogram::BucketsCount; ++b) {
+                latency[i][b] += local.latency[i].Bucket(b);
+            }
+        }
+        total.get_hits.Add(local.get_hits.Load());
+        total.get_misses.Add(local.get_misses.Load());
+        total.connections_opened.Add(local.connections_opened.Load());
+        total.connections_closed.Add(local.connections_closed.Load());
+
+        threads.emplace_back(prefix + "commands", commands);
+        threads.emplace_back(prefix + "get_hits", local.get_hits.Load());
+        threads.emplace_back(prefix + "get_misses", local.get_misses.Load());
+        threads.emplace_back(prefix + "connections", local.connections_opened.Load());
+    });
+
+    uint64_t now = std::time(nullptr);
+    uint64_t opened = total.connections_opened.Load();
+    uint64_t closed = total.connections_closed.Load();
+    uint64_t cmd_set = 0;
+    for (CommandType type : {CommandType::Set, CommandType::Add, CommandType::Replace, CommandType::Append,
+                             CommandType::Prepend, CommandType::Cas}) {
+        cmd_set += total.commands[static_cast<std::size_t>(type)].Load();
+    }
+    stats.emplace_back("uptime", now - metrics._started);
+    stats.emplace_back("time", now);
+    stats.emplace_back("curr_connections", opened > closed ? opened - closed : 0);
+    stats.emplace_back("total_connections", opened);
+    stats.emplace_back("cmd_get", total.get_hits.Load() + total.get_misses.Load());
+    stats.emplace_back("cmd_set", cmd_set);
+    stats.emplace_back("get_hits", total.get_hits.Load());
+    stats.emplace_back("get_misses", total.get_misses.Load());
+    stats.insert(stats.end(), threads.begin(), threads.end());
+
+    for (std::size_t i = 0; i < CommandTypesCount; ++i) {
+        uint64_t count = total.commands[i].Load();
+        if (count == 0) {
+            continue;
+        }
+        std::string prefix = std::string("latency:") + NameOf(static_cast<CommandType>(i)) + ":";
+        stats.emplace_back(prefix + "count", count);
+
+        // Command could be counted by one thread before its latency is visible, so percentiles are taken
+        // from the histogram alone
+        uint64_t recorded = 0;
+        std::size_t max_bucket = 0;
+        for (std::size_t b = 0; b < Histogram::BucketsCount; ++b) {
+            recorded += latency[i][b];
+            if (latency[i][b] != 0) {
+                max_bucket = b;
+            }
+        }
+        for (auto &percentile : Percentiles) {
+            // Rank of the percentile, rounded up
+            uint64_t rank = (recorded * percentile.second + 999) / 1000;
+            uint64_t seen = 0;
+            std::size_t b = 0;
+            for (; b < max_bucket; ++b) {
+                seen += latency[i][b];
+                if (seen >= rank) {
+                    break;
+                }
+            }
+            stats.emplace_back(prefix + percentile.first, upperBound(b));
+        }
+        stats.emplace_back(prefix + "max_ns", upperBound(max_bucket));
+    }
+}
+
+} // namespace Execute
+} // namespace Afina
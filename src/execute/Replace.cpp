@@ -12,8 +12,13 @@ namespace Execute {
 void Replace::Execute(Storage &storage, const std::string &args, std::string &out) {
     std::cout << "Replace(" << _key << "): " << args << std::endl;
     std::string value;
+    uint32_t expire;
     if (storage.Get(_key, value)) {
-        storage.Set(_key, args);
+        if (expireTime(expire)) {
+            storage.Set(_key, args, ItemMeta(_flags, expire));
+        } else {
+            storage.Delete(_key);
+        }
         out = "STORED";
     } else {
         out = "NOT_STORED";
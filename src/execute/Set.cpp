@@ -9,7 +9,13 @@ namespace Execute {
 // memcached protocol: "set" means "store this data".
 void Set::Execute(Storage &storage, const std::string &args, std::string &out) {
     std::cout << "Set(" << _key << "): " << args << std::endl;
-    storage.Put(_key, args);
+    uint32_t expire;
+    if (!expireTime(expire)) {
+        // Item is stored and expires at once
+        storage.Delete(_key);
+    } else {
+        storage.Put(_key, _hash, args, ItemMeta(_flags, expire));
+    }
     out = "STORED";
 }
 
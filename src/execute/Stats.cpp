@@ -1,4 +1,5 @@
 #include <afina/Storage.h>
+#include <afina/execute/Metrics.h>
 #include <afina/execute/Stats.h>
 
 #include <iostream>
@@ -8,7 +9,21 @@
 namespace Afina {
 namespace Execute {
 
-void Stats::Execute(Storage &storage, const std::string &args, std::string &out) { out.assign("END"); }
+// memcached stats: STAT line for each counter of the server, then for each counter of the storage
+void Stats::Execute(Storage &storage, const std::string &args, std::string &out) {
+    std::vector<std::pair<std::string, uint64_t>> stats;
+    Metrics::Collect(stats);
+    std::map<std::string, uint64_t> storage_stats;
+    storage.CollectStats(storage_stats);
+    stats.insert(stats.end(), storage_stats.begin(), storage_stats.end());
+
+    std::stringstream result;
+    for (auto &stat : stats) {
+        result << "STAT " << stat.first << " " << stat.second << "\r\n";
+    }
+    result << "END";
+    out = result.str();
+}
 
 } // namespace Execute
 } // namespace Afina
@@ -21,6 +21,8 @@
 #include "network/st_coroutine/ServerImpl.h"
 #include "network/st_nonblocking/ServerImpl.h"
 
+#include "storage/CompactLRU.h"
+#include "storage/ShardedLRU.h"
 #include "storage/SimpleLRU.h"
 #include "storage/ThreadSafeSimpleLRU.h"
 #include "storage/StripedLockLRU.h"
@@ -52,12 +54,53 @@ public:
             storage_type = options["storage"].as<std::string>();
         }
 
+        using IndexType = Afina::Backend::SimpleLRU::IndexType;
+        IndexType index_type = IndexType::Map;
+        if (options.count("index") > 0) {
+            std::string index = options["index"].as<std::string>();
+            if (index == "hash") {
+                index_type = IndexType::Hash;
+            } else if (index != "map") {
+                throw std::runtime_error("Unknown index type");
+            }
+        }
+
+        // Striped storages only: evict in background thread instead of writers
+        bool background_eviction = options.count("background-eviction") > 0;
+
+        using EvictionPolicy = Afina::Backend::SimpleLRU::EvictionPolicy;
         if (storage_type == "st_lru") {
-            storage = std::make_shared<Afina::Backend::SimpleLRU>();
+            storage = std::make_shared<Afina::Backend::SimpleLRU>(1024, index_type);
         } else if (storage_type == "mt_lru") {
-            storage = std::make_shared<Afina::Backend::ThreadSafeSimplLRU>();
+            storage = std::make_shared<Afina::Backend::ThreadSafeSimplLRU>(1024, index_type);
         } else if (storage_type == "mt_stl_lru") {
-            storage = std::make_shared<Afina::Backend::StripedLockLRU>();
+            storage = std::make_shared<Afina::Backend::StripedLockLRU>(1024 * 1024 * 8, 4, index_type,
+                                                                       EvictionPolicy::LRU, false,
+                                                                       background_eviction);
+        } else if (storage_type == "st_clock") {
+            storage = std::make_shared<Afina::Backend::SimpleLRU>(1024, index_type, EvictionPolicy::Clock);
+        } else if (storage_type == "mt_clock") {
+            storage = std::make_shared<Afina::Backend::ThreadSafeSimplLRU>(1024, index_type, EvictionPolicy::Clock);
+        } else if (storage_type == "mt_stl_clock") {
+            storage = std::make_shared<Afina::Backend::StripedLockLRU>(1024 * 1024 * 8, 4, index_type,
+                                                                       EvictionPolicy::Clock, false,
+                                                                       background_eviction);
+        } else if (storage_type == "st_tlfu") {
+            storage = std::make_shared<Afina::Backend::SimpleLRU>(1024, index_type, EvictionPolicy::TinyLFU);
+        } else if (storage_type == "mt_tlfu") {
+            storage = std::make_shared<Afina::Backend::ThreadSafeSimplLRU>(1024, index_type, EvictionPolicy::TinyLFU);
+        } else if (storage_type == "mt_stl_tlfu") {
+            storage = std::make_shared<Afina::Backend::StripedLockLRU>(1024 * 1024 * 8, 4, index_type,
+                                                                       EvictionPolicy::TinyLFU, false,
+                                                                       background_eviction);
+        } else if (storage_type == "mt_stl_lockfree") {
+            storage = std::make_shared<Afina::Backend::StripedLockLRU>(1024 * 1024 * 8, 4, index_type,
+                                                                       EvictionPolicy::Clock, true,
+                                                                       background_eviction);
+        } else if (storage_type == "shard_lru") {
+            storage = std::make_shared<Afina::Backend::ShardedLRU>(1024 * 1024 * 8, 4, index_type);
+        } else if (storage_type == "st_compact_lru") {
+            storage = std::make_shared<Afina::Backend::CompactLRU>(1024 * 1024 * 8);
         } else {
             throw std::runtime_error("Unknown storage type");
         }
@@ -68,6 +111,11 @@ public:
             network_type = options["network"].as<std::string>();
         }
 
+        // Shards have no locks, only a network that pins them to threads could use them
+        if (std::dynamic_pointer_cast<Afina::ShardedStorage>(storage) && network_type != "mt_nonblock") {
+            throw std::runtime_error("Storage shard_lru requires mt_nonblock network");
+        }
+
         if (network_type == "st_block") {
             server = std::make_shared<Afina::Network::STblocking::ServerImpl>(storage, logService);
         } else if (network_type == "mt_block") {
@@ -134,7 +182,9 @@ int main(int argc, char **argv) {
         // TODO: use custom cxxopts::value to print options possible values in help message
         // and simplify validation below
         options.add_options()("s,storage", "Type of storage service to use", cxxopts::value<std::string>());
+        options.add_options()("i,index", "Type of storage index to use: map or hash", cxxopts::value<std::string>());
         options.add_options()("n,network", "Type of network service to use", cxxopts::value<std::string>());
+        options.add_options()("b,background-eviction", "Striped storages evict items in background thread");
         options.add_options()("h,help", "Print usage info");
         options.parse(argc, argv);
 
@@ -159,6 +159,8 @@ void ServerImpl::Worker(int client_socket){
     Protocol::Parser parser;
     std::string argument_for_command;
     std::unique_ptr<Execute::Command> command_to_execute;
+    Execute::Metrics::ThreadCounters &counters = Execute::Metrics::Local();
+    counters.connections_opened.Add(1);
     try {
         int readed_bytes = -1;
         char client_buffer[4096] = "";
@@ -214,12 +216,17 @@ void ServerImpl::Worker(int client_socket){
                     if (argument_for_command.size()) {
                         argument_for_command.resize(argument_for_command.size() - 2);
                     }
-                    command_to_execute->Execute(*pStorage, argument_for_command, result);
+                    {
+                        Execute::Metrics::Timer timer(command_to_execute->Type());
+                        command_to_execute->Execute(*pStorage, argument_for_command, result);
+                    }
 
-                    // Send response
-                    result += "\r\n";
-                    if (send(client_socket, result.data(), result.size(), 0) <= 0) {
-                        throw std::runtime_error("Failed to send response");
+                    // Send response, quiet commands might have nothing to say, noreply ones aren't listened to
+                    if (!result.empty() && !command_to_execute->NoReply()) {
+                        result += "\r\n";
+                        if (send(client_socket, result.data(), result.size(), 0) <= 0) {
+                            throw std::runtime_error("Failed to send response");
+                        }
                     }
 
                     // Prepare for the next command
@@ -239,6 +246,7 @@ void ServerImpl::Worker(int client_socket){
         _logger->error("Failed to process connection on descriptor {}: {}", client_socket, ex.what());
     }
 
+    counters.connections_closed.Add(1);
     std::unique_lock<std::mutex> lock(_m);
     close(client_socket);
     _current_client_sockets.erase(client_socket);
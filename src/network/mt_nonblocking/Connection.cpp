@@ -1,4 +1,8 @@
 #include "Connection.h"
+#include "Worker.h"
+
+#include <algorithm>
+#include <climits>
 
 #include <unistd.h>
 #include <sys/uio.h>
@@ -32,75 +36,14 @@ void Connection::DoRead() {
     
     try {
         int readed_bytes = -1;
-        while ((readed_bytes = read(_socket, _read_buffer + _buff_offset, sizeof(_read_buffer) - _buff_offset)) > 0) {
+        while (!_waiting && (readed_bytes = read(_socket, _read_buffer + _buff_offset, sizeof(_read_buffer) - _buff_offset)) > 0) {
             _pLogger->debug("Got {} bytes from socket", readed_bytes);
             _buff_offset += readed_bytes;
-            // Single block of data readed from the socket could trigger inside actions a multiple times,
-            // for example:
-            // - read#0: [<command1 start>]
-            // - read#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
-            while (_buff_offset > 0) {
-                _pLogger->debug("Process {} bytes", _buff_offset);
-                // There is no command yet
-                if (!command_to_execute) {
-                    std::size_t parsed = 0;
-                    if (parser.Parse(_read_buffer, _buff_offset, parsed)) {
-                        // There is no command to be launched, continue to parse input stream
-                        // Here we are, current chunk finished some command, process it
-                        _pLogger->debug("Found new command: {} in {} bytes", parser.Name(), parsed);
-                        command_to_execute = parser.Build(_arg_remains);
-                        if (_arg_remains > 0) {
-                            _arg_remains += 2;
-                        }
-                    }
-
-                    // Parsed might fail to consume any bytes from input stream. In real life that could happen,
-                    // for example, because we are working with UTF-16 chars and only 1 byte left in stream
-                    if (parsed == 0) {
-                        break;
-                    } else {
-                        std::memmove(_read_buffer, _read_buffer + parsed, _buff_offset - parsed);
-                        _buff_offset -= parsed;
-                    }
-                }
-
-                // There is command, but we still wait for argument to arrive...
-                if (command_to_execute && _arg_remains > 0) {
-                    _pLogger->debug("Fill argument: {} bytes of {}", _buff_offset, _arg_remains);
-                    // There is some parsed command, and now we are reading argument
-                    std::size_t to_read = std::min(_arg_remains, std::size_t(_buff_offset));
-                    argument_for_command.append(_read_buffer, to_read);
-
-                    std::memmove(_read_buffer, _read_buffer + to_read, _buff_offset - to_read);
-                    _arg_remains -= to_read;
-                    _buff_offset -= to_read;
-                }
-
-                // There is command & argument - RUN!
-                if (command_to_execute && _arg_remains == 0) {
-                    _pLogger->debug("Start command execution");
-
-                    std::string result;
-                    if (argument_for_command.size()) {
-                        argument_for_command.resize(argument_for_command.size() - 2);
-                    }
-                    command_to_execute->Execute(*_pStorage, argument_for_command, result);
-
-                    result += "\r\n";
-                    output.push_back(std::move(result));
-                    _event.events |= EPOLLOUT;
-                    if (output.size() >= MAX_OUTPUT_QUEUE_SIZE){
-                        _event.events &= ~EPOLLIN;
-                    }
-
-                    // Prepare for the next command
-                    command_to_execute.reset();
-                    argument_for_command.resize(0);
-                    parser.Reset();
-                }
-            } // while (readed_bytes)
+            process();
         }
-        if (readed_bytes == 0) {
+        if (_waiting) {
+            // Rest of the input stays in the socket until command is done, see Resume
+        } else if (readed_bytes == 0) {
             _pLogger->debug("Client closed connection on socket {}", _socket);
             _eof.store(true, std::memory_order::memory_order_relaxed);
         } else if (errno != EAGAIN){
@@ -120,32 +63,41 @@ void Connection::DoWrite() {
         return;
     }
     _pLogger->debug("Connection writing on socket {}", _socket);
+    if (output.empty()){
+        _event.events &= ~EPOLLOUT;
+        return;
+    }
 
-    iovec out_v[output.size()];
-    for (std::size_t i = 0; i < output.size(); ++i){
-        out_v[i].iov_base = &(output[i][0]);
+    // Values are written straight from the storage memory
+    std::size_t n_chunks = std::min<std::size_t>(output.size(), IOV_MAX);
+    iovec out_v[n_chunks];
+    for (std::size_t i = 0; i < n_chunks; ++i){
+        out_v[i].iov_base = const_cast<char *>(output[i].data());
         out_v[i].iov_len = output[i].size();
     }
     out_v[0].iov_base = static_cast<char*>(out_v[0].iov_base) + _head_offset;
     out_v[0].iov_len -= _head_offset;
 
-    int ret = writev(_socket, out_v, output.size());
-
-    if (-1 == ret && errno != EAGAIN){
-        _is_alive.store(false, std::memory_order::memory_order_release);
-        _pLogger->debug("Failed to write to socket {}", _socket);
+    ssize_t ret = writev(_socket, out_v, n_chunks);
+    if (-1 == ret){
+        if (errno != EAGAIN){
+            _is_alive.store(false, std::memory_order::memory_order_release);
+            _pLogger->debug("Failed to write to socket {}", _socket);
+        }
         return;
     }
 
+    // Drop chunks that were sent completely, remember how much of the next one is gone already
+    std::size_t written = _head_offset + ret;
     std::size_t i = 0;
-    while (ret >= output[i].size() && i < output.size()){
-        ret -= output[i].size();
+    while (i < output.size() && written >= output[i].size()){
+        written -= output[i].size();
         ++i;
     }
-    _head_offset = ret;
+    _head_offset = written;
     output.erase(output.begin(), output.begin() + i);
 
-    if (output.size() < MAX_OUTPUT_QUEUE_SIZE){
+    if (output.size() < MAX_OUTPUT_QUEUE_SIZE && !_waiting){
         _event.events |= EPOLLIN;
     }
     if (output.empty()){
@@ -157,6 +109,117 @@ void Connection::DoWrite() {
     std::atomic_thread_fence(std::memory_order::memory_order_release);
 }
 
+// See Connection.h
+void Connection::Resume() {
+    _waiting = false;
+    _event.events |= EPOLLIN;
+    try {
+        finishCommand();
+        process();
+    } catch (std::runtime_error &ex) {
+        _pLogger->error("Failed to process connection on descriptor {}: {}", _socket, ex.what());
+        _is_alive.store(false, std::memory_order::memory_order_relaxed);
+    }
+}
+
+// See Connection.h
+void Connection::process() {
+    // Single block of data readed from the socket could trigger inside actions a multiple times,
+    // for example:
+    // - read#0: [<command1 start>]
+    // - read#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
+    //
+    // Consumed bytes are dropped from the buffer only once all of it is processed: until then keys of the
+    // current command are views into the buffer, see Protocol::Parser
+    while (_buff_start < _buff_offset) {
+        _pLogger->debug("Process {} bytes", _buff_offset - _buff_start);
+        // There is no command yet
+        if (!command_to_execute) {
+            if (!parser) {
+                parser = Protocol::Frontend::Create(_read_buffer[_buff_start], true);
+            }
+            std::size_t parsed = 0;
+            if (parser->Parse(_read_buffer + _buff_start, _buff_offset - _buff_start, parsed)) {
+                // There is no command to be launched, continue to parse input stream
+                // Here we are, current chunk finished some command, process it
+                _pLogger->debug("Found new command: {} in {} bytes", parser->Name(), parsed);
+                command_to_execute = parser->Build(_arg_remains);
+                if (_arg_remains > 0) {
+                    _arg_remains += parser->BodyTrailer();
+                }
+            }
+
+            // Parsed might fail to consume any bytes from input stream. In real life that could happen,
+            // for example, because we are working with UTF-16 chars and only 1 byte left in stream
+            if (parsed == 0) {
+                break;
+            } else {
+                _buff_start += parsed;
+            }
+        }
+
+        // There is command, but we still wait for argument to arrive...
+        if (command_to_execute && _arg_remains > 0) {
+            _pLogger->debug("Fill argument: {} bytes of {}", _buff_offset - _buff_start, _arg_remains);
+            // There is some parsed command, and now we are reading argument
+            std::size_t to_read = std::min(_arg_remains, std::size_t(_buff_offset - _buff_start));
+            argument_for_command.append(_read_buffer + _buff_start, to_read);
+
+            _arg_remains -= to_read;
+            _buff_start += to_read;
+        }
+
+        // There is command & argument - RUN!
+        if (command_to_execute && _arg_remains == 0) {
+            _pLogger->debug("Start command execution");
+
+            if (argument_for_command.size()) {
+                argument_for_command.resize(argument_for_command.size() - parser->BodyTrailer());
+            }
+            _command_start = Execute::Metrics::Now();
+            _responded = false;
+            if (_worker != nullptr && _worker->Forward(*this)) {
+                // Response comes later, see Resume
+                _waiting = true;
+                _event.events &= ~EPOLLIN;
+                return;
+            }
+            std::size_t chunks = output.size();
+            command_to_execute->Execute(*_pStorage, argument_for_command, output);
+            if (command_to_execute->NoReply()) {
+                output.resize(chunks);
+            }
+            _responded = output.size() != chunks;
+            finishCommand();
+        }
+    }
+
+    std::memmove(_read_buffer, _read_buffer + _buff_start, _buff_offset - _buff_start);
+    _buff_offset -= _buff_start;
+    _buff_start = 0;
+}
+
+// See Connection.h
+void Connection::finishCommand() {
+    Execute::Metrics::CommandDone(command_to_execute->Type(), _command_start);
+    // Quiet commands might have nothing to say, then there is nothing to write either
+    StringView trailer = parser->ResponseTrailer();
+    if (_responded && !trailer.empty()) {
+        output.push_back(Afina::Value::Static(trailer.data(), trailer.size()));
+    }
+    if (!output.empty()) {
+        _event.events |= EPOLLOUT;
+    }
+    if (output.size() >= MAX_OUTPUT_QUEUE_SIZE){
+        _event.events &= ~EPOLLIN;
+    }
+
+    // Prepare for the next command
+    command_to_execute.reset();
+    argument_for_command.resize(0);
+    parser->Reset();
+}
+
 } // namespace MTnonblock
 } // namespace Network
 } // namespace Afina
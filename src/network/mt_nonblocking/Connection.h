@@ -5,7 +5,9 @@
 #include <string>
 #include <vector>
 #include <sys/epoll.h>
-#include "protocol/Parser.h"
+#include "protocol/Frontend.h"
+#include <afina/Storage.h>
+#include <afina/Value.h>
 #include <afina/execute/Command.h>
 #include <spdlog/logger.h>
 #include <mutex>
@@ -17,21 +19,31 @@ namespace Afina {
 namespace Network {
 namespace MTnonblock {
 
+// Forward declaration, see Worker.h
+class Worker;
+
 class Connection {
 public:
-    Connection(int s, std::shared_ptr<Afina::Storage>& ps, std::shared_ptr<spdlog::logger>& pl)
-     : _socket(s), _pStorage(ps), _pLogger(pl) {
+    // Worker is set only if storage is sharded between workers, it is the one that owns the connection
+    Connection(int s, std::shared_ptr<Afina::Storage>& ps, std::shared_ptr<spdlog::logger>& pl, Worker *worker = nullptr)
+     : _socket(s), _pStorage(ps), _pLogger(pl), _worker(worker), _waiting(false), _pending(0),
+       _command_start(0), _responded(false) {
         std::unique_lock<std::mutex> lock(_mutex);
         std::memset(&_event, 0, sizeof(struct epoll_event));
         _event.data.ptr = this;
         _is_alive.store(true, std::memory_order::memory_order_relaxed);
         _arg_remains = 0;
         _buff_offset = 0;
+        _buff_start = 0;
         _head_offset = 0;
         _eof.store(false, std::memory_order::memory_order_release);
         std::memset(_read_buffer, 0, 4096);
+        Execute::Metrics::Local().connections_opened.Add(1);
     }
 
+    // Could be destroyed by any thread, counters of opened and closed connections are merged anyway
+    ~Connection() { Execute::Metrics::Local().connections_closed.Add(1); }
+
     inline bool isAlive() const {
         return _is_alive.load(std::memory_order_acquire);
     }
@@ -44,6 +56,11 @@ protected:
     void DoRead();
     void DoWrite();
 
+    /**
+     * Completes command that was waiting for other workers and continues with the rest of the input
+     */
+    void Resume();
+
 private:
     friend class ServerImpl;
     friend class Worker;
@@ -52,19 +69,43 @@ private:
     std::atomic<bool> _is_alive;
     std::atomic<bool> _eof;
     struct epoll_event _event;
-    std::vector<std::string> output;
+    // Response chunks waiting to be written, might point directly to the storage memory
+    std::vector<Afina::Value> output;
+    // Number of bytes of the first chunk that were written already
     std::size_t _head_offset;
 
     std::shared_ptr<Afina::Storage> _pStorage;
     std::shared_ptr<spdlog::logger> _pLogger;
     char _read_buffer[4096];
     int _buff_offset;
+    // Bytes before it are processed already, see process
+    int _buff_start;
 
     std::size_t _arg_remains;
-    Protocol::Parser parser;
+    // Protocol is chosen by the first byte of the connection, see Protocol::Frontend::Create
+    std::unique_ptr<Protocol::Frontend> parser;
     std::string argument_for_command;
     std::unique_ptr<Execute::Command> command_to_execute;
     std::mutex _mutex;
+
+    // Shard-per-thread mode, see Worker::Forward
+    Worker *_worker;
+    // Current command is executed by other workers, input isn't processed until it is done
+    bool _waiting;
+    // Number of tasks sent to other workers that haven't come back yet
+    std::size_t _pending;
+    // Lookups of the multi-key get collected from the owners of its keys
+    std::vector<LookupResult> _results;
+    // When current command has started, Metrics::Now. Forwarded command is measured till the response is back
+    uint64_t _command_start;
+    // Current command has added something to the output, see finishCommand
+    bool _responded;
+
+    // Runs commands from the read buffer until it is over or some command has to wait for other workers
+    void process();
+
+    // Sends response of the current command and prepares for the next one
+    void finishCommand();
 };
 
 } // namespace MTnonblock
@@ -18,6 +18,7 @@
 
 #include <spdlog/logger.h>
 
+#include <afina/ShardedStorage.h>
 #include <afina/Storage.h>
 #include <afina/logging/Service.h>
 
@@ -30,7 +31,8 @@ namespace Network {
 namespace MTnonblock {
 
 // See Server.h
-ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl) : Server(ps, pl) {}
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl)
+    : Server(ps, pl), _sharded(nullptr), _next_worker(0) {}
 
 // See Server.h
 ServerImpl::~ServerImpl() {
@@ -102,10 +104,34 @@ void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers)
         throw std::runtime_error("Failed to add eventfd descriptor to epoll");
     }
 
+    _sharded = dynamic_cast<ShardedStorage *>(pStorage.get());
+    if (_sharded != nullptr) {
+        _logger->info("Storage is sharded, each worker owns its shards");
+        for (int i = 0; i < n_workers; i++) {
+            int epoll_fd = epoll_create1(0);
+            if (epoll_fd == -1) {
+                throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
+            }
+            _worker_epolls.push_back(epoll_fd);
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, _event_fd, &event)) {
+                throw std::runtime_error("Failed to add eventfd descriptor to epoll");
+            }
+
+            int mailbox = eventfd(0, EFD_NONBLOCK);
+            if (mailbox == -1) {
+                throw std::runtime_error("Failed to create eventfd descriptor: " + std::string(strerror(errno)));
+            }
+            _mailboxes.push_back(mailbox);
+        }
+        for (int i = 0; i < n_workers * n_workers; i++) {
+            _queues.emplace_back(new Concurrency::SpscQueue<ShardTask *>());
+        }
+    }
+
     _workers.reserve(n_workers);
     for (int i = 0; i < n_workers; i++) {
-        _workers.emplace_back(pStorage, pLogging, this);
-        _workers.back().Start(_data_epoll_fd);
+        _workers.emplace_back(pStorage, pLogging, this, i);
+        _workers.back().Start(_sharded != nullptr ? _worker_epolls[i] : _data_epoll_fd);
     }
 
     // Start acceptors
@@ -149,6 +175,23 @@ void ServerImpl::Join() {
     }
     _workers.clear();
 
+    // Tasks in flight are dropped along with their connections
+    ShardTask *task;
+    for (auto &queue : _queues) {
+        while (queue->Pop(task)) {
+            ShardTask::Destroy(task);
+        }
+    }
+    _queues.clear();
+    for (int fd : _worker_epolls) {
+        close(fd);
+    }
+    _worker_epolls.clear();
+    for (int fd : _mailboxes) {
+        close(fd);
+    }
+    _mailboxes.clear();
+
     std::lock_guard<std::mutex> lock(_mutex);
     close(_server_socket);
     for (auto conn: _connections){
@@ -218,7 +261,15 @@ void ServerImpl::OnRun() {
                 }
 
                 // Register the new FD to be monitored by epoll.
-                Connection *pc = new Connection(infd, pStorage, _logger);
+                // In shard-per-thread mode connection is served by a single worker
+                int epoll_fd = _data_epoll_fd;
+                Worker *owner = nullptr;
+                if (_sharded != nullptr) {
+                    std::size_t w = _next_worker.fetch_add(1, std::memory_order_relaxed) % _workers.size();
+                    owner = &_workers[w];
+                    epoll_fd = _worker_epolls[w];
+                }
+                Connection *pc = new Connection(infd, pStorage, _logger, owner);
                 if (pc == nullptr) {
                     throw std::runtime_error("Failed to allocate connection");
                 }
@@ -228,7 +279,7 @@ void ServerImpl::OnRun() {
                 if (pc->isAlive()) {
                     pc->_event.events |= EPOLLONESHOT;
                     int epoll_ctl_retval;
-                    if ((epoll_ctl_retval = epoll_ctl(_data_epoll_fd, EPOLL_CTL_ADD, pc->_socket, &pc->_event))) {
+                    if ((epoll_ctl_retval = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pc->_socket, &pc->_event))) {
                         _logger->debug("epoll_ctl failed during connection register in workers'epoll: error {}", epoll_ctl_retval);
                         pc->OnError();
                         close(pc->_socket);
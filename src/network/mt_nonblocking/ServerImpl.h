@@ -1,11 +1,13 @@
 #ifndef AFINA_NETWORK_MT_NONBLOCKING_SERVER_H
 #define AFINA_NETWORK_MT_NONBLOCKING_SERVER_H
 
+#include <atomic>
 #include <thread>
 #include <vector>
 #include <set>
 #include <mutex>
 #include "Connection.h"
+#include <afina/concurrency/SpscQueue.h>
 #include <afina/network/Server.h>
 
 namespace spdlog {
@@ -13,15 +15,25 @@ class logger;
 }
 
 namespace Afina {
+
+// Forward declaration, see afina/ShardedStorage.h
+class ShardedStorage;
+
 namespace Network {
 namespace MTnonblock {
 
 // Forward declaration, see Worker.h
 class Worker;
+struct ShardTask;
 
 /**
  * # Network resource manager implementation
  * Epoll based server
+ *
+ * If storage is a ShardedStorage server runs in shard-per-thread mode: each worker has private epoll and
+ * owns a subset of shards, connections are spread over workers round robin. Command with keys of other
+ * worker is passed to it through SPSC queue and eventfd wakeup, response comes back the same way, see
+ * Worker::Forward
  */
 class ServerImpl : public Server {
 public:
@@ -68,6 +80,23 @@ private:
 
     std::set<Connection*> _connections;
     std::mutex _mutex;
+
+    // Shard-per-thread mode, null if all workers share the storage
+    ShardedStorage *_sharded;
+
+    // Private epoll instance and mailbox eventfd of each worker, shard-per-thread mode only
+    std::vector<int> _worker_epolls;
+    std::vector<int> _mailboxes;
+
+    // Tasks from worker i to worker j go to _queues[i * n_workers + j]
+    std::vector<std::unique_ptr<Concurrency::SpscQueue<ShardTask *>>> _queues;
+
+    // Worker to get next accepted connection
+    std::atomic<std::size_t> _next_worker;
+
+    inline Concurrency::SpscQueue<ShardTask *> &queue(std::size_t src, std::size_t dst) {
+        return *_queues[src * _mailboxes.size() + dst];
+    }
 };
 
 } // namespace MTnonblock
@@ -6,11 +6,14 @@
 
 #include <netdb.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 
 #include <spdlog/logger.h>
 
+#include <afina/ShardedStorage.h>
+#include <afina/execute/Get.h>
 #include <afina/logging/Service.h>
 #include "ServerImpl.h"
 
@@ -22,14 +25,17 @@ namespace Network {
 namespace MTnonblock {
 
 // See Worker.h
-Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl, ServerImpl* server)
-    : _pStorage(ps), _pLogging(pl), _server(server), isRunning(false), _epoll_fd(-1) {
-    // TODO: implementation here
-}
+Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl, ServerImpl* server,
+               std::size_t id)
+    : _pStorage(ps), _pLogging(pl), _server(server), isRunning(false), _epoll_fd(-1), _id(id) {}
 
 // See Worker.h
 Worker::~Worker() {
-    // TODO: implementation here
+    for (auto &backlog : _backlog) {
+        for (ShardTask *task : backlog) {
+            ShardTask::Destroy(task);
+        }
+    }
 }
 
 // See Worker.h
@@ -42,6 +48,10 @@ Worker &Worker::operator=(Worker &&other) {
     _logger = std::move(other._logger);
     _thread = std::move(other._thread);
     _epoll_fd = other._epoll_fd;
+    _server = other._server;
+    _id = other._id;
+    _backlog = std::move(other._backlog);
+    _signal = std::move(other._signal);
 
     other._epoll_fd = -1;
     return *this;
@@ -53,6 +63,17 @@ void Worker::Start(int epoll_fd) {
         assert(_epoll_fd == -1);
         _epoll_fd = epoll_fd;
         _logger = _pLogging->select("network.worker");
+        if (_server->_sharded != nullptr) {
+            // Worker itself marks mailbox events
+            struct epoll_event event;
+            event.events = EPOLLIN;
+            event.data.ptr = this;
+            if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _server->_mailboxes[_id], &event)) {
+                throw std::runtime_error("Failed to add mailbox descriptor to epoll");
+            }
+            _backlog.resize(_server->_mailboxes.size());
+            _signal.assign(_server->_mailboxes.size(), false);
+        }
         _thread = std::thread(&Worker::OnRun, this);
     }
 }
@@ -81,6 +102,9 @@ void Worker::OnRun() {
         int nmod = epoll_wait(_epoll_fd, &mod_list[0], mod_list.size(), timeout);
         _logger->debug("Worker wokeup: {} events", nmod);
 
+        // Mailbox is processed after connections: completed task could delete connection which has an event
+        // in the list
+        bool got_mail = false;
         for (int i = 0; i < nmod; i++) {
             struct epoll_event &current_event = mod_list[i];
 
@@ -90,6 +114,10 @@ void Worker::OnRun() {
             if (current_event.data.ptr == nullptr) {
                 continue;
             }
+            if (current_event.data.ptr == this) {
+                got_mail = true;
+                continue;
+            }
 
             // Some connection gets new data
             Connection *pconn = static_cast<Connection *>(current_event.data.ptr);
@@ -111,35 +139,227 @@ void Worker::OnRun() {
                 }
             }
 
-            // Rearm connection
+            // Rearm connection or delete closed one
             if (pconn->isAlive()) {
-                pconn->_event.events |= EPOLLONESHOT;
-                int epoll_ctl_retval;
-                if ((epoll_ctl_retval = epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, pconn->_socket, &pconn->_event))) {
-                    _logger->debug("epoll_ctl failed during connection rearm: error {}", epoll_ctl_retval);
-                    pconn->OnError();
-                    std::lock_guard<std::mutex> lock(_server->_mutex);
-                    _server->_connections.erase(pconn);
-                    close(pconn->_socket);
-                    delete pconn;
-                }
-            }
-            // Or delete closed one
-            else {
-                if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, pconn->_socket, &pconn->_event)) {
-                    std::cerr << "Failed to delete connection!" << std::endl;
-                }
-                std::lock_guard<std::mutex> lock(_server->_mutex);
-                _server->_connections.erase(pconn);
-                close(pconn->_socket);
-                delete pconn;
+                rearm(pconn);
+            } else {
+                closeConnection(pconn);
             }
         }
-        // TODO: Select timeout...
+
+        if (got_mail) {
+            drainMailbox();
+        }
+        // Queues are full, retry soon
+        if (_server->_sharded != nullptr) {
+            timeout = flushOutbox() ? 1 : -1;
+        }
     }
     _logger->warn("Worker stopped");
 }
 
+// See Worker.h
+bool Worker::Forward(Connection &conn) {
+    const Allocator::ArenaVector<StringView> &keys = conn.parser->Keys();
+    const Allocator::ArenaVector<std::size_t> &hashes = conn.parser->Hashes();
+    if (keys.empty()) {
+        return false;
+    }
+
+    Execute::Get *get = dynamic_cast<Execute::Get *>(conn.command_to_execute.get());
+    if (get == nullptr) {
+        std::size_t owner = ownerOf(hashes[0]);
+        if (owner == _id) {
+            return false;
+        }
+        ShardTask *task = ShardTask::Create(&conn, _id, conn.parser->CommandArena());
+        task->command = conn.command_to_execute.get();
+        task->args = &conn.argument_for_command;
+        conn._pending = 1;
+        send(owner, task);
+        return true;
+    }
+
+    // Multi-key get is split by owners, own keys are looked up right away. Scratch lists live as long as the
+    // command, so they are taken from its arena
+    Allocator::Arena &arena = conn.parser->CommandArena();
+    Allocator::StlAllocator<char, Allocator::Arena> alloc(&arena);
+    Allocator::ArenaVector<ShardTask *> parts(_backlog.size(), nullptr, alloc);
+    Allocator::ArenaVector<StringView> local_keys(alloc);
+    Allocator::ArenaVector<std::size_t> local_hashes(alloc);
+    Allocator::ArenaVector<std::size_t> local_positions(alloc);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        std::size_t owner = ownerOf(hashes[i]);
+        if (owner == _id) {
+            local_keys.push_back(keys[i]);
+            local_hashes.push_back(hashes[i]);
+            local_positions.push_back(i);
+            continue;
+        }
+        if (parts[owner] == nullptr) {
+            parts[owner] = ShardTask::Create(&conn, _id, arena);
+        }
+        parts[owner]->keys.push_back(keys[i]);
+        parts[owner]->hashes.push_back(hashes[i]);
+        parts[owner]->positions.push_back(i);
+    }
+    if (local_keys.size() == keys.size()) {
+        return false;
+    }
+
+    conn._results.clear();
+    conn._results.resize(keys.size());
+    if (!local_keys.empty()) {
+        Allocator::ArenaVector<LookupResult> results(local_keys.size(), LookupResult(), alloc);
+        _pStorage->GetMany(local_keys.data(), local_hashes.data(), local_keys.size(), results.data());
+        for (std::size_t i = 0; i < local_keys.size(); ++i) {
+            conn._results[local_positions[i]] = std::move(results[i]);
+        }
+    }
+    for (std::size_t owner = 0; owner < parts.size(); ++owner) {
+        if (parts[owner] != nullptr) {
+            // Owner must not allocate in the arena, results are sized here
+            parts[owner]->results.resize(parts[owner]->keys.size());
+            conn._pending++;
+            send(owner, parts[owner]);
+        }
+    }
+    return true;
+}
+
+// See Worker.h
+std::size_t Worker::ownerOf(std::size_t hash) const {
+    return _server->_sharded->ShardOf(hash) % _backlog.size();
+}
+
+// See Worker.h
+void Worker::send(std::size_t dst, ShardTask *task) {
+    // Backlog goes first to keep tasks in order
+    if (!_backlog[dst].empty() || !_server->queue(_id, dst).Push(task)) {
+        _backlog[dst].push_back(task);
+    }
+    _signal[dst] = true;
+}
+
+// See Worker.h
+bool Worker::flushOutbox() {
+    bool left = false;
+    for (std::size_t dst = 0; dst < _backlog.size(); ++dst) {
+        std::deque<ShardTask *> &backlog = _backlog[dst];
+        while (!backlog.empty() && _server->queue(_id, dst).Push(backlog.front())) {
+            backlog.pop_front();
+        }
+        left = left || !backlog.empty();
+
+        if (_signal[dst]) {
+            _signal[dst] = false;
+            if (eventfd_write(_server->_mailboxes[dst], 1)) {
+                _logger->error("Failed to wakeup worker {}", dst);
+            }
+        }
+    }
+    return left;
+}
+
+// See Worker.h
+void Worker::drainMailbox() {
+    // Counter is reset before queues are checked, so that task pushed after that wakes us up again
+    eventfd_t count;
+    eventfd_read(_server->_mailboxes[_id], &count);
+
+    ShardTask *task;
+    for (std::size_t src = 0; src < _backlog.size(); ++src) {
+        auto &queue = _server->queue(src, _id);
+        while (queue.Pop(task)) {
+            if (task->origin_worker == _id) {
+                complete(task);
+            } else {
+                run(task);
+                send(task->origin_worker, task);
+            }
+        }
+    }
+}
+
+// See Worker.h
+void Worker::run(ShardTask *task) {
+    if (task->command == nullptr) {
+        _pStorage->GetMany(task->keys.data(), task->hashes.data(), task->keys.size(), task->results.data());
+        return;
+    }
+
+    try {
+        task->command->Execute(*_pStorage, *task->args, task->out);
+    } catch (std::runtime_error &ex) {
+        _logger->error("Failed to execute command: {}", ex.what());
+        task->out.clear();
+        task->out.push_back(Value::Copy(std::string("SERVER_ERROR ") + ex.what()));
+    }
+}
+
+// See Worker.h
+void Worker::complete(ShardTask *task) {
+    Connection *pconn = task->origin;
+    if (task->command != nullptr) {
+        if (task->command->NoReply()) {
+            task->out.clear();
+        }
+        for (Value &chunk : task->out) {
+            pconn->output.push_back(std::move(chunk));
+        }
+        pconn->_responded = !task->out.empty();
+    } else {
+        for (std::size_t i = 0; i < task->positions.size(); ++i) {
+            pconn->_results[task->positions[i]] = std::move(task->results[i]);
+        }
+    }
+    ShardTask::Destroy(task);
+
+    if (--pconn->_pending > 0) {
+        return;
+    }
+    if (pconn->isAlive()) {
+        if (!pconn->_results.empty()) {
+            static_cast<Execute::Get &>(*pconn->command_to_execute).Reply(pconn->_results, pconn->output);
+            pconn->_results.clear();
+            pconn->_responded = true;
+        }
+        pconn->Resume();
+    }
+
+    if (pconn->isAlive()) {
+        rearm(pconn);
+    } else {
+        closeConnection(pconn);
+    }
+}
+
+// See Worker.h
+void Worker::rearm(Connection *pconn) {
+    pconn->_event.events |= EPOLLONESHOT;
+    int epoll_ctl_retval;
+    if ((epoll_ctl_retval = epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, pconn->_socket, &pconn->_event))) {
+        _logger->debug("epoll_ctl failed during connection rearm: error {}", epoll_ctl_retval);
+        pconn->OnError();
+        closeConnection(pconn);
+    }
+}
+
+// See Worker.h
+void Worker::closeConnection(Connection *pconn) {
+    // Connection isn't rearmed, so it gets no events until the last task comes back, see complete
+    if (pconn->_pending > 0) {
+        return;
+    }
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, pconn->_socket, &pconn->_event)) {
+        std::cerr << "Failed to delete connection!" << std::endl;
+    }
+    std::lock_guard<std::mutex> lock(_server->_mutex);
+    _server->_connections.erase(pconn);
+    close(pconn->_socket);
+    delete pconn;
+}
+
 } // namespace MTnonblock
 } // namespace Network
 } // namespace Afina
@@ -2,8 +2,17 @@
 #define AFINA_NETWORK_MT_NONBLOCKING_WORKER_H
 
 #include <atomic>
+#include <deque>
 #include <memory>
+#include <new>
+#include <string>
 #include <thread>
+#include <vector>
+
+#include <afina/Storage.h>
+#include <afina/StringView.h>
+#include <afina/Value.h>
+#include <afina/allocator/Arena.h>
 #include "ServerImpl.h"
 
 namespace spdlog {
@@ -18,9 +27,56 @@ namespace Logging {
 class Service;
 }
 
+namespace Execute {
+class Command;
+}
+
 namespace Network {
 namespace MTnonblock {
 
+/**
+ * # Part of the command executed by the worker owning its keys
+ * Travels from the worker of the connection to the owner and back through the same pair of queues, so that
+ * connection, command and argument are touched by the worker of the connection only, while owner reads them
+ * in between.
+ *
+ * Task lives in the command arena of the connection parser, see Create, so that forwarding costs no malloc.
+ * Only the worker of the connection allocates there: owner reads keys and fills results sized in advance.
+ */
+struct ShardTask {
+    ShardTask(Connection *origin, std::size_t origin_worker, Allocator::Arena *arena)
+        : origin(origin), origin_worker(origin_worker), command(nullptr), args(nullptr),
+          keys(Allocator::StlAllocator<StringView, Allocator::Arena>(arena)),
+          hashes(Allocator::StlAllocator<std::size_t, Allocator::Arena>(arena)),
+          positions(Allocator::StlAllocator<std::size_t, Allocator::Arena>(arena)),
+          results(Allocator::StlAllocator<LookupResult, Allocator::Arena>(arena)) {}
+
+    // Places task into the arena, which must outlive it
+    static ShardTask *Create(Connection *origin, std::size_t origin_worker, Allocator::Arena &arena) {
+        return new (arena.Allocate(sizeof(ShardTask))) ShardTask(origin, origin_worker, &arena);
+    }
+
+    // Destroys task made by Create, memory goes back with the arena
+    static void Destroy(ShardTask *task) { task->~ShardTask(); }
+
+    // Connection waiting for the response and the worker it belongs to
+    Connection *origin;
+    std::size_t origin_worker;
+
+    // Single key command is executed by the owner as a whole and gets response in out
+    Execute::Command *command;
+    const std::string *args;
+    std::vector<Value> out;
+
+    // Or, if command is null, that is a part of multi-key get: keys owned by the same worker, their positions
+    // in the command, their hashes and lookup results. Keys are views of the parser, which stay valid until
+    // the command completes
+    Allocator::ArenaVector<StringView> keys;
+    Allocator::ArenaVector<std::size_t> hashes;
+    Allocator::ArenaVector<std::size_t> positions;
+    Allocator::ArenaVector<LookupResult> results;
+};
+
 /**
  * # Thread running epoll
  * On Start spaws background thread that is doing epoll on the given server
@@ -28,7 +84,8 @@ namespace MTnonblock {
  */
 class Worker {
 public:
-    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl, ServerImpl* server);
+    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Afina::Logging::Service> pl, ServerImpl* server,
+           std::size_t id = 0);
     ~Worker();
 
     Worker(Worker &&);
@@ -55,6 +112,14 @@ public:
      */
     void Join();
 
+    /**
+     * Shard-per-thread mode, see ShardedStorage: every worker owns shards with number equal to its id modulo
+     * number of workers and is the only one that touches them. Command of the connection is sent to the
+     * workers owning its keys and the method returns true, connection gets Resume once all of them answer.
+     * Returns false if all keys are owned by this worker, so connection should run command by itself
+     */
+    bool Forward(Connection &conn);
+
 protected:
     /**
      * Method executing by background thread
@@ -65,6 +130,30 @@ private:
     Worker(Worker &) = delete;
     Worker &operator=(Worker &) = delete;
 
+    // Worker owning shard of the key with the given KeyHash
+    std::size_t ownerOf(std::size_t hash) const;
+
+    // Queues task to the given worker, task goes to the backlog if the queue is full
+    void send(std::size_t dst, ShardTask *task);
+
+    // Moves backlog to the queues and wakes up receivers. Returns true if something is left in backlog
+    bool flushOutbox();
+
+    // Runs tasks of other workers and completes responses to own ones
+    void drainMailbox();
+
+    // Runs task on the shards of this worker
+    void run(ShardTask *task);
+
+    // Merges response into connection that sent the task
+    void complete(ShardTask *task);
+
+    // Registers connection in epoll for the events it waits for, closes it on failure
+    void rearm(Connection *pconn);
+
+    // Removes closed connection, unless it still waits for other workers
+    void closeConnection(Connection *pconn);
+
     // afina services
     std::shared_ptr<Afina::Storage> _pStorage;
 
@@ -84,6 +173,15 @@ private:
     int _epoll_fd;
 
     ServerImpl* _server;
+
+    // Position in the server's list of workers
+    std::size_t _id;
+
+    // Tasks that didn't fit into the queue, per receiver
+    std::vector<std::deque<ShardTask *>> _backlog;
+
+    // Receivers that got tasks since the last wakeup
+    std::vector<bool> _signal;
 };
 
 } // namespace MTnonblock
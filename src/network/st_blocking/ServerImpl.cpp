@@ -139,6 +139,7 @@ void ServerImpl::OnRun() {
         if ((client_socket = accept(_server_socket, (struct sockaddr *)&client_addr, &client_addr_len)) == -1) {
             continue;
         }
+        Execute::Metrics::Local().connections_opened.Add(1);
 
         // Got new connection
         if (_logger->should_log(spdlog::level::debug)) {
@@ -220,12 +221,17 @@ void ServerImpl::OnRun() {
                         if (argument_for_command.size()) {
                             argument_for_command.resize(argument_for_command.size() - 2);
                         }
-                        command_to_execute->Execute(*pStorage, argument_for_command, result);
+                        {
+                            Execute::Metrics::Timer timer(command_to_execute->Type());
+                            command_to_execute->Execute(*pStorage, argument_for_command, result);
+                        }
 
-                        // Send response
-                        result += "\r\n";
-                        if (send(client_socket, result.data(), result.size(), 0) <= 0) {
-                            throw std::runtime_error("Failed to send response");
+                        // Send response, quiet commands might have nothing to say, noreply ones aren't listened to
+                        if (!result.empty() && !command_to_execute->NoReply()) {
+                            result += "\r\n";
+                            if (send(client_socket, result.data(), result.size(), 0) <= 0) {
+                                throw std::runtime_error("Failed to send response");
+                            }
                         }
 
                         // Prepare for the next command
@@ -247,6 +253,7 @@ void ServerImpl::OnRun() {
 
         // We are done with this connection
         close(client_socket);
+        Execute::Metrics::Local().connections_closed.Add(1);
 
         // Prepare for the next command: just in case if connection was closed in the middle of executing something
         command_to_execute.reset();
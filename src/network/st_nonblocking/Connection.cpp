@@ -38,18 +38,25 @@ void Connection::DoRead() {
             // for example:
             // - read#0: [<command1 start>]
             // - read#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
-            while (_buff_offset > 0) {
-                _pLogger->debug("Process {} bytes", _buff_offset);
+            //
+            // Consumed bytes are dropped from the buffer only once all of it is processed: until then keys of
+            // the current command are views into the buffer, see Protocol::Parser
+            std::size_t start = 0;
+            while (start < _buff_offset) {
+                _pLogger->debug("Process {} bytes", _buff_offset - start);
                 // There is no command yet
                 if (!command_to_execute) {
+                    if (!parser) {
+                        parser = Protocol::Frontend::Create(_read_buffer[start], true);
+                    }
                     std::size_t parsed = 0;
-                    if (parser.Parse(_read_buffer, _buff_offset, parsed)) {
+                    if (parser->Parse(_read_buffer + start, _buff_offset - start, parsed)) {
                         // There is no command to be launched, continue to parse input stream
                         // Here we are, current chunk finished some command, process it
-                        _pLogger->debug("Found new command: {} in {} bytes", parser.Name(), parsed);
-                        command_to_execute = parser.Build(_arg_remains);
+                        _pLogger->debug("Found new command: {} in {} bytes", parser->Name(), parsed);
+                        command_to_execute = parser->Build(_arg_remains);
                         if (_arg_remains > 0) {
-                            _arg_remains += 2;
+                            _arg_remains += parser->BodyTrailer();
                         }
                     }
 
@@ -58,47 +65,56 @@ void Connection::DoRead() {
                     if (parsed == 0) {
                         break;
                     } else {
-                        std::memmove(_read_buffer, _read_buffer + parsed, _buff_offset - parsed);
-                        _buff_offset -= parsed;
+                        start += parsed;
                     }
                 }
 
                 // There is command, but we still wait for argument to arrive...
                 if (command_to_execute && _arg_remains > 0) {
-                    _pLogger->debug("Fill argument: {} bytes of {}", _buff_offset, _arg_remains);
+                    _pLogger->debug("Fill argument: {} bytes of {}", _buff_offset - start, _arg_remains);
                     // There is some parsed command, and now we are reading argument
-                    std::size_t to_read = std::min(_arg_remains, std::size_t(_buff_offset));
-                    argument_for_command.append(_read_buffer, to_read);
+                    std::size_t to_read = std::min(_arg_remains, _buff_offset - start);
+                    argument_for_command.append(_read_buffer + start, to_read);
 
-                    std::memmove(_read_buffer, _read_buffer + to_read, _buff_offset - to_read);
                     _arg_remains -= to_read;
-                    _buff_offset -= to_read;
+                    start += to_read;
                 }
 
                 // There is command & argument - RUN!
                 if (command_to_execute && _arg_remains == 0) {
                     _pLogger->debug("Start command execution");
 
-                    std::string result;
+                    _result.clear();
                     if (argument_for_command.size()) {
-                        argument_for_command.resize(argument_for_command.size() - 2);
+                        argument_for_command.resize(argument_for_command.size() - parser->BodyTrailer());
+                    }
+                    {
+                        Execute::Metrics::Timer timer(command_to_execute->Type());
+                        command_to_execute->Execute(*_pStorage, argument_for_command, _result);
                     }
-                    command_to_execute->Execute(*_pStorage, argument_for_command, result);
 
-                    result += "\r\n";
-                    output.push_back(std::move(result));
-                    _event.events |= EPOLLOUT;
-                    if (output.size() >= MAX_OUTPUT_QUEUE_SIZE){
-                        _event.events &= ~EPOLLIN;
+                    // Quiet commands might have nothing to say, noreply ones aren't listened to
+                    if (!_result.empty() && !command_to_execute->NoReply()) {
+                        StringView trailer = parser->ResponseTrailer();
+                        output.emplace_back(Allocator::ArenaString::allocator_type(&_arena));
+                        output.back().reserve(_result.size() + trailer.size());
+                        output.back().append(_result.data(), _result.size()).append(trailer.data(), trailer.size());
+                        _event.events |= EPOLLOUT;
+                        if (output.size() >= MAX_OUTPUT_QUEUE_SIZE){
+                            _event.events &= ~EPOLLIN;
+                        }
                     }
 
                     // Prepare for the next command
                     command_to_execute.reset();
                     argument_for_command.resize(0);
-                    parser.Reset();
+                    parser->Reset();
                 }
-            } // while (readed_bytes)
-        }
+            }
+
+            std::memmove(_read_buffer, _read_buffer + start, _buff_offset - start);
+            _buff_offset -= start;
+        } // while (readed_bytes)
         if (readed_bytes == 0) {
             _pLogger->debug("Client closed connection on socket {}", _socket);
             if (!_event.events & EPOLLOUT) {
@@ -152,6 +168,7 @@ void Connection::DoWrite() {
         _event.events |= EPOLLIN;
     }
     if (output.empty()){
+        _arena.Reset();
         if (_eof){
             _is_alive = false;
         }
@@ -5,7 +5,8 @@
 #include <string>
 #include <vector>
 #include <sys/epoll.h>
-#include "protocol/Parser.h"
+#include "protocol/Frontend.h"
+#include <afina/allocator/Arena.h>
 #include <afina/execute/Command.h>
 #include <spdlog/logger.h>
 
@@ -26,8 +27,11 @@ public:
         _head_offset = 0;
         _eof = false;
         std::memset(_read_buffer, 0, 4096);
+        Execute::Metrics::Local().connections_opened.Add(1);
     }
 
+    ~Connection() { Execute::Metrics::Local().connections_closed.Add(1); }
+
     inline bool isAlive() const { return _is_alive; }
 
     void Start();
@@ -45,16 +49,21 @@ private:
     bool _is_alive;
     bool _eof;
     struct epoll_event _event;
-    std::vector<std::string> output;
+    // Memory of responses waiting in output, released at once when all of them are written
+    Allocator::Arena _arena;
+    std::vector<Allocator::ArenaString> output;
     std::size_t _head_offset;
+    // Response of the current command is built here, capacity is reused by the next ones
+    std::string _result;
 
     std::shared_ptr<Afina::Storage> _pStorage;
     std::shared_ptr<spdlog::logger> _pLogger;
     char _read_buffer[4096];
-    int _buff_offset;
+    std::size_t _buff_offset;
 
     std::size_t _arg_remains;
-    Protocol::Parser parser;
+    // Protocol is chosen by the first byte of the connection, see Protocol::Frontend::Create
+    std::unique_ptr<Protocol::Frontend> parser;
     std::string argument_for_command;
     std::unique_ptr<Execute::Command> command_to_execute;
 };
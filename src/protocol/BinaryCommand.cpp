@@ -0,0 +1,368 @@
+#include "BinaryCommand.h"
+#include "BinaryParser.h"
+
+#include <memory>
+#include <stdexcept>
+
+#include <afina/Storage.h>
+#include <afina/execute/Add.h>
+#include <afina/execute/Append.h>
+#include <afina/execute/Cas.h>
+#include <afina/execute/Decr.h>
+#include <afina/execute/Delete.h>
+#include <afina/execute/Incr.h>
+#include <afina/execute/Prepend.h>
+#include <afina/execute/Replace.h>
+#include <afina/execute/Set.h>
+
+namespace Afina {
+namespace Protocol {
+
+namespace {
+
+// Numbers on the wire are big endian
+inline void putNumber(std::string &out, uint64_t value, std::size_t bytes) {
+    for (std::size_t i = bytes; i > 0; i--) {
+        out.push_back(static_cast<char>((value >> (8 * (i - 1))) & 0xff));
+    }
+}
+
+inline uint64_t getNumber(const std::string &in, std::size_t offset, std::size_t bytes) {
+    uint64_t value = 0;
+    for (std::size_t i = 0; i < bytes; i++) {
+        value = (value << 8) | static_cast<uint8_t>(in[offset + i]);
+    }
+    return value;
+}
+
+// Text of the error response as memcached has it
+const char *messageOf(BinaryCommand::Status status) {
+    switch (status) {
+    case BinaryCommand::KeyNotFound:
+        return "Not found";
+    case BinaryCommand::KeyExists:
+        return "Data exists for key.";
+    case BinaryCommand::TooLarge:
+        return "Too large.";
+    case BinaryCommand::InvalidArguments:
+        return "Invalid arguments";
+    case BinaryCommand::NotStored:
+        return "Not stored.";
+    case BinaryCommand::NonNumeric:
+        return "Non-numeric server-side value for incr or decr";
+    case BinaryCommand::UnknownCommand:
+        return "Unknown command";
+    default:
+        return "Out of memory";
+    }
+}
+
+} // namespace
+
+// See BinaryCommand.h
+const char *BinaryCommand::NameOf(uint8_t opcode) {
+    static const char *names[] = {"get",    "set",    "add",      "replace", "delete",   "incr",    "decr",
+                                  "quit",   "flush",  "getq",     "noop",    "version",  "getk",    "getkq",
+                                  "append", "prepend", "stat",    "setq",    "addq",     "replaceq", "deleteq",
+                                  "incrq",  "decrq",  "quitq",    "flushq",  "appendq",  "prependq"};
+    if (opcode >= sizeof(names) / sizeof(names[0])) {
+        return "unknown";
+    }
+    return names[opcode];
+}
+
+// See BinaryCommand.h
+void BinaryCommand::Execute(Storage &storage, const std::string &args, std::string &out) {
+    std::vector<Value> chunks;
+    Execute(storage, args, chunks);
+
+    out.clear();
+    for (auto &chunk : chunks) {
+        out.append(chunk.data(), chunk.size());
+    }
+}
+
+// See BinaryCommand.h
+void BinaryCommand::Execute(Storage &storage, const std::string &args, std::vector<Value> &out) {
+    switch (base()) {
+    case Get:
+    case GetK:
+        get(storage, args, out);
+        break;
+
+    case Set:
+    case Add:
+    case Replace:
+    case Append:
+    case Prepend:
+        store(storage, args, out);
+        break;
+
+    case Delete:
+        remove(storage, args, out);
+        break;
+
+    case Increment:
+    case Decrement:
+        count(storage, args, out);
+        break;
+
+    case NoOp:
+        if (!_extras.empty() || !_key.empty() || !args.empty()) {
+            error(InvalidArguments, out);
+        } else {
+            done(out);
+        }
+        break;
+
+    default:
+        error(UnknownCommand, out);
+    }
+}
+
+// See BinaryCommand.h
+Execute::Metrics::CommandType BinaryCommand::Type() const {
+    switch (base()) {
+    case Get:
+    case GetK:
+        return Execute::Metrics::CommandType::Get;
+    case Set:
+        return _cas != 0 ? Execute::Metrics::CommandType::Cas : Execute::Metrics::CommandType::Set;
+    case Add:
+        return Execute::Metrics::CommandType::Add;
+    case Replace:
+        return Execute::Metrics::CommandType::Replace;
+    case Append:
+        return Execute::Metrics::CommandType::Append;
+    case Prepend:
+        return Execute::Metrics::CommandType::Prepend;
+    case Delete:
+        return Execute::Metrics::CommandType::Delete;
+    case Increment:
+        return Execute::Metrics::CommandType::Incr;
+    case Decrement:
+        return Execute::Metrics::CommandType::Decr;
+    default:
+        return Execute::Metrics::CommandType::Other;
+    }
+}
+
+// See BinaryCommand.h
+void BinaryCommand::get(Storage &storage, const std::string &args, std::vector<Value> &out) const {
+    if (!_extras.empty() || _key.empty() || !args.empty()) {
+        error(InvalidArguments, out);
+        return;
+    }
+
+    Value value;
+    ItemMeta meta;
+    bool found = storage.Get(_key, value, meta);
+    Execute::Metrics::ThreadCounters &counters = Execute::Metrics::Local();
+    (found ? counters.get_hits : counters.get_misses).Add(1);
+
+    // Key is sent back by getk only
+    std::size_t key_length = base() == GetK ? _key.size() : 0;
+    std::string text;
+    if (!found) {
+        if (quiet()) {
+            return;
+        }
+        if (key_length == 0) {
+            error(KeyNotFound, out);
+            return;
+        }
+        header(text, KeyNotFound, 0, key_length, key_length, 0);
+        text.append(_key);
+        out.push_back(Value::Copy(text));
+        return;
+    }
+
+    // Value is passed as is, flags are the extras
+    header(text, Success, 4, key_length, 4 + key_length + value.size(), meta.cas);
+    putNumber(text, meta.flags, 4);
+    text.append(_key, 0, key_length);
+    out.push_back(Value::Copy(text));
+    if (!value.empty()) {
+        out.push_back(std::move(value));
+    }
+}
+
+// See BinaryCommand.h
+void BinaryCommand::store(Storage &storage, const std::string &args, std::vector<Value> &out) const {
+    bool with_extras = base() != Append && base() != Prepend;
+    if (_extras.size() != (with_extras ? 8 : 0) || _key.empty()) {
+        error(InvalidArguments, out);
+        return;
+    }
+    uint32_t flags = with_extras ? getNumber(_extras, 0, 4) : 0;
+    int32_t expire = with_extras ? static_cast<int32_t>(getNumber(_extras, 4, 4)) : 0;
+
+    // Outcome of the text command that isn't a success
+    Status not_stored = NotStored;
+    std::unique_ptr<Afina::Execute::Command> command;
+    switch (base()) {
+    case Set:
+        if (_cas != 0) {
+            command.reset(new Afina::Execute::Cas(_key, flags, expire, _cas));
+        } else {
+            command.reset(new Afina::Execute::Set(_key, flags, expire, _hash));
+        }
+        break;
+    case Add:
+        command.reset(new Afina::Execute::Add(_key, flags, expire, _hash));
+        not_stored = KeyExists;
+        break;
+    case Replace:
+        command.reset(new Afina::Execute::Replace(_key, flags, expire));
+        not_stored = KeyNotFound;
+        break;
+    case Append:
+        command.reset(new Afina::Execute::Append(_key, flags, expire));
+        break;
+    default:
+        command.reset(new Afina::Execute::Prepend(_key, flags, expire));
+    }
+
+    std::string result;
+    command->Execute(storage, args, result);
+    if (result == "STORED") {
+        done(out);
+    } else if (result == "NOT_STORED") {
+        error(not_stored, out);
+    } else if (result == "EXISTS") {
+        error(KeyExists, out);
+    } else if (result == "NOT_FOUND") {
+        error(KeyNotFound, out);
+    } else {
+        error(OutOfMemory, out);
+    }
+}
+
+// See BinaryCommand.h
+void BinaryCommand::remove(Storage &storage, const std::string &args, std::vector<Value> &out) const {
+    if (!_extras.empty() || _key.empty() || !args.empty()) {
+        error(InvalidArguments, out);
+        return;
+    }
+
+    std::string result;
+    Afina::Execute::Delete(_key).Execute(storage, args, result);
+    if (result == "DELETED") {
+        done(out);
+    } else {
+        error(KeyNotFound, out);
+    }
+}
+
+// See BinaryCommand.h
+void BinaryCommand::count(Storage &storage, const std::string &args, std::vector<Value> &out) const {
+    if (_extras.size() != 20 || _key.empty() || !args.empty()) {
+        error(InvalidArguments, out);
+        return;
+    }
+    uint64_t delta = getNumber(_extras, 0, 8);
+    uint64_t initial = getNumber(_extras, 8, 8);
+    uint32_t expire = getNumber(_extras, 16, 4);
+
+    uint64_t number;
+    for (;;) {
+        std::string result;
+        if (base() == Increment) {
+            Afina::Execute::Incr(_key, delta).Execute(storage, args, result);
+        } else {
+            Afina::Execute::Decr(_key, delta).Execute(storage, args, result);
+        }
+
+        if (result == "NOT_FOUND") {
+            // Expire time of all ones means that missing item must not be created
+            if (expire == 0xffffffff) {
+                error(KeyNotFound, out);
+                return;
+            }
+            std::string added;
+            Afina::Execute::Add(_key, 0, static_cast<int32_t>(expire), _hash)
+                .Execute(storage, std::to_string(initial), added);
+            if (added == "STORED") {
+                number = initial;
+                break;
+            }
+            // Created by somebody else in between, count once again
+            continue;
+        }
+        if (result.compare(0, 12, "CLIENT_ERROR") == 0) {
+            error(NonNumeric, out);
+            return;
+        }
+        if (result.compare(0, 12, "SERVER_ERROR") == 0) {
+            error(OutOfMemory, out);
+            return;
+        }
+        number = std::stoull(result);
+        break;
+    }
+
+    if (quiet()) {
+        return;
+    }
+    std::string text;
+    header(text, Success, 0, 0, 8, 0);
+    putNumber(text, number, 8);
+    out.push_back(Value::Copy(text));
+}
+
+// See BinaryCommand.h
+void BinaryCommand::done(std::vector<Value> &out) const {
+    if (quiet()) {
+        return;
+    }
+    std::string text;
+    header(text, Success, 0, 0, 0, 0);
+    out.push_back(Value::Copy(text));
+}
+
+// See BinaryCommand.h
+void BinaryCommand::error(Status status, std::vector<Value> &out) const {
+    std::string message(messageOf(status));
+    std::string text;
+    header(text, status, 0, 0, message.size(), 0);
+    text.append(message);
+    out.push_back(Value::Copy(text));
+}
+
+// See BinaryCommand.h
+void BinaryCommand::header(std::string &out, Status status, std::size_t extras_length, std::size_t key_length,
+                           std::size_t body_length, uint64_t cas) const {
+    putNumber(out, BinaryParser::ResponseMagic, 1);
+    putNumber(out, _opcode, 1);
+    putNumber(out, key_length, 2);
+    putNumber(out, extras_length, 1);
+    // Data type, raw bytes
+    putNumber(out, 0, 1);
+    putNumber(out, status, 2);
+    putNumber(out, body_length, 4);
+    putNumber(out, _opaque, 4);
+    putNumber(out, cas, 8);
+}
+
+// See BinaryCommand.h
+uint8_t BinaryCommand::base() const {
+    switch (_opcode) {
+    case GetQ:
+        return Get;
+    case GetKQ:
+        return GetK;
+    case AppendQ:
+        return Append;
+    case PrependQ:
+        return Prepend;
+    default:
+        // SetQ to FlushQ go in the same order as Set to Flush
+        return _opcode >= SetQ && _opcode <= FlushQ ? _opcode - SetQ + Set : _opcode;
+    }
+}
+
+// See BinaryCommand.h
+bool BinaryCommand::quiet() const { return base() != _opcode; }
+
+} // namespace Protocol
+} // namespace Afina
@@ -0,0 +1,134 @@
+#ifndef AFINA_PROTOCOL_BINARY_COMMAND_H
+#define AFINA_PROTOCOL_BINARY_COMMAND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <afina/execute/Command.h>
+
+namespace Afina {
+namespace Protocol {
+
+/**
+ * # Request of memcached binary protocol
+ * Executes request parsed out by BinaryParser and writes binary response for it, opaque of the request is
+ * echoed back so that client could match responses of pipelined requests. Storage commands are run by the
+ * text protocol ones, their outcome is translated into the response status.
+ *
+ * Supported are get, getk, set, add, replace, append, prepend, delete, increment, decrement and noop along
+ * with quiet variants. Quiet get says nothing on miss, other quiet commands say nothing on success, errors
+ * are always sent. Other opcodes are answered with UnknownCommand.
+ *
+ * Response to the get carries version of the item, responses to writes carry 0 as storage doesn't tell
+ * the version it has assigned.
+ */
+class BinaryCommand : public Execute::Command {
+public:
+    enum Opcode : uint8_t {
+        Get = 0x00,
+        Set = 0x01,
+        Add = 0x02,
+        Replace = 0x03,
+        Delete = 0x04,
+        Increment = 0x05,
+        Decrement = 0x06,
+        Quit = 0x07,
+        Flush = 0x08,
+        GetQ = 0x09,
+        NoOp = 0x0a,
+        Version = 0x0b,
+        GetK = 0x0c,
+        GetKQ = 0x0d,
+        Append = 0x0e,
+        Prepend = 0x0f,
+        Stat = 0x10,
+        SetQ = 0x11,
+        AddQ = 0x12,
+        ReplaceQ = 0x13,
+        DeleteQ = 0x14,
+        IncrementQ = 0x15,
+        DecrementQ = 0x16,
+        QuitQ = 0x17,
+        FlushQ = 0x18,
+        AppendQ = 0x19,
+        PrependQ = 0x1a
+    };
+
+    enum Status : uint16_t {
+        Success = 0x00,
+        KeyNotFound = 0x01,
+        KeyExists = 0x02,
+        TooLarge = 0x03,
+        InvalidArguments = 0x04,
+        NotStored = 0x05,
+        NonNumeric = 0x06,
+        UnknownCommand = 0x81,
+        OutOfMemory = 0x82
+    };
+
+    BinaryCommand(uint8_t opcode, uint32_t opaque, uint64_t cas, const std::string &key, std::size_t hash,
+                  const std::string &extras)
+        : _opcode(opcode), _opaque(opaque), _cas(cas), _key(key), _hash(hash), _extras(extras) {}
+    ~BinaryCommand() {}
+
+    inline uint8_t opcode() const { return _opcode; }
+    inline uint32_t opaque() const { return _opaque; }
+    inline uint64_t cas() const { return _cas; }
+    inline const std::string &key() const { return _key; }
+    inline const std::string &extras() const { return _extras; }
+
+    /**
+     * Name of the opcode as memcached calls it, "unknown" for opcodes it doesn't have
+     */
+    static const char *NameOf(uint8_t opcode);
+
+    void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    void Execute(Storage &storage, const std::string &args, std::vector<Value> &out) override;
+
+    Execute::Metrics::CommandType Type() const override;
+
+private:
+    BinaryCommand(const BinaryCommand &) = delete;
+    BinaryCommand &operator=(const BinaryCommand &) = delete;
+
+    // Get, GetK and their quiet variants
+    void get(Storage &storage, const std::string &args, std::vector<Value> &out) const;
+
+    // Set, Add, Replace, Append, Prepend and their quiet variants
+    void store(Storage &storage, const std::string &args, std::vector<Value> &out) const;
+
+    // Delete and DeleteQ
+    void remove(Storage &storage, const std::string &args, std::vector<Value> &out) const;
+
+    // Increment, Decrement and their quiet variants
+    void count(Storage &storage, const std::string &args, std::vector<Value> &out) const;
+
+    // Appends successful response without value, unless command is quiet
+    void done(std::vector<Value> &out) const;
+
+    // Appends error response with the message of the status as value
+    void error(Status status, std::vector<Value> &out) const;
+
+    // Appends response header, body_length includes sizes of extras and key
+    void header(std::string &out, Status status, std::size_t extras_length, std::size_t key_length,
+                std::size_t body_length, uint64_t cas) const;
+
+    // Opcode with the quiet bit dropped, such as Set for SetQ
+    uint8_t base() const;
+    bool quiet() const;
+
+    const uint8_t _opcode;
+    const uint32_t _opaque;
+    const uint64_t _cas;
+    const std::string _key;
+    const std::size_t _hash;
+    const std::string _extras;
+};
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_BINARY_COMMAND_H
@@ -0,0 +1,140 @@
+#include "BinaryParser.h"
+#include "BinaryCommand.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <afina/KeyHash.h>
+
+namespace Afina {
+namespace Protocol {
+
+namespace {
+
+// Numbers on the wire are big endian
+inline uint64_t get(const char *in, std::size_t bytes) {
+    uint64_t value = 0;
+    for (std::size_t i = 0; i < bytes; i++) {
+        value = (value << 8) | static_cast<uint8_t>(in[i]);
+    }
+    return value;
+}
+
+} // namespace
+
+// See BinaryParser.h
+bool BinaryParser::Parse(const char *input, const size_t size, size_t &parsed) {
+    parsed = 0;
+    if (parse_complete) {
+        return true;
+    }
+
+    if (_header_size < HeaderSize) {
+        std::size_t n = std::min(HeaderSize - _header_size, size);
+        std::memcpy(_header + _header_size, input, n);
+        _header_size += n;
+        parsed += n;
+        if (_header_size < HeaderSize) {
+            return false;
+        }
+        decodeHeader();
+    }
+
+    if (_extras_size < extras_length) {
+        std::size_t n = std::min<std::size_t>(extras_length - _extras_size, size - parsed);
+        std::memcpy(_extras + _extras_size, input + parsed, n);
+        _extras_size += n;
+        parsed += n;
+        if (_extras_size < extras_length) {
+            return false;
+        }
+    }
+
+    std::size_t rest = key_length - curKey.size();
+    if (key_length == 0) {
+        // Command without key, such as noop
+    } else if (curKey.empty() && size - parsed >= rest) {
+        // Whole key is in the input
+        pushKey(StringView(input + parsed, rest), _views);
+    } else {
+        std::size_t n = std::min(rest, size - parsed);
+        curKey.append(input + parsed, n);
+        if (n < rest) {
+            parsed += n;
+            return false;
+        }
+        // Key stays in curKey until Reset
+        pushKey(StringView(curKey.data(), curKey.size()), true);
+    }
+    parsed += rest;
+
+    parse_complete = true;
+    return true;
+}
+
+// See BinaryParser.h
+std::unique_ptr<Execute::Command> BinaryParser::Build(size_t &body_size) const {
+    if (!parse_complete) {
+        return std::unique_ptr<Execute::Command>(nullptr);
+    }
+
+    body_size = body_length - extras_length - key_length;
+    // Command outlives the parser arena, so it gets own copies
+    std::string key = keys.empty() ? std::string() : keys[0].str();
+    std::size_t hash = hashes.empty() ? 0 : hashes[0];
+    return std::unique_ptr<Execute::Command>(
+        new BinaryCommand(opcode, opaque, cas, key, hash, std::string(_extras, _extras_size)));
+}
+
+// See BinaryParser.h
+void BinaryParser::Reset() {
+    _header_size = 0;
+    _extras_size = 0;
+    name.clear();
+    opcode = 0;
+    key_length = 0;
+    extras_length = 0;
+    body_length = 0;
+    opaque = 0;
+    cas = 0;
+    // Containers drop memory of the arena before it is reused
+    Allocator::ArenaVector<StringView>(keys.get_allocator()).swap(keys);
+    Allocator::ArenaVector<std::size_t>(hashes.get_allocator()).swap(hashes);
+    Allocator::ArenaString(curKey.get_allocator()).swap(curKey);
+    _arena.Reset();
+    parse_complete = false;
+}
+
+// See BinaryParser.h
+void BinaryParser::decodeHeader() {
+    if (static_cast<uint8_t>(_header[0]) != RequestMagic) {
+        throw std::runtime_error("Invalid magic byte of binary request");
+    }
+    opcode = static_cast<uint8_t>(_header[1]);
+    key_length = get(_header + 2, 2);
+    extras_length = static_cast<uint8_t>(_header[4]);
+    body_length = get(_header + 8, 4);
+    opaque = get(_header + 12, 4);
+    cas = get(_header + 16, 8);
+    if (std::size_t(extras_length) + key_length > body_length) {
+        throw std::runtime_error("Binary request body is shorter than its extras and key");
+    }
+    name.assign(BinaryCommand::NameOf(opcode));
+}
+
+// See BinaryParser.h
+void BinaryParser::pushKey(StringView key, bool view) {
+    if (!view) {
+        char *copy = static_cast<char *>(_arena.Allocate(key.size()));
+        if (key.size() > 0) {
+            std::memcpy(copy, key.data(), key.size());
+        }
+        key = StringView(copy, key.size());
+    }
+    keys.push_back(key);
+    hashes.push_back(KeyHash(key.data(), key.size()));
+}
+
+} // namespace Protocol
+} // namespace Afina
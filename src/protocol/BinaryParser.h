@@ -0,0 +1,122 @@
+#ifndef AFINA_PROTOCOL_BINARY_PARSER_H
+#define AFINA_PROTOCOL_BINARY_PARSER_H
+
+#include <memory>
+#include <string>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <afina/StringView.h>
+#include <afina/allocator/Arena.h>
+
+#include "Frontend.h"
+
+namespace Afina {
+namespace Protocol {
+
+/**
+ * # Memcached binary protocol parser
+ * Each request starts with a fixed 24 bytes header, which tells sizes of extras, key and value that follow
+ * it, so that command is framed without looking at its bytes. Parse consumes header, extras and key, value
+ * is the body of the command, see Frontend.
+ *
+ * Request header, all numbers are big endian:
+ *
+ *     0       1       2       3
+ *     magic   opcode  key length
+ *     extras  data    reserved
+ *     length  type
+ *     total body length
+ *     opaque
+ *     cas (8 bytes)
+ *
+ * Views mode is the same as of Parser: key that came in a single input points to it. Commands are not
+ * checked here: BinaryCommand answers unknown ones and bad arguments with an error, only malformed header
+ * breaks the stream
+ */
+class BinaryParser : public Frontend {
+public:
+    // First byte of each request and response
+    static const uint8_t RequestMagic = 0x80;
+    static const uint8_t ResponseMagic = 0x81;
+
+    static const std::size_t HeaderSize = 24;
+
+    explicit BinaryParser(bool views = false)
+        : _views(views), keys(Allocator::StlAllocator<StringView, Allocator::Arena>(&_arena)),
+          hashes(Allocator::StlAllocator<std::size_t, Allocator::Arena>(&_arena)),
+          curKey(Allocator::StlAllocator<char, Allocator::Arena>(&_arena)) {
+        Reset();
+    }
+
+    // Implements Frontend interface, throws std::runtime_error if header is malformed
+    bool Parse(const char *input, const size_t size, size_t &parsed) override;
+
+    // Implements Frontend interface
+    std::unique_ptr<Execute::Command> Build(size_t &body_size) const override;
+
+    // Implements Frontend interface
+    void Reset() override;
+
+    // Implements Frontend interface, memcached name of the opcode, such as "getq"
+    const std::string &Name() const override { return name; }
+
+    // Implements Frontend interface, there is at most one key, commands without key have none
+    const Allocator::ArenaVector<StringView> &Keys() const override { return keys; }
+
+    // Implements Frontend interface
+    const Allocator::ArenaVector<std::size_t> &Hashes() const override { return hashes; }
+
+    // Implements Frontend interface
+    Allocator::Arena &CommandArena() override { return _arena; }
+
+    // Body is framed by its length only
+    std::size_t BodyTrailer() const override { return 0; }
+
+    // Response is framed by its header
+    StringView ResponseTrailer() const override { return StringView(); }
+
+private:
+    BinaryParser(const BinaryParser &) = delete;
+    BinaryParser &operator=(const BinaryParser &) = delete;
+
+    // See Parser::_arena
+    Allocator::Arena _arena;
+
+    // Keys point to the input when possible, see BinaryParser
+    const bool _views;
+
+    // Header is collected here as it could come in several inputs, then decoded to the fields below
+    char _header[HeaderSize];
+    std::size_t _header_size;
+
+    std::string name;
+    uint8_t opcode;
+    uint16_t key_length;
+    uint8_t extras_length;
+    uint32_t body_length;
+    uint32_t opaque;
+    uint64_t cas;
+
+    // Extras is at most 255 bytes
+    char _extras[256];
+    std::size_t _extras_size;
+
+    Allocator::ArenaVector<StringView> keys;
+    Allocator::ArenaVector<std::size_t> hashes;
+    // Bytes of the key that came in previous inputs
+    Allocator::ArenaString curKey;
+    bool parse_complete;
+
+    // Decodes collected header, throws std::runtime_error if it is malformed
+    void decodeHeader();
+
+    // Adds the key to keys along with its hash, copies it into the parser memory unless view is set
+    void pushKey(StringView key, bool view);
+};
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_BINARY_PARSER_H
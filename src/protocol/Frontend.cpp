@@ -0,0 +1,17 @@
+#include "Frontend.h"
+#include "BinaryParser.h"
+#include "Parser.h"
+
+namespace Afina {
+namespace Protocol {
+
+// See Frontend.h
+std::unique_ptr<Frontend> Frontend::Create(char first, bool views) {
+    if (static_cast<uint8_t>(first) == BinaryParser::RequestMagic) {
+        return std::unique_ptr<Frontend>(new BinaryParser(views));
+    }
+    return std::unique_ptr<Frontend>(new Parser(views));
+}
+
+} // namespace Protocol
+} // namespace Afina
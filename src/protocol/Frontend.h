@@ -0,0 +1,85 @@
+#ifndef AFINA_PROTOCOL_FRONTEND_H
+#define AFINA_PROTOCOL_FRONTEND_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include <afina/StringView.h>
+#include <afina/allocator/Arena.h>
+
+namespace Afina {
+namespace Execute {
+class Command;
+} // namespace Execute
+namespace Protocol {
+
+/**
+ * # Wire protocol of the connection
+ * Cuts commands out of the input stream and builds them. Memcached text protocol is implemented by Parser,
+ * binary one by BinaryParser, Create picks one by the first byte client sends.
+ *
+ * Command found by Parse may be followed by body of Build's body_size bytes and BodyTrailer more, which
+ * are not part of the body. Each non-empty response of the command is followed by ResponseTrailer on the
+ * wire, empty response means there is nothing to send.
+ */
+class Frontend {
+public:
+    virtual ~Frontend() {}
+
+    /**
+     * Returns protocol of the connection that starts with the given byte, see Parser for views
+     */
+    static std::unique_ptr<Frontend> Create(char first, bool views);
+
+    /**
+     * Push given string into parser input. Method returns true if it was a command parsed out
+     * from comulative input. In a such case method Build will return new command
+     *
+     * @param input string to be added to the parsed input
+     * @param size number of bytes in the input buffer that could be read
+     * @param parsed output parameter tells how many bytes was consumed from the string
+     * @return true if command has been parsed out
+     */
+    virtual bool Parse(const char *input, const size_t size, size_t &parsed) = 0;
+
+    /**
+     * Builds new command from parsed input. In case if it wasn't enough input to prse command out
+     * method return nullptr
+     */
+    virtual std::unique_ptr<Execute::Command> Build(size_t &body_size) const = 0;
+
+    /**
+     * Reset parse so that it could be used to parse out new command
+     */
+    virtual void Reset() = 0;
+
+    virtual const std::string &Name() const = 0;
+
+    /**
+     * Keys of the parsed command and KeyHash of each one, valid until Reset
+     */
+    virtual const Allocator::ArenaVector<StringView> &Keys() const = 0;
+    virtual const Allocator::ArenaVector<std::size_t> &Hashes() const = 0;
+
+    /**
+     * Memory of the current command, released by Reset. Caller could keep its own data of the command there,
+     * as long as it is gone before Reset
+     */
+    virtual Allocator::Arena &CommandArena() = 0;
+
+    /**
+     * Bytes following the command body that are not a part of it
+     */
+    virtual std::size_t BodyTrailer() const = 0;
+
+    /**
+     * Bytes sent after each non-empty response, those are never released
+     */
+    virtual StringView ResponseTrailer() const = 0;
+};
+
+} // namespace Protocol
+} // namespace Afina
+
+#endif // AFINA_PROTOCOL_FRONTEND_H
@@ -1,26 +1,118 @@
 #include "Parser.h"
 
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
 
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <afina/KeyHash.h>
 #include <afina/execute/Add.h>
 #include <afina/execute/Append.h>
+#include <afina/execute/Cas.h>
 #include <afina/execute/Command.h>
+#include <afina/execute/Decr.h>
 #include <afina/execute/Delete.h>
 #include <afina/execute/Get.h>
+#include <afina/execute/Incr.h>
+#include <afina/execute/MetaArithmetic.h>
+#include <afina/execute/MetaDelete.h>
+#include <afina/execute/MetaGet.h>
+#include <afina/execute/MetaNoOp.h>
+#include <afina/execute/MetaSet.h>
+#include <afina/execute/Prepend.h>
+#include <afina/execute/Replace.h>
 #include <afina/execute/Set.h>
 #include <afina/execute/Stats.h>
 
 namespace Afina {
 namespace Protocol {
 
+namespace {
+
+// Returns the first space or \r in [begin, end), or end if there are none. Compares whole blocks at once
+// where the instruction set allows
+inline const char *findDelimiter(const char *begin, const char *end) {
+    const char *p = begin;
+#if defined(__AVX2__)
+    const __m256i space32 = _mm256_set1_epi8(' ');
+    const __m256i cr32 = _mm256_set1_epi8('\r');
+    for (; end - p >= 32; p += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, space32), _mm256_cmpeq_epi8(block, cr32))));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i cr = _mm_set1_epi8('\r');
+    for (; end - p >= 16; p += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        uint32_t mask = static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, cr))));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for (; p < end && *p != ' ' && *p != '\r'; p++) {
+    }
+    return p;
+}
+
+// Appends decimal digit c to value, other chars are skipped
+template <typename T> inline void addDigit(T &value, char c, const char *field) {
+    if (c < '0' || c > '9') {
+        return;
+    }
+    unsigned d = c - '0';
+    if (value > (std::numeric_limits<T>::max() - d) / 10) {
+        throw std::runtime_error(std::string(field) + " field overflow");
+    }
+    value = value * 10 + d;
+}
+
+// Same for the expire time, which digits are subtracted if it is negative
+inline void addExprTimeDigit(int32_t &exprtime, bool negative, char c) {
+    if (c < '0' || c > '9') {
+        return;
+    }
+    int64_t et = int64_t(exprtime) * 10 + (negative ? -(c - '0') : (c - '0'));
+    if (et > INT32_MAX || et < INT32_MIN) {
+        throw std::runtime_error("Expire time field overflow");
+    }
+    exprtime = static_cast<int32_t>(et);
+}
+
+} // namespace
+
 // See Parse.h
 bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
     size_t pos;
     parsed = 0;
+    const std::size_t first_key = keys.size();
 
     for (pos = 0; pos < size && !parse_complete; pos++) {
+        // While there is a whole block of input fields are taken up to the delimiter at once, delimiters
+        // themselves, the rest of states and short tails of input go byte by byte below
+        if (size - pos >= BulkSize && state != State::sLF && state != State::spExprTimeStart) {
+            const char *end = findDelimiter(input + pos, input + size);
+            if (end != input + pos) {
+                takeField(input + pos, end);
+                pos = end - input;
+                if (pos == size) {
+                    break;
+                }
+            }
+        }
+
         char c = input[pos];
         // std::cout << "[" << pos << "] '" << c << "': state=" << int(state) << std::endl;
 
@@ -28,11 +120,18 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
         case State::sName: {
             if (c == ' ' || c == '\r') {
                 // std::cout << "parser debug: name='" << name << "'" << std::endl;
-                if (name == "set" || name == "add" || name == "append" || name == "prepend") {
+                if (name == "set" || name == "add" || name == "replace" || name == "append" || name == "prepend" ||
+                    name == "cas") {
                     state = State::spKey;
+                } else if (name == "delete") {
+                    state = State::sdKey;
                 } else if (name == "get" || name == "gets") {
                     state = State::sgKey;
-                } else if (name == "stats") {
+                } else if (name == "incr" || name == "decr") {
+                    state = State::siKey;
+                } else if (name == "mg" || name == "ms" || name == "md" || name == "ma") {
+                    state = State::smKey;
+                } else if (name == "stats" || name == "mn") {
                     state = State::sLF;
                     continue;
                 } else {
@@ -47,32 +146,92 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
         case State::spKey: {
             if (c == ' ') {
                 state = State::spFlags;
-                keys.push_back(curKey);
+                pushKey(input + pos);
                 // std::cout << "parser debug: key[" << keys.size() - 1 << "]='" << curKey << "'" << std::endl;
-            } else {
-                curKey.push_back(c);
+            } else if (_key_begin == nullptr) {
+                _key_begin = input + pos;
             }
             break;
         }
 
         case State::sgKey: {
             if (c == '\r') {
-                keys.push_back(curKey);
+                pushKey(input + pos);
                 // std::cout << "parser debug: total '" << keys.size() << " keys" << std::endl;
 
                 if (keys.size() == 0) {
                     throw std::runtime_error("Client provides no key to retrive");
                 }
 
-                curKey.clear();
                 state = State::sLF;
             } else if (c == ' ') {
                 // std::cout << "parser debug: key[" << keys.size() << "]='" << curKey << "'" << std::endl;
                 state = State::sgKey;
-                keys.push_back(curKey);
-                curKey.clear();
+                pushKey(input + pos);
+            } else if (_key_begin == nullptr) {
+                _key_begin = input + pos;
+            }
+            break;
+        }
+
+        case State::siKey: {
+            if (c == ' ') {
+                state = State::siDelta;
+                pushKey(input + pos);
+            } else if (_key_begin == nullptr) {
+                _key_begin = input + pos;
+            }
+            break;
+        }
+
+        case State::sdKey: {
+            if (c == ' ' || c == '\r') {
+                pushKey(input + pos);
+                state = c == ' ' ? State::sNoReply : State::sLF;
+            } else if (_key_begin == nullptr) {
+                _key_begin = input + pos;
+            }
+            break;
+        }
+
+        case State::sNoReply: {
+            if (c == '\r') {
+                if (token == "noreply") {
+                    noreply = true;
+                } else if (!token.empty()) {
+                    throw std::runtime_error("Unexpected token: " + token);
+                }
+                state = State::sLF;
+            } else if (c != ' ') {
+                token.push_back(c);
+            }
+            break;
+        }
+
+        case State::smKey: {
+            if (c == ' ' || c == '\r') {
+                pushKey(input + pos);
+                state = c == ' ' ? State::smFlags : State::sLF;
+            } else if (_key_begin == nullptr) {
+                _key_begin = input + pos;
+            }
+            break;
+        }
+
+        case State::smFlags: {
+            if (c == '\r') {
+                state = State::sLF;
+            } else {
+                meta.push_back(c);
+            }
+            break;
+        }
+
+        case State::siDelta: {
+            if (c == '\r') {
+                state = State::sLF;
             } else {
-                curKey.push_back(c);
+                addDigit(delta, c, "Delta");
             }
             break;
         }
@@ -82,13 +241,8 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
                 negative = false;
                 state = State::spExprTimeStart;
                 // std::cout << "parser debug: flags='" << flags << "'" << std::endl;
-            } else if (c >= '0' && c <= '9') {
-                uint32_t f = (flags * 10) + (c - '0');
-                if (f < flags) {
-                    // Overflow
-                    throw std::runtime_error("Flags field overflow");
-                }
-                flags = f;
+            } else {
+                addDigit(flags, c, "Flags");
             }
             break;
         }
@@ -108,20 +262,8 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
             if (c == ' ') {
                 state = State::spBytes;
                 // std::cout << "parser debug: ExprTime='" << exprtime << "'" << std::endl;
-            } else if (c >= '0' && c <= '9') {
-                int32_t et = exprtime;
-                if (negative) {
-                    et -= (c - '0');
-                    if (et > exprtime) {
-                        throw std::runtime_error("Expire time field overflow");
-                    }
-                } else {
-                    et += (c - '0');
-                    if (et < exprtime) {
-                        throw std::runtime_error("Expire time field overflow");
-                    }
-                }
-                exprtime = et;
+            } else {
+                addExprTimeDigit(exprtime, negative, c);
             }
             break;
         }
@@ -130,13 +272,21 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
             if (c == '\r') {
                 state = State::sLF;
                 // std::cout << "parser debug: bytes='" << bytes << "'" << std::endl;
-            } else if (c >= '0' && c <= '9') {
-                uint32_t b = (bytes * 10) + (c - '0');
-                if (b < bytes) {
-                    // Overflow
-                    throw std::runtime_error("Bytes field overflow");
-                }
-                bytes = b;
+            } else if (c == ' ') {
+                state = name == "cas" ? State::spCas : State::sNoReply;
+            } else {
+                addDigit(bytes, c, "Bytes");
+            }
+            break;
+        }
+
+        case State::spCas: {
+            if (c == '\r') {
+                state = State::sLF;
+            } else if (c == ' ') {
+                state = State::sNoReply;
+            } else {
+                addDigit(cas, c, "Cas");
             }
             break;
         }
@@ -157,6 +307,17 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
         }
     }
 
+    if (!parse_complete) {
+        // Caller is free to change the input once it is consumed, so the rest of the command is kept here
+        if (_key_begin != nullptr) {
+            curKey.append(_key_begin, input + pos - _key_begin);
+            _key_begin = nullptr;
+        }
+        if (_views) {
+            ownKeys(first_key);
+        }
+    }
+
     parsed += pos;
     return parse_complete;
 }
@@ -168,14 +329,68 @@ std::unique_ptr<Execute::Command> Parser::Build(size_t &body_size) const {
     }
 
     body_size = bytes;
+    // Command outlives the parser arena, so it gets own copies
+    std::string key = keys.empty() ? std::string() : keys[0].str();
+    std::unique_ptr<Execute::Command> command;
     if (name == "set") {
-        return std::unique_ptr<Execute::Command>(new Execute::Set(keys[0], flags, exprtime));
+        command.reset(new Execute::Set(key, flags, exprtime, hashes[0]));
     } else if (name == "add") {
-        return std::unique_ptr<Execute::Command>(new Execute::Add(keys[0], flags, exprtime));
+        command.reset(new Execute::Add(key, flags, exprtime, hashes[0]));
+    } else if (name == "replace") {
+        command.reset(new Execute::Replace(key, flags, exprtime));
     } else if (name == "append") {
-        return std::unique_ptr<Execute::Command>(new Execute::Append(keys[0], flags, exprtime));
-    } else if (name == "get") {
-        return std::unique_ptr<Execute::Command>(new Execute::Get(keys));
+        command.reset(new Execute::Append(key, flags, exprtime));
+    } else if (name == "prepend") {
+        command.reset(new Execute::Prepend(key, flags, exprtime));
+    } else if (name == "cas") {
+        command.reset(new Execute::Cas(key, flags, exprtime, cas));
+    } else if (name == "delete") {
+        command.reset(new Execute::Delete(key));
+    }
+    if (command) {
+        command->SetNoReply(noreply);
+        return command;
+    }
+
+    if (name == "get" || name == "gets") {
+        // Keys aren't copied, see Build in Parser.h
+        std::vector<StringView> get_keys(keys.begin(), keys.end());
+        std::vector<std::size_t> get_hashes(hashes.begin(), hashes.end());
+        return std::unique_ptr<Execute::Command>(new Execute::Get(std::move(get_keys), std::move(get_hashes), name == "gets"));
+    } else if (name == "incr") {
+        return std::unique_ptr<Execute::Command>(new Execute::Incr(key, delta));
+    } else if (name == "decr") {
+        return std::unique_ptr<Execute::Command>(new Execute::Decr(key, delta));
+    } else if (name == "mg" || name == "ms" || name == "md" || name == "ma") {
+        std::vector<std::string> meta_flags;
+        std::istringstream tokens(meta);
+        std::string token;
+        while (tokens >> token) {
+            meta_flags.push_back(token);
+        }
+        if (name == "mg") {
+            return std::unique_ptr<Execute::Command>(new Execute::MetaGet(key, meta_flags, hashes[0]));
+        } else if (name == "md") {
+            return std::unique_ptr<Execute::Command>(new Execute::MetaDelete(key, meta_flags, hashes[0]));
+        } else if (name == "ma") {
+            return std::unique_ptr<Execute::Command>(new Execute::MetaArithmetic(key, meta_flags, hashes[0]));
+        }
+        // Data length goes before flags of ms
+        if (meta_flags.empty()) {
+            throw std::runtime_error("Data length is missing");
+        }
+        uint32_t length = 0;
+        for (char c : meta_flags[0]) {
+            if (c < '0' || c > '9') {
+                throw std::runtime_error("Invalid data length: " + meta_flags[0]);
+            }
+            addDigit(length, c, "Data length");
+        }
+        body_size = length;
+        meta_flags.erase(meta_flags.begin());
+        return std::unique_ptr<Execute::Command>(new Execute::MetaSet(key, meta_flags, hashes[0]));
+    } else if (name == "mn") {
+        return std::unique_ptr<Execute::Command>(new Execute::MetaNoOp());
     } else if (name == "stats") {
         return std::unique_ptr<Execute::Command>(new Execute::Stats());
     } else {
@@ -183,16 +398,114 @@ std::unique_ptr<Execute::Command> Parser::Build(size_t &body_size) const {
     }
 }
 
+// See Parse.h
+void Parser::takeField(const char *begin, const char *end) {
+    switch (state) {
+    case State::sName:
+        name.append(begin, end - begin);
+        break;
+
+    case State::spKey:
+    case State::sgKey:
+    case State::siKey:
+    case State::sdKey:
+    case State::smKey:
+        if (_key_begin == nullptr) {
+            _key_begin = begin;
+        }
+        break;
+
+    case State::spFlags:
+        for (const char *p = begin; p < end; p++) {
+            addDigit(flags, *p, "Flags");
+        }
+        break;
+
+    case State::spExprTime:
+        for (const char *p = begin; p < end; p++) {
+            addExprTimeDigit(exprtime, negative, *p);
+        }
+        break;
+
+    case State::spBytes:
+        for (const char *p = begin; p < end; p++) {
+            addDigit(bytes, *p, "Bytes");
+        }
+        break;
+
+    case State::spCas:
+        for (const char *p = begin; p < end; p++) {
+            addDigit(cas, *p, "Cas");
+        }
+        break;
+
+    case State::siDelta:
+        for (const char *p = begin; p < end; p++) {
+            addDigit(delta, *p, "Delta");
+        }
+        break;
+
+    case State::smFlags:
+        meta.append(begin, end - begin);
+        break;
+
+    case State::sNoReply:
+        token.append(begin, end - begin);
+        break;
+
+    default:
+        throw std::runtime_error("Unknown state");
+    }
+}
+
+// See Parse.h
+void Parser::pushKey(const char *end) {
+    std::size_t tail = _key_begin == nullptr ? 0 : end - _key_begin;
+    StringView key(_key_begin, tail);
+    if (!_views || !curKey.empty()) {
+        char *copy = static_cast<char *>(_arena.Allocate(curKey.size() + tail));
+        std::memcpy(copy, curKey.data(), curKey.size());
+        if (tail > 0) {
+            std::memcpy(copy + curKey.size(), _key_begin, tail);
+        }
+        key = StringView(copy, curKey.size() + tail);
+        curKey.clear();
+    }
+    keys.push_back(key);
+    hashes.push_back(KeyHash(key.data(), key.size()));
+    _key_begin = nullptr;
+}
+
+// See Parse.h
+void Parser::ownKeys(std::size_t first) {
+    for (std::size_t i = first; i < keys.size(); ++i) {
+        char *copy = static_cast<char *>(_arena.Allocate(keys[i].size()));
+        if (keys[i].size() > 0) {
+            std::memcpy(copy, keys[i].data(), keys[i].size());
+        }
+        keys[i] = StringView(copy, keys[i].size());
+    }
+}
+
 // See Parse.h
 void Parser::Reset() {
     state = State::sName;
     name.clear();
-    keys.clear();
-    curKey.clear();
+    // Containers drop memory of the arena before it is reused
+    Allocator::ArenaVector<StringView>(keys.get_allocator()).swap(keys);
+    Allocator::ArenaVector<std::size_t>(hashes.get_allocator()).swap(hashes);
+    Allocator::ArenaString(curKey.get_allocator()).swap(curKey);
+    _key_begin = nullptr;
+    _arena.Reset();
     parse_complete = false;
     flags = 0;
     bytes = 0;
     exprtime = 0;
+    cas = 0;
+    delta = 0;
+    meta.clear();
+    token.clear();
+    noreply = false;
 }
 
 } // namespace Protocol
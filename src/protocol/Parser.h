@@ -8,19 +8,31 @@
 #include <cstddef>
 #include <cstdint>
 
+#include <afina/StringView.h>
+#include <afina/allocator/Arena.h>
+
+#include "Frontend.h"
+
 namespace Afina {
-namespace Execute {
-class Command;
-} // namespace Execute
 namespace Protocol {
 
 /**
  * # Memcached protocol parser
  * Parser supports subset of memcached protocol
+ *
+ * Keys are copied into the parser memory, unless parser is created with views = true: then keys of the
+ * command that came in a single input are views into that input, see Keys. Caller must not change the
+ * input until the command is executed. Keys of the command that spans several inputs are copied anyway
+ * before Parse returns, so that caller may compact its buffer once Parse has returned false.
  */
-class Parser {
+class Parser : public Frontend {
 public:
-    Parser() { Reset(); }
+    explicit Parser(bool views = false)
+        : _views(views), keys(Allocator::StlAllocator<StringView, Allocator::Arena>(&_arena)),
+          hashes(Allocator::StlAllocator<std::size_t, Allocator::Arena>(&_arena)),
+          curKey(Allocator::StlAllocator<char, Allocator::Arena>(&_arena)) {
+        Reset();
+    }
     /**
      * Push given string into parser input. Method returns true if it was a command parsed out
      * from comulative input. In a such case method Build will return new command
@@ -40,36 +52,90 @@ public:
      * @param parsed output parameter tells how many bytes was consumed from the string
      * @return true if command has been parsed out
      */
-    bool Parse(const char *input, const size_t size, size_t &parsed);
+    bool Parse(const char *input, const size_t size, size_t &parsed) override;
 
     /**
      * Builds new command from parsed input. In case if it wasn't enough input to prse command out
-     * method return nullptr
+     * method return nullptr. Get command refers to Keys, so it has to be executed before they are gone
      */
-    std::unique_ptr<Execute::Command> Build(size_t &body_size) const;
+    std::unique_ptr<Execute::Command> Build(size_t &body_size) const override;
 
     /**
      * Reset parse so that it could be used to parse out new command
      */
-    void Reset();
+    void Reset() override;
+
+    const std::string &Name() const override { return name; }
+
+    /**
+     * Keys of the parsed command, valid until Reset. In views mode those could point to the last input
+     * passed to Parse, see Parser
+     */
+    const Allocator::ArenaVector<StringView> &Keys() const override { return keys; }
+
+    /**
+     * KeyHash of each key, computed once while the key is parsed and passed down to storage along with it
+     */
+    const Allocator::ArenaVector<std::size_t> &Hashes() const override { return hashes; }
+
+    // Implements Frontend interface
+    Allocator::Arena &CommandArena() override { return _arena; }
 
-    inline const std::string &Name() const { return name; }
+    // Data block is followed by \r\n
+    std::size_t BodyTrailer() const override { return 2; }
+
+    // Each response line ends with \r\n
+    StringView ResponseTrailer() const override { return StringView("\r\n", 2); }
 
 private:
+    Parser(const Parser &) = delete;
+    Parser &operator=(const Parser &) = delete;
+
+    // Memory of keys of the current command, released at once by Reset. Declared first, as containers
+    // below refer to it
+    Allocator::Arena _arena;
+
     /**
      * State of the command parser. Prefixes are:
      * - s: state for PUT and GET commands
      * - sp: for PUT commands only
      * - sg: for GET commands only
+     * - si: for INCR/DECR commands only
+     * - sd: for DELETE command only
+     * - sm: for meta commands only
      */
-    enum State : uint16_t { sCR, sLF, sName, spKey, spFlags, spExprTimeStart, spExprTime, spBytes, sgKey };
+    enum State : uint16_t {
+        sCR,
+        sLF,
+        sName,
+        spKey,
+        spFlags,
+        spExprTimeStart,
+        spExprTime,
+        spBytes,
+        spCas,
+        sgKey,
+        siKey,
+        siDelta,
+        sdKey,
+        sNoReply,
+        smKey,
+        smFlags
+    };
+
+    // Fields are scanned in bulk while at least that many bytes of input are left, see Parse
+    static const std::size_t BulkSize = 16;
+
+    // Keys point to the input when possible, see Parser
+    const bool _views;
 
     // Current parser state
     State state;
 
-    // vrious fields of the command
+    // vrious fields of the command. Name is short enough to stay inside of the string itself
     std::string name;
-    std::vector<std::string> keys;
+    Allocator::ArenaVector<StringView> keys;
+    Allocator::ArenaVector<std::size_t> hashes;
 
     // <flags> is an arbitrary 16-bit unsigned integer (written out in decimal) that the server stores along with
     // the data and sends back when the item is retrieved. Clients may use this as a bit field to store data-specific
@@ -88,9 +154,37 @@ private:
     // it's followed by an empty data block).
     uint32_t bytes;
 
+    // <cas unique> is a unique 64-bit value of an existing entry. Clients should use the value returned from
+    // the "gets" command when issuing "cas" updates.
+    uint64_t cas;
+
+    // <value> of incr/decr is the amount by which the client wants to increase/decrease the item. It is a decimal
+    // representation of a 64-bit unsigned integer.
+    uint64_t delta;
+
+    // Rest of the meta command line after the key: flags, data length of ms goes first
+    std::string meta;
+
+    // Optional last token of storage commands and delete, "noreply" is the only one allowed. Client doesn't
+    // wait for the response then, see Execute::Command::NoReply
+    std::string token;
+    bool noreply;
+
     bool negative;
-    std::string curKey;
+    // Bytes of the current key that came in previous inputs
+    Allocator::ArenaString curKey;
+    // Where the rest of the current key starts in the current input, nullptr if none of it is there yet
+    const char *_key_begin;
     bool parse_complete;
+
+    // Takes bytes of the current field up to the delimiter, which is not among them, see Parse
+    void takeField(const char *begin, const char *end);
+
+    // Adds the current key that ends at end of the input to keys along with its hash
+    void pushKey(const char *end);
+
+    // Copies keys starting from first one into the parser memory
+    void ownKeys(std::size_t first);
 };
 
 } // namespace Protocol
@@ -0,0 +1,241 @@
+#include "CompactLRU.h"
+
+#include <cstring>
+#include <time.h>
+
+#include <afina/allocator/Error.h>
+
+namespace Afina {
+namespace Backend {
+
+CompactLRU::CompactLRU(size_t max_size) :
+    _max_size(max_size),
+    _memory(new char[max_size]),
+    _region(_memory.get(), max_size),
+    _head(nullptr),
+    _tail(nullptr),
+    _last_cas(0),
+    _bytes(0),
+    _evictions(0)
+    {}
+
+// See MapBasedGlobalLockImpl.h
+bool CompactLRU::Put(const std::string &key, const std::string &value, const ItemMeta &meta) {
+    if (value.size() > _max_size){
+        return false;
+    }
+    entry *item = findEntry(key);
+    if (item == nullptr){
+        return addEntry(key, value, meta);
+    }
+    if (!resize(*item, value.size())){
+        return false;
+    }
+    std::memcpy(item->value.get(), value.data(), value.size());
+    item->meta = ItemMeta(meta.flags, meta.expire, ++_last_cas);
+    compactSlice();
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool CompactLRU::PutIfAbsent(const std::string &key, const std::string &value, const ItemMeta &meta) {
+    if (value.size() > _max_size || findEntry(key) != nullptr){
+        return false;
+    }
+    return addEntry(key, value, meta);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool CompactLRU::Set(const std::string &key, const std::string &value, const ItemMeta &meta) {
+    if (value.size() > _max_size || findEntry(key) == nullptr){
+        return false;
+    }
+    return Put(key, value, meta);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool CompactLRU::Delete(const std::string &key) {
+    entry *item = findEntry(key);
+    if (item == nullptr){
+        return false;
+    }
+    deleteEntry(*item);
+    compactSlice();
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool CompactLRU::Get(const std::string &key, std::string &value) {
+    entry *item = findEntry(key);
+    if (item == nullptr){
+        return false;
+    }
+    value.assign(static_cast<const char *>(item->value.get()), item->size);
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool CompactLRU::Get(const std::string &key, Value &value) {
+    ItemMeta meta;
+    return Get(key, value, meta);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool CompactLRU::Get(const std::string &key, Value &value, ItemMeta &meta) {
+    entry *item = findEntry(key);
+    if (item == nullptr){
+        return false;
+    }
+    value = Value::Copy(static_cast<const char *>(item->value.get()), item->size);
+    meta = item->meta;
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool CompactLRU::Append(const std::string &key, const std::string &data) {
+    return concat(key, data, false);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool CompactLRU::Prepend(const std::string &key, const std::string &data) {
+    return concat(key, data, true);
+}
+
+// See MapBasedGlobalLockImpl.h
+void CompactLRU::CollectStats(std::map<std::string, uint64_t> &stats) {
+    stats["curr_items"] += _index.size();
+    stats["bytes"] += _bytes;
+    stats["limit_maxbytes"] += _max_size;
+    stats["evictions"] += _evictions;
+    stats["region_holes"] += _region.holes();
+}
+
+CompactLRU::entry *CompactLRU::findEntry(const std::string &key){
+    auto it = _index.find(key);
+    if (it == _index.end()){
+        return nullptr;
+    }
+    entry &item = it->second;
+    if (isExpired(item)){
+        deleteEntry(item);
+        return nullptr;
+    }
+    unlink(item);
+    linkTail(item);
+    return &item;
+}
+
+bool CompactLRU::addEntry(const std::string &key, const std::string &value, const ItemMeta &meta){
+    auto it = _index.emplace(key, entry()).first;
+    entry &item = it->second;
+    item.key = &it->first;
+    item.size = 0;
+    item.meta = ItemMeta(meta.flags, meta.expire, ++_last_cas);
+    linkTail(item);
+    _bytes += key.size();
+    if (!resize(item, value.size())){
+        return false;
+    }
+    std::memcpy(item.value.get(), value.data(), value.size());
+    compactSlice();
+    return true;
+}
+
+bool CompactLRU::resize(entry &item, std::size_t size){
+    for (;;){
+        try {
+            _region.realloc(item.value, size);
+            _bytes += size;
+            _bytes -= item.size;
+            item.size = size;
+            return true;
+        } catch (Allocator::AllocError &){
+        }
+
+        // Holes could be large enough together, otherwise room is made by the least recently used items
+        if (_region.holes() > 0){
+            _region.defrag();
+            continue;
+        }
+        entry *victim = _head;
+        if (victim == &item){
+            victim = victim->next;
+        }
+        if (victim == nullptr){
+            deleteEntry(item);
+            return false;
+        }
+        deleteEntry(*victim);
+        _evictions++;
+    }
+}
+
+bool CompactLRU::concat(const std::string &key, const std::string &data, bool prepend){
+    entry *item = findEntry(key);
+    if (item == nullptr){
+        return false;
+    }
+    std::size_t old_size = item->size;
+    if (old_size + data.size() > _max_size || !resize(*item, old_size + data.size())){
+        return false;
+    }
+    char *value = static_cast<char *>(item->value.get());
+    if (prepend){
+        std::memmove(value + data.size(), value, old_size);
+        std::memcpy(value, data.data(), data.size());
+    } else {
+        std::memcpy(value + old_size, data.data(), data.size());
+    }
+    item->meta.cas = ++_last_cas;
+    compactSlice();
+    return true;
+}
+
+void CompactLRU::deleteEntry(entry &item){
+    _region.free(item.value);
+    _bytes -= item.key->size() + item.size;
+    unlink(item);
+    _index.erase(_index.find(*item.key));
+}
+
+void CompactLRU::compactSlice(){
+    if (_region.holes() > 0){
+        _region.defrag(DefragSlice);
+    }
+}
+
+void CompactLRU::linkTail(entry &item){
+    item.prev = _tail;
+    item.next = nullptr;
+    if (_tail != nullptr){
+        _tail->next = &item;
+    } else {
+        _head = &item;
+    }
+    _tail = &item;
+}
+
+void CompactLRU::unlink(entry &item){
+    if (item.prev != nullptr){
+        item.prev->next = item.next;
+    } else {
+        _head = item.next;
+    }
+    if (item.next != nullptr){
+        item.next->prev = item.prev;
+    } else {
+        _tail = item.prev;
+    }
+}
+
+bool CompactLRU::isExpired(const entry &item){
+    if (item.meta.expire == 0){
+        return false;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return item.meta.expire <= static_cast<uint32_t>(ts.tv_sec);
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,125 @@
+#ifndef AFINA_STORAGE_COMPACT_LRU_H
+#define AFINA_STORAGE_COMPACT_LRU_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include <afina/Storage.h>
+#include <afina/allocator/Pointer.h>
+#include <afina/allocator/Simple.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # LRU with values in one compacted region
+ * All values live in a single region of max_size bytes allocated up front and managed by Allocator::Simple,
+ * so memory taken by values never grows past it whatever their sizes are. Holes left by deleted and resized
+ * values are compacted a slice at a time after each write, when allocation fails anyway the region is
+ * compacted completely before anything gets evicted. Keys and index live on the heap.
+ *
+ * Values are moved by compaction, so Get copies them out.
+ * That is NOT thread safe implementaiton!!
+ */
+class CompactLRU : public Afina::Storage {
+public:
+    CompactLRU(size_t max_size = 1024 * 1024);
+    ~CompactLRU() {}
+
+    // Implements Afina::Storage interface
+    bool Put(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) override;
+
+    // Implements Afina::Storage interface
+    bool PutIfAbsent(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) override;
+
+    // Implements Afina::Storage interface
+    bool Set(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) override;
+
+    // Implements Afina::Storage interface
+    bool Delete(const std::string &key) override;
+
+    // Implements Afina::Storage interface
+    bool Get(const std::string &key, std::string &value) override;
+
+    // Implements Afina::Storage interface, value is a private copy
+    bool Get(const std::string &key, Value &value) override;
+
+    // Implements Afina::Storage interface, see Get above
+    bool Get(const std::string &key, Value &value, ItemMeta &meta) override;
+
+    // Implements Afina::Storage interface, value grows in place if the region has room right after it
+    bool Append(const std::string &key, const std::string &data) override;
+
+    // Implements Afina::Storage interface, see Append above
+    bool Prepend(const std::string &key, const std::string &data) override;
+
+    // Implements Afina::Storage interface: items, their bytes, evictions and bytes of holes in the region
+    void CollectStats(std::map<std::string, uint64_t> &stats) override;
+
+    /**
+     * Layout of the region, see Allocator::Simple::dump
+     */
+    std::string Dump() const { return _region.dump(); }
+
+private:
+    // Bytes of blocks compaction goes over after each write
+    static const std::size_t DefragSlice = 16 * 1024;
+
+    // Item, linked into the LRU list: head is the least recently used one
+    struct entry {
+        const std::string *key;
+        Allocator::Pointer value;
+        std::size_t size;
+        ItemMeta meta;
+        entry *prev;
+        entry *next;
+    };
+
+    // Finds live item and marks it as used recently, expired one is deleted
+    entry *findEntry(const std::string &key);
+
+    // Creates new item with the given value
+    bool addEntry(const std::string &key, const std::string &value, const ItemMeta &meta);
+
+    // Resizes value of the item to size bytes keeping min(size, old size) of them, compacting the region
+    // and evicting other items if needed. Item is deleted if it doesn't fit even into empty region
+    bool resize(entry &item, std::size_t size);
+
+    // Append and Prepend
+    bool concat(const std::string &key, const std::string &data, bool prepend);
+
+    // Deletes the item, its value is released
+    void deleteEntry(entry &item);
+
+    // Continues compaction of holes for a slice, see DefragSlice
+    void compactSlice();
+
+    void linkTail(entry &item);
+    void unlink(entry &item);
+
+    static bool isExpired(const entry &item);
+
+    size_t _max_size;
+
+    std::unique_ptr<char[]> _memory;
+    Allocator::Simple _region;
+
+    std::unordered_map<std::string, entry> _index;
+    entry *_head;
+    entry *_tail;
+
+    // See SimpleLRU::_last_cas
+    uint64_t _last_cas;
+
+    // See CollectStats
+    uint64_t _bytes;
+    uint64_t _evictions;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_COMPACT_LRU_H
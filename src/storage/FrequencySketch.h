@@ -0,0 +1,122 @@
+#ifndef AFINA_STORAGE_FREQUENCY_SKETCH_H
+#define AFINA_STORAGE_FREQUENCY_SKETCH_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Count-min sketch of access frequencies
+ * Estimates how often each key was requested recently using 4 bits per counter and a few bytes per key.
+ * Each key maps to 4 counters chosen by independent hash functions, estimation is the minimum of them, so
+ * collisions could only make it higher.
+ *
+ * Counters saturate at 15. Once number of increments reaches ten times the number of counters, all of
+ * them are halved, so that old popularity fades away and sketch follows the change of workload.
+ *
+ * That is NOT thread safe implementation!!
+ */
+class FrequencySketch {
+public:
+    // Maximum value of a counter
+    static const uint32_t MaxFrequency = 15;
+
+    FrequencySketch(std::size_t capacity = 16) : _table(1, 0), _bits(4), _additions(0), _sample_size(10) {
+        EnsureCapacity(capacity);
+    }
+
+    /**
+     * Grows sketch to count the given number of distinct keys accurately. Counters are indexed by high
+     * bits of hash, so each one splits into two on growth and both inherit its value: estimations stay
+     * the same until new accesses refine them
+     */
+    void EnsureCapacity(std::size_t capacity) {
+        while (_table.size() < capacity) {
+            grow();
+        }
+    }
+
+    /**
+     * Returns estimated frequency of the key with given hash, from 0 to MaxFrequency
+     */
+    uint32_t Frequency(std::size_t hash) const {
+        uint32_t frequency = MaxFrequency;
+        for (int i = 0; i < Depth; ++i) {
+            frequency = std::min(frequency, get(index(hash, i)));
+        }
+        return frequency;
+    }
+
+    /**
+     * Records one more access to the key with given hash
+     */
+    void Increment(std::size_t hash) {
+        bool changed = false;
+        for (int i = 0; i < Depth; ++i) {
+            std::size_t idx = index(hash, i);
+            if (get(idx) < MaxFrequency) {
+                _table[idx / CountersPerWord] += uint64_t(1) << (idx % CountersPerWord * 4);
+                changed = true;
+            }
+        }
+        if (changed && ++_additions >= _sample_size) {
+            age();
+        }
+    }
+
+    inline std::size_t MemoryUsage() const { return _table.size() * sizeof(uint64_t); }
+
+private:
+    static const int Depth = 4;
+    static const std::size_t CountersPerWord = 16;
+
+    // Odd multipliers of hash functions
+    static uint64_t seed(int i) {
+        static const uint64_t seeds[Depth] = {0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull,
+                                              0xD6E8FEB86659FD93ull};
+        return seeds[i];
+    }
+
+    // Multiplicative hashing takes high bits of the product, so that every bit of hash matters
+    inline std::size_t index(std::size_t hash, int i) const { return (uint64_t(hash) * seed(i)) >> (64 - _bits); }
+
+    inline uint32_t get(std::size_t idx) const {
+        return (_table[idx / CountersPerWord] >> (idx % CountersPerWord * 4)) & 0xF;
+    }
+
+    // Doubles number of counters
+    void grow() {
+        std::vector<uint64_t> table(_table.size() * 2, 0);
+        for (std::size_t idx = 0; idx < table.size() * CountersPerWord; ++idx) {
+            table[idx / CountersPerWord] |= uint64_t(get(idx / 2)) << (idx % CountersPerWord * 4);
+        }
+        _table.swap(table);
+        _bits++;
+        _sample_size = 10 * _table.size();
+    }
+
+    // Halves all counters at once
+    void age() {
+        for (auto &word : _table) {
+            word = (word >> 1) & 0x7777777777777777ull;
+        }
+        _additions /= 2;
+    }
+
+    // 16 counters of 4 bits in each word, one word per key of capacity
+    std::vector<uint64_t> _table;
+
+    // log2 of counters count
+    unsigned _bits;
+
+    std::size_t _additions;
+    std::size_t _sample_size;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_FREQUENCY_SKETCH_H
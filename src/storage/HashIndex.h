@@ -0,0 +1,271 @@
+#ifndef AFINA_STORAGE_HASH_INDEX_H
+#define AFINA_STORAGE_HASH_INDEX_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <afina/concurrency/Epoch.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Open addressing hash index
+ * Maps keys to nodes owned by somebody else (LRU list for example). Collisions are resolved by linear
+ * probing with Robin Hood displacement: every slot remembers how far it is from its home bucket, insert
+ * lets "poor" entries (far from home) take the place of "rich" ones, so lookup could stop as soon as it
+ * meets an entry closer to home than the searched key would be. Delete uses backward shift, so there are
+ * no tombstones and probe sequences never degrade over time.
+ *
+ * Each slot keeps 32 bits of the key hash next to node pointer. Keys are compared only if fingerprints
+ * match, so in common case lookup touches a single cache line of the index and one node.
+ *
+ * Node must provide `hash` member, computed by the same function as the one passed to Find, and
+ * `bool hasKey(const Key &)` method for each Key type Find is called with.
+ *
+ * That is NOT thread safe implementation!! The only exception is Find: with epoch set (see SetEpoch) it
+ * could run concurrently with a single writer. Such Find never crashes and returns either nullptr or a
+ * node that was in the index at some moment, but could miss a node while writer moves slots around, so
+ * caller has to validate misses (with a seqlock for example)
+ */
+template <typename Node> class HashIndex {
+public:
+    HashIndex(std::size_t capacity = 16) : _table(allocate(capacity)), _size(0), _epoch(nullptr) {}
+    ~HashIndex() { delete _table.load(std::memory_order_relaxed); }
+
+    /**
+     * Makes index to retire replaced tables through the given epoch instead of deleting them right away,
+     * so that concurrent Find never touches freed memory
+     */
+    void SetEpoch(Concurrency::Epoch *epoch) { _epoch = epoch; }
+
+    /**
+     * Returns node associated with the given key or nullptr if there is no such node
+     */
+    template <typename Key> Node *Find(const Key &key, std::size_t hash) const {
+        const Table *table = _table.load(std::memory_order_acquire);
+        uint32_t fp = fingerprint(hash);
+        std::size_t pos = table->home(hash);
+        // With concurrent writer slots could be seen in inconsistent state, so probing is bounded
+        for (uint32_t distance = 0; distance <= table->mask; ++distance) {
+            Entry entry = table->slots[pos].load();
+            if (entry.node == nullptr || entry.distance < distance) {
+                return nullptr;
+            }
+            if (entry.fingerprint == fp && entry.node->hasKey(key)) {
+                return entry.node;
+            }
+            pos = (pos + 1) & table->mask;
+        }
+        return nullptr;
+    }
+
+    /**
+     * Hints CPU to load the home slot of the hash, so that Find issued a bit later doesn't wait for
+     * memory. Batch lookups call it a few keys ahead
+     */
+    void PrefetchSlot(std::size_t hash) const {
+        const Table *table = _table.load(std::memory_order_acquire);
+        __builtin_prefetch(&table->slots[table->home(hash)]);
+    }
+
+    /**
+     * Hints CPU to load the node the home slot points to, which is the node Find compares the key with
+     * first. Meant to follow PrefetchSlot of the same hash once the slot is in cache. Pointer is only a
+     * hint, prefetch of a node being released is harmless
+     */
+    void PrefetchNode(std::size_t hash) const {
+        const Table *table = _table.load(std::memory_order_acquire);
+        Node *node = table->slots[table->home(hash)].node.load(std::memory_order_relaxed);
+        if (node != nullptr) {
+            __builtin_prefetch(node);
+        }
+    }
+
+    /**
+     * Adds node to the index. Node with the same key must not be in the index already
+     */
+    void Insert(Node *node) {
+        if (_size >= table().grow_at) {
+            rehash((table().mask + 1) * 2);
+        }
+        place(table(), Entry{node, fingerprint(node->hash), 0});
+        _size++;
+    }
+
+    /**
+     * Makes index point to the new node instead of old one, both must have the same key. Returns false
+     * if old node wasn't found
+     */
+    bool Replace(const Node *old_node, Node *new_node) {
+        std::size_t pos;
+        if (!locate(old_node, pos)) {
+            return false;
+        }
+        table().slots[pos].node.store(new_node, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Removes node from the index, returns false if there was no such node
+     */
+    bool Erase(const Node *node) {
+        std::size_t pos;
+        if (!locate(node, pos)) {
+            return false;
+        }
+
+        // Backward shift: pull following entries of the cluster one step closer to their homes
+        Table &t = table();
+        std::size_t next = (pos + 1) & t.mask;
+        Entry entry = t.slots[next].load();
+        while (entry.node != nullptr && entry.distance > 0) {
+            entry.distance--;
+            t.slots[pos].store(entry);
+            pos = next;
+            next = (next + 1) & t.mask;
+            entry = t.slots[next].load();
+        }
+        t.slots[pos].store(Entry{nullptr, 0, 0});
+        _size--;
+        return true;
+    }
+
+    /**
+     * Removes all nodes from the index. Must not run concurrently with Find
+     */
+    void Clear() {
+        _size = 0;
+        delete _table.exchange(allocate(16), std::memory_order_acq_rel);
+    }
+
+    inline std::size_t Size() const { return _size; }
+
+    inline std::size_t Capacity() const { return table().mask + 1; }
+
+    inline std::size_t MemoryUsage() const { return Capacity() * sizeof(Slot); }
+
+private:
+    // Content of the slot
+    struct Entry {
+        Node *node;
+        uint32_t fingerprint;
+        uint32_t distance;
+    };
+
+    // Slot of the table, 16 bytes so that 4 slots share the same cache line. Fields are atomic only to
+    // let concurrent Find read them, writer is the only one who changes slots
+    struct Slot {
+        std::atomic<Node *> node;
+        // fingerprint << 32 | distance
+        std::atomic<uint64_t> meta;
+
+        inline Entry load() const {
+            Node *n = node.load(std::memory_order_acquire);
+            uint64_t m = meta.load(std::memory_order_relaxed);
+            return Entry{n, static_cast<uint32_t>(m >> 32), static_cast<uint32_t>(m)};
+        }
+
+        // Node is published last, so reader that sees it sees the node content too
+        inline void store(const Entry &e) {
+            meta.store(uint64_t(e.fingerprint) << 32 | e.distance, std::memory_order_relaxed);
+            node.store(e.node, std::memory_order_release);
+        }
+    };
+
+    // Slots with their geometry, replaced as a whole on rehash
+    struct Table {
+        std::size_t mask;
+        std::size_t shift;
+        std::size_t grow_at;
+        std::unique_ptr<Slot[]> slots;
+
+        // Fibonacci hashing mixes all bits of hash, so keys of the same shard are spread evenly as well
+        inline std::size_t home(std::size_t hash) const { return (uint64_t(hash) * 0x9E3779B97F4A7C15ull) >> shift; }
+    };
+
+    // Fingerprint is taken from high bits of hash: low ones are used to choose shard in StripedLockLRU
+    static inline uint32_t fingerprint(std::size_t hash) { return static_cast<uint32_t>(uint64_t(hash) >> 32); }
+
+    static Table *allocate(std::size_t capacity) {
+        std::size_t bits = 4;
+        while ((std::size_t(1) << bits) < capacity) {
+            bits++;
+        }
+        Table *t = new Table;
+        t->slots.reset(new Slot[std::size_t(1) << bits]());
+        t->mask = (std::size_t(1) << bits) - 1;
+        t->shift = 64 - bits;
+        t->grow_at = (t->mask + 1) / 8 * 7;
+        return t;
+    }
+
+    static void deleteTable(void *p) { delete static_cast<Table *>(p); }
+
+    // Writer side access, the only thread that changes _table
+    inline Table &table() const { return *_table.load(std::memory_order_relaxed); }
+
+    // Finds slot pointing to the given node
+    bool locate(const Node *node, std::size_t &pos) const {
+        const Table &t = table();
+        pos = t.home(node->hash);
+        for (uint32_t distance = 0;; ++distance) {
+            Entry entry = t.slots[pos].load();
+            if (entry.node == nullptr || entry.distance < distance) {
+                return false;
+            }
+            if (entry.node == node) {
+                return true;
+            }
+            pos = (pos + 1) & t.mask;
+        }
+    }
+
+    static void place(Table &t, Entry entry) {
+        std::size_t pos = t.home(entry.node->hash);
+        for (;;) {
+            Entry cur = t.slots[pos].load();
+            if (cur.node == nullptr) {
+                t.slots[pos].store(entry);
+                return;
+            }
+            if (cur.distance < entry.distance) {
+                t.slots[pos].store(entry);
+                entry = cur;
+            }
+            pos = (pos + 1) & t.mask;
+            entry.distance++;
+        }
+    }
+
+    // New table is filled before it gets published, old one stays readable until nobody could use it
+    void rehash(std::size_t capacity) {
+        Table *old = _table.load(std::memory_order_relaxed);
+        Table *fresh = allocate(capacity);
+        for (std::size_t i = 0; i <= old->mask; ++i) {
+            Entry entry = old->slots[i].load();
+            if (entry.node != nullptr) {
+                entry.distance = 0;
+                place(*fresh, entry);
+            }
+        }
+        _table.store(fresh, std::memory_order_release);
+        if (_epoch != nullptr) {
+            _epoch->Retire(old, &HashIndex::deleteTable);
+        } else {
+            delete old;
+        }
+    }
+
+    std::atomic<Table *> _table;
+    std::size_t _size;
+    Concurrency::Epoch *_epoch;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_HASH_INDEX_H
@@ -0,0 +1,197 @@
+#include "LockFreeReadLRU.h"
+
+namespace Afina {
+namespace Backend {
+
+LockFreeReadLRU::LockFreeReadLRU(size_t max_size)
+    : SimpleLRU(max_size, IndexType::Hash, EvictionPolicy::Clock), _seq(0) {
+    enableConcurrentReads(&_epoch);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool LockFreeReadLRU::Put(const std::string &key, const std::string &value, const ItemMeta &meta) {
+    std::lock_guard<std::mutex> lock(_m);
+    WriteSection section(_seq);
+    return SimpleLRU::Put(key, value, meta);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool LockFreeReadLRU::PutIfAbsent(const std::string &key, const std::string &value, const ItemMeta &meta) {
+    std::lock_guard<std::mutex> lock(_m);
+    WriteSection section(_seq);
+    return SimpleLRU::PutIfAbsent(key, value, meta);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool LockFreeReadLRU::Put(const std::string &key, std::size_t hash, const std::string &value, const ItemMeta &meta) {
+    std::lock_guard<std::mutex> lock(_m);
+    WriteSection section(_seq);
+    return SimpleLRU::Put(key, hash, value, meta);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool LockFreeReadLRU::PutIfAbsent(const std::string &key, std::size_t hash, const std::string &value,
+                                  const ItemMeta &meta) {
+    std::lock_guard<std::mutex> lock(_m);
+    WriteSection section(_seq);
+    return SimpleLRU::PutIfAbsent(key, hash, value, meta);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool LockFreeReadLRU::Set(const std::string &key, const std::string &value, const ItemMeta &meta) {
+    std::lock_guard<std::mutex> lock(_m);
+    WriteSection section(_seq);
+    return SimpleLRU::Set(key, value, meta);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool LockFreeReadLRU::Delete(const std::string &key) {
+    std::lock_guard<std::mutex> lock(_m);
+    WriteSection section(_seq);
+    return SimpleLRU::Delete(key);
+}
+
+// See MapBasedGlobalLockImpl.h
+CasResult LockFreeReadLRU::CompareAndSet(const std::string &key, const std::string &value, const ItemMeta &meta,
+                                         uint64_t cas) {
+    std::lock_guard<std::mutex> lock(_m);
+    WriteSection section(_seq);
+    return SimpleLRU::CompareAndSet(key, value, meta, cas);
+}
+
+// See MapBasedGlobalLockImpl.h
+CasResult LockFreeReadLRU::CompareAndDelete(const std::string &key, uint64_t cas) {
+    std::lock_guard<std::mutex> lock(_m);
+    WriteSection section(_seq);
+    return SimpleLRU::CompareAndDelete(key, cas);
+}
+
+// See MapBasedGlobalLockImpl.h
+IncrResult LockFreeReadLRU::Increment(const std::string &key, uint64_t delta, uint64_t &result) {
+    std::lock_guard<std::mutex> lock(_m);
+    WriteSection section(_seq);
+    return SimpleLRU::Increment(key, delta, result);
+}
+
+// See MapBasedGlobalLockImpl.h
+IncrResult LockFreeReadLRU::Decrement(const std::string &key, uint64_t delta, uint64_t &result) {
+    std::lock_guard<std::mutex> lock(_m);
+    WriteSection section(_seq);
+    return SimpleLRU::Decrement(key, delta, result);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool LockFreeReadLRU::Append(const std::string &key, const std::string &data) {
+    std::lock_guard<std::mutex> lock(_m);
+    WriteSection section(_seq);
+    return SimpleLRU::Append(key, data);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool LockFreeReadLRU::Prepend(const std::string &key, const std::string &data) {
+    std::lock_guard<std::mutex> lock(_m);
+    WriteSection section(_seq);
+    return SimpleLRU::Prepend(key, data);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool LockFreeReadLRU::Get(const std::string &key, std::string &value) {
+    return get(key, value);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool LockFreeReadLRU::Get(const std::string &key, Value &value) {
+    return get(key, value);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool LockFreeReadLRU::Get(const std::string &key, Value &value, ItemMeta &meta) {
+    return get(key, value, meta);
+}
+
+// See LockFreeReadLRU.h
+void LockFreeReadLRU::GetBatch(const StringView *keys, const std::size_t *hashes, const std::vector<std::size_t> &pos,
+                               LookupResult *results) {
+    std::vector<std::size_t> locked;
+    {
+        Concurrency::Epoch::Guard guard(_epoch);
+        for (std::size_t i = 0; i < pos.size(); ++i) {
+            std::size_t k = pos[i];
+            if (!guard.active()) {
+                locked.push_back(k);
+                continue;
+            }
+            prefetchBatch(hashes, pos, i);
+            PeekResult result = PeekResult::Retry;
+            for (int attempt = 0; result == PeekResult::Retry && attempt < MaxReadAttempts; ++attempt) {
+                result = tryPeek(keys[k], hashes[k], results[k].value, results[k].meta);
+            }
+            if (result == PeekResult::Retry) {
+                locked.push_back(k);
+            } else {
+                results[k].found = result == PeekResult::Hit;
+            }
+        }
+    }
+
+    if (!locked.empty()) {
+        std::lock_guard<std::mutex> lock(_m);
+        SimpleLRU::GetBatch(keys, hashes, locked, results);
+    }
+}
+
+// See LockFreeReadLRU.h
+void LockFreeReadLRU::PutBatch(const std::vector<std::string> &keys, const std::vector<std::string> &values,
+                               const std::vector<ItemMeta> &metas, const std::vector<std::size_t> &hashes,
+                               const std::vector<std::size_t> &pos, std::vector<bool> &stored) {
+    std::lock_guard<std::mutex> lock(_m);
+    WriteSection section(_seq);
+    SimpleLRU::PutBatch(keys, values, metas, hashes, pos, stored);
+}
+
+// See SimpleLRU.h
+std::size_t LockFreeReadLRU::Reclaim(std::size_t bytes) {
+    std::unique_lock<std::mutex> lock(_m, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return 0;
+    }
+    WriteSection section(_seq);
+    return SimpleLRU::Reclaim(bytes);
+}
+
+template <typename... Out> bool LockFreeReadLRU::get(const std::string &key, Out &... out) {
+    std::size_t hash = hashOf(key);
+    {
+        Concurrency::Epoch::Guard guard(_epoch);
+        for (int attempt = 0; guard.active() && attempt < MaxReadAttempts; ++attempt) {
+            PeekResult result = tryPeek(key, hash, out...);
+            if (result != PeekResult::Retry) {
+                return result == PeekResult::Hit;
+            }
+        }
+    }
+
+    // Either too many writes or too many readers for epoch slots
+    std::lock_guard<std::mutex> lock(_m);
+    return SimpleLRU::Get(key, out...);
+}
+
+template <typename... Out>
+LockFreeReadLRU::PeekResult LockFreeReadLRU::tryPeek(const StringView &key, std::size_t hash, Out &... out) {
+    uint64_t seq = _seq.load(std::memory_order_acquire);
+    if (seq & 1) {
+        // Writer is in the middle of change
+        return PeekResult::Retry;
+    }
+    bool found = peek(key, hash, out...);
+    // Reference taken by peek must be visible to the writer checking whether it could reuse the value, or
+    // the writer's counter must be visible here, see SimpleLRU::isWritable
+    std::atomic_thread_fence(found ? std::memory_order_seq_cst : std::memory_order_acquire);
+    if (_seq.load(std::memory_order_relaxed) != seq) {
+        return PeekResult::Retry;
+    }
+    return found ? PeekResult::Hit : PeekResult::Miss;
+}
+
+} // namespace Backend
+} // namespace Afina
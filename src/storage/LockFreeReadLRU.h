@@ -0,0 +1,129 @@
+#ifndef AFINA_STORAGE_LOCK_FREE_READ_LRU_H
+#define AFINA_STORAGE_LOCK_FREE_READ_LRU_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <afina/concurrency/Epoch.h>
+
+#include "SimpleLRU.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # SimpleLRU thread safe version with lock free reads
+ * Writers are serialized by a lock, Get takes no lock at all. Always uses hash index and Clock policy, so
+ * that hit changes nothing but atomic mark of the item.
+ *
+ * Reader finds node in the index under epoch guard, so that nodes and index tables unlinked by writer are
+ * released only after reader is gone (see Concurrency::Epoch). Writer bumps sequence counter around each
+ * change, and reader retries if counter has changed: miss could be false while writer moves index slots,
+ * and hit could see value rewritten in place. Writer changes value in place only if nobody holds a handle
+ * to it, so once reader has its reference and counter is the same, the value it got stays intact. After a
+ * few failed attempts reader falls back to the lock
+ */
+class LockFreeReadLRU : public SimpleLRU {
+public:
+    LockFreeReadLRU(size_t max_size = 1024);
+    ~LockFreeReadLRU() {}
+
+    // see SimpleLRU.h
+    bool Put(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) override;
+
+    // see SimpleLRU.h
+    bool PutIfAbsent(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) override;
+
+    // see SimpleLRU.h
+    bool Put(const std::string &key, std::size_t hash, const std::string &value, const ItemMeta &meta) override;
+
+    // see SimpleLRU.h
+    bool PutIfAbsent(const std::string &key, std::size_t hash, const std::string &value,
+                     const ItemMeta &meta) override;
+
+    // see SimpleLRU.h
+    bool Set(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) override;
+
+    // see SimpleLRU.h
+    bool Delete(const std::string &key) override;
+
+    // see SimpleLRU.h
+    CasResult CompareAndSet(const std::string &key, const std::string &value, const ItemMeta &meta,
+                            uint64_t cas) override;
+
+    // see SimpleLRU.h
+    CasResult CompareAndDelete(const std::string &key, uint64_t cas) override;
+
+    // see SimpleLRU.h
+    IncrResult Increment(const std::string &key, uint64_t delta, uint64_t &result) override;
+
+    // see SimpleLRU.h
+    IncrResult Decrement(const std::string &key, uint64_t delta, uint64_t &result) override;
+
+    // see SimpleLRU.h
+    bool Append(const std::string &key, const std::string &data) override;
+
+    // see SimpleLRU.h
+    bool Prepend(const std::string &key, const std::string &data) override;
+
+    // see SimpleLRU.h
+    bool Get(const std::string &key, std::string &value) override;
+
+    // see SimpleLRU.h
+    bool Get(const std::string &key, Value &value) override;
+
+    // see SimpleLRU.h
+    bool Get(const std::string &key, Value &value, ItemMeta &meta) override;
+
+    // see SimpleLRU.h, the whole batch is looked up inside of one epoch guard, keys that need the lock get
+    // it once for all of them
+    void GetBatch(const StringView *keys, const std::size_t *hashes, const std::vector<std::size_t> &pos,
+                  LookupResult *results) override;
+
+    // see SimpleLRU.h
+    void PutBatch(const std::vector<std::string> &keys, const std::vector<std::string> &values,
+                  const std::vector<ItemMeta> &metas, const std::vector<std::size_t> &hashes,
+                  const std::vector<std::size_t> &pos, std::vector<bool> &stored) override;
+
+    // see SimpleLRU.h, returns 0 if the lock is busy
+    std::size_t Reclaim(std::size_t bytes) override;
+
+private:
+    // Number of optimistic lookups before reader takes the lock
+    static const int MaxReadAttempts = 4;
+
+    // Makes sequence counter odd for the time of write
+    class WriteSection {
+    public:
+        explicit WriteSection(std::atomic<uint64_t> &seq) : _seq(seq) {
+            _seq.store(_seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+        ~WriteSection() { _seq.store(_seq.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    private:
+        std::atomic<uint64_t> &_seq;
+    };
+
+    // Outcome of one optimistic lookup
+    enum class PeekResult { Hit, Miss, Retry };
+
+    // Optimistic lookup falling back to the lock, takes output parameters of one of Get overloads
+    template <typename... Out> bool get(const std::string &key, Out &... out);
+
+    // Single lookup attempt without lock, caller holds epoch guard. Retry means writer could have hidden
+    // the key
+    template <typename... Out> PeekResult tryPeek(const StringView &key, std::size_t hash, Out &... out);
+
+    std::mutex _m;
+    std::atomic<uint64_t> _seq;
+    Concurrency::Epoch _epoch;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_LOCK_FREE_READ_LRU_H
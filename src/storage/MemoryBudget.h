@@ -0,0 +1,149 @@
+#ifndef AFINA_STORAGE_MEMORY_BUDGET_H
+#define AFINA_STORAGE_MEMORY_BUDGET_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <time.h>
+#include <vector>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Bytes shared by several storages
+ * Storages (shards) take bytes from the common pool instead of having a fixed size each, so that a shard
+ * with hot keys could grow at the expense of the cold ones. Shard borrows a chunk at a time and keeps
+ * a bit of spare credit, so that the shared counter is touched once per many writes.
+ *
+ * Once pool is empty, shard that needs space asks the member with the oldest head of its list to give
+ * some bytes back, see Coldest. Member must provide:
+ * - `uint32_t ColdestStamp() const`, last access time of the item it would evict first, in Stamp units,
+ *   UINT32_MAX if it has no items. Called without any lock
+ * - `std::size_t Reclaim(std::size_t bytes)`, evicts items until the given number of bytes is free and
+ *   returns all spare bytes to the budget. Must not block: member locked by somebody else returns 0
+ *
+ * Members are registered before use and live as long as the budget.
+ *
+ * Budget could have a background reclaimer that keeps some bytes free, so that writers rarely have to evict
+ * anything themselves: writer which takes free bytes below the low watermark wakes it up, see WaitPressure.
+ */
+template <typename Member> class MemoryBudget {
+public:
+    MemoryBudget(std::size_t size, std::size_t chunk)
+        : _size(size), _chunk(std::max<std::size_t>(chunk, 1)), _free(size), _low_watermark(0) {}
+
+    void Join(Member *member) { _members.push_back(member); }
+
+    inline std::size_t Size() const { return _size; }
+
+    inline std::size_t Chunk() const { return _chunk; }
+
+    inline std::size_t Free() const { return _free.load(std::memory_order_relaxed); }
+
+    inline const std::vector<Member *> &Members() const { return _members; }
+
+    /**
+     * Takes at least the given number of bytes from the pool, a whole chunk if there is one. Returns number
+     * of bytes taken, 0 if pool has less than requested
+     */
+    std::size_t Borrow(std::size_t bytes) {
+        std::size_t free = _free.load(std::memory_order_relaxed);
+        for (;;) {
+            if (free < bytes) {
+                return 0;
+            }
+            std::size_t take = std::min(free, std::max(bytes, _chunk));
+            if (_free.compare_exchange_weak(free, free - take, std::memory_order_relaxed)) {
+                if (free >= _low_watermark && free - take < _low_watermark) {
+                    _pressure.notify_one();
+                }
+                return take;
+            }
+        }
+    }
+
+    /**
+     * Puts bytes back to the pool
+     */
+    void Return(std::size_t bytes) { _free.fetch_add(bytes, std::memory_order_relaxed); }
+
+    /**
+     * Writers crossing the given number of free bytes wake up the reclaimer, 0 means there is no reclaimer.
+     * Must be set before use
+     */
+    void SetLowWatermark(std::size_t bytes) { _low_watermark = bytes; }
+
+    inline std::size_t LowWatermark() const { return _low_watermark; }
+
+    /**
+     * Reclaimer side: waits until free bytes drop below the low watermark, Wake is called or timeout expires.
+     * Wakeup of the writer could be missed as it doesn't take the mutex, so reclaimer should use timeout and
+     * check Free() on its own
+     */
+    void WaitPressure(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(_pressure_mutex);
+        if (Free() >= _low_watermark) {
+            _pressure.wait_for(lock, timeout);
+        }
+    }
+
+    /**
+     * Wakes up reclaimer waiting in WaitPressure
+     */
+    void Wake() {
+        std::lock_guard<std::mutex> lock(_pressure_mutex);
+        _pressure.notify_all();
+    }
+
+    /**
+     * Returns member other than the given one with the oldest item, nullptr if no one has items. Stamps are
+     * compared by age, so that wrap around of the clock doesn't matter
+     */
+    Member *Coldest(const Member *except) const {
+        uint32_t now = Stamp();
+        Member *coldest = nullptr;
+        uint32_t max_age = 0;
+        for (Member *member : _members) {
+            uint32_t stamp = member->ColdestStamp();
+            if (member == except || stamp == UINT32_MAX) {
+                continue;
+            }
+            uint32_t age = now - stamp;
+            if (coldest == nullptr || age > max_age) {
+                coldest = member;
+                max_age = age;
+            }
+        }
+        return coldest;
+    }
+
+    /**
+     * Coarse clock for access stamps, milliseconds. Reading it costs a few nanoseconds
+     */
+    static uint32_t Stamp() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+        return static_cast<uint32_t>(uint64_t(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000);
+    }
+
+private:
+    const std::size_t _size;
+    const std::size_t _chunk;
+    std::atomic<std::size_t> _free;
+    std::vector<Member *> _members;
+
+    // See WaitPressure
+    std::size_t _low_watermark;
+    std::mutex _pressure_mutex;
+    std::condition_variable _pressure;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_MEMORY_BUDGET_H
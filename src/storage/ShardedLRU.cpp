@@ -0,0 +1,153 @@
+#include "ShardedLRU.h"
+
+#include <stdexcept>
+
+namespace Afina {
+namespace Backend {
+
+ShardedLRU::ShardedLRU(std::size_t max_size, std::size_t n_shards, IndexType index_type, EvictionPolicy policy) {
+    if (n_shards == 0 || max_size / n_shards < 1024 * 1024) {
+        throw std::runtime_error("STORAGE CREATION ERROR: too many shards");
+    }
+    for (std::size_t i = 0; i < n_shards; ++i) {
+        _shards.emplace_back(new SimpleLRU(max_size / n_shards, index_type, policy));
+    }
+}
+
+// See MapBasedGlobalLockImpl.h
+bool ShardedLRU::Put(const std::string &key, const std::string &value, const ItemMeta &meta) {
+    return shard(key).Put(key, value, meta);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool ShardedLRU::PutIfAbsent(const std::string &key, const std::string &value, const ItemMeta &meta) {
+    return shard(key).PutIfAbsent(key, value, meta);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool ShardedLRU::Put(const std::string &key, std::size_t hash, const std::string &value, const ItemMeta &meta) {
+    return _shards[ShardOf(hash)]->Put(key, hash, value, meta);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool ShardedLRU::PutIfAbsent(const std::string &key, std::size_t hash, const std::string &value,
+                             const ItemMeta &meta) {
+    return _shards[ShardOf(hash)]->PutIfAbsent(key, hash, value, meta);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool ShardedLRU::Set(const std::string &key, const std::string &value, const ItemMeta &meta) {
+    return shard(key).Set(key, value, meta);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool ShardedLRU::Delete(const std::string &key) { return shard(key).Delete(key); }
+
+// See MapBasedGlobalLockImpl.h
+bool ShardedLRU::Get(const std::string &key, std::string &value) { return shard(key).Get(key, value); }
+
+// See MapBasedGlobalLockImpl.h
+bool ShardedLRU::Get(const std::string &key, Value &value) { return shard(key).Get(key, value); }
+
+// See MapBasedGlobalLockImpl.h
+bool ShardedLRU::Get(const std::string &key, Value &value, ItemMeta &meta) {
+    return shard(key).Get(key, value, meta);
+}
+
+// See MapBasedGlobalLockImpl.h
+CasResult ShardedLRU::CompareAndSet(const std::string &key, const std::string &value, const ItemMeta &meta,
+                                    uint64_t cas) {
+    return shard(key).CompareAndSet(key, value, meta, cas);
+}
+
+// See MapBasedGlobalLockImpl.h
+CasResult ShardedLRU::CompareAndDelete(const std::string &key, uint64_t cas) {
+    return shard(key).CompareAndDelete(key, cas);
+}
+
+// See MapBasedGlobalLockImpl.h
+IncrResult ShardedLRU::Increment(const std::string &key, uint64_t delta, uint64_t &result) {
+    return shard(key).Increment(key, delta, result);
+}
+
+// See MapBasedGlobalLockImpl.h
+IncrResult ShardedLRU::Decrement(const std::string &key, uint64_t delta, uint64_t &result) {
+    return shard(key).Decrement(key, delta, result);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool ShardedLRU::Append(const std::string &key, const std::string &data) { return shard(key).Append(key, data); }
+
+// See MapBasedGlobalLockImpl.h
+bool ShardedLRU::Prepend(const std::string &key, const std::string &data) { return shard(key).Prepend(key, data); }
+
+// See MapBasedGlobalLockImpl.h
+void ShardedLRU::GetMany(const std::vector<std::string> &keys, std::vector<LookupResult> &results) {
+    std::vector<std::size_t> hashes(keys.size());
+    for (std::size_t k = 0; k < keys.size(); ++k) {
+        hashes[k] = KeyHash(keys[k]);
+    }
+    GetMany(keys, hashes, results);
+}
+
+// See MapBasedGlobalLockImpl.h
+void ShardedLRU::GetMany(const std::vector<std::string> &keys, const std::vector<std::size_t> &hashes,
+                         std::vector<LookupResult> &results) {
+    std::vector<StringView> views(keys.begin(), keys.end());
+    GetMany(views, hashes, results);
+}
+
+// See MapBasedGlobalLockImpl.h
+void ShardedLRU::GetMany(const std::vector<StringView> &keys, const std::vector<std::size_t> &hashes,
+                         std::vector<LookupResult> &results) {
+    results.clear();
+    results.resize(keys.size());
+    GetMany(keys.data(), hashes.data(), keys.size(), results.data());
+}
+
+// See MapBasedGlobalLockImpl.h
+void ShardedLRU::GetMany(const StringView *keys, const std::size_t *hashes, std::size_t count,
+                         LookupResult *results) {
+    std::vector<std::vector<std::size_t>> by_shard;
+    groupByShard(hashes, count, by_shard);
+    for (std::size_t i = 0; i < _shards.size(); ++i) {
+        if (!by_shard[i].empty()) {
+            _shards[i]->GetBatch(keys, hashes, by_shard[i], results);
+        }
+    }
+}
+
+// See MapBasedGlobalLockImpl.h
+void ShardedLRU::PutMany(const std::vector<std::string> &keys, const std::vector<std::string> &values,
+                         const std::vector<ItemMeta> &metas, std::vector<bool> &stored) {
+    std::vector<std::size_t> hashes(keys.size());
+    for (std::size_t k = 0; k < keys.size(); ++k) {
+        hashes[k] = KeyHash(keys[k]);
+    }
+    std::vector<std::vector<std::size_t>> by_shard;
+    groupByShard(hashes.data(), hashes.size(), by_shard);
+    stored.assign(keys.size(), false);
+    for (std::size_t i = 0; i < _shards.size(); ++i) {
+        if (!by_shard[i].empty()) {
+            _shards[i]->PutBatch(keys, values, metas, hashes, by_shard[i], stored);
+        }
+    }
+}
+
+// See MapBasedGlobalLockImpl.h
+void ShardedLRU::CollectStats(std::map<std::string, uint64_t> &stats) {
+    for (auto &shard : _shards) {
+        shard->CollectStats(stats);
+    }
+}
+
+void ShardedLRU::groupByShard(const std::size_t *hashes, std::size_t count,
+                              std::vector<std::vector<std::size_t>> &by_shard) const {
+    by_shard.assign(_shards.size(), std::vector<std::size_t>());
+    for (std::size_t k = 0; k < count; ++k) {
+        by_shard[ShardOf(hashes[k])].push_back(k);
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
@@ -0,0 +1,120 @@
+#ifndef AFINA_STORAGE_SHARDED_LRU_H
+#define AFINA_STORAGE_SHARDED_LRU_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <afina/ShardedStorage.h>
+
+#include "SimpleLRU.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # SimpleLRU shards for shard-per-thread execution
+ * Keys are spread over independent SimpleLRU shards the same way StripedLockLRU does it, but shards have
+ * no locks at all. Safe to use from many threads only if each shard is accessed by one thread at a time,
+ * see ShardedStorage
+ */
+class ShardedLRU : public Afina::ShardedStorage {
+public:
+    using IndexType = SimpleLRU::IndexType;
+    using EvictionPolicy = SimpleLRU::EvictionPolicy;
+
+    ShardedLRU(std::size_t max_size = 1024 * 1024 * 8, std::size_t n_shards = 4, IndexType index_type = IndexType::Map,
+               EvictionPolicy policy = EvictionPolicy::LRU);
+    ~ShardedLRU() {}
+
+    // See ShardedStorage.h
+    std::size_t ShardsCount() const override { return _shards.size(); }
+
+    // See ShardedStorage.h
+    using ShardedStorage::ShardOf;
+    std::size_t ShardOf(std::size_t hash) const override { return hash % _shards.size(); }
+
+    // see SimpleLRU.h
+    bool Put(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) override;
+
+    // see SimpleLRU.h
+    bool PutIfAbsent(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) override;
+
+    // see SimpleLRU.h
+    bool Put(const std::string &key, std::size_t hash, const std::string &value, const ItemMeta &meta) override;
+
+    // see SimpleLRU.h
+    bool PutIfAbsent(const std::string &key, std::size_t hash, const std::string &value,
+                     const ItemMeta &meta) override;
+
+    // see SimpleLRU.h
+    bool Set(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) override;
+
+    // see SimpleLRU.h
+    bool Delete(const std::string &key) override;
+
+    // see SimpleLRU.h
+    bool Get(const std::string &key, std::string &value) override;
+
+    // see SimpleLRU.h
+    bool Get(const std::string &key, Value &value) override;
+
+    // see SimpleLRU.h
+    bool Get(const std::string &key, Value &value, ItemMeta &meta) override;
+
+    // see SimpleLRU.h
+    CasResult CompareAndSet(const std::string &key, const std::string &value, const ItemMeta &meta,
+                            uint64_t cas) override;
+
+    // see SimpleLRU.h
+    CasResult CompareAndDelete(const std::string &key, uint64_t cas) override;
+
+    // see SimpleLRU.h
+    IncrResult Increment(const std::string &key, uint64_t delta, uint64_t &result) override;
+
+    // see SimpleLRU.h
+    IncrResult Decrement(const std::string &key, uint64_t delta, uint64_t &result) override;
+
+    // see SimpleLRU.h
+    bool Append(const std::string &key, const std::string &data) override;
+
+    // see SimpleLRU.h
+    bool Prepend(const std::string &key, const std::string &data) override;
+
+    // see SimpleLRU.h, each shard gets its part of the batch at once
+    void GetMany(const std::vector<std::string> &keys, std::vector<LookupResult> &results) override;
+
+    // see GetMany
+    void GetMany(const std::vector<std::string> &keys, const std::vector<std::size_t> &hashes,
+                 std::vector<LookupResult> &results) override;
+
+    // see GetMany
+    void GetMany(const std::vector<StringView> &keys, const std::vector<std::size_t> &hashes,
+                 std::vector<LookupResult> &results) override;
+
+    // see GetMany
+    void GetMany(const StringView *keys, const std::size_t *hashes, std::size_t count,
+                 LookupResult *results) override;
+
+    // see GetMany
+    void PutMany(const std::vector<std::string> &keys, const std::vector<std::string> &values,
+                 const std::vector<ItemMeta> &metas, std::vector<bool> &stored) override;
+
+    // see SimpleLRU.h, counters of shards are atomic, so any thread could collect them
+    void CollectStats(std::map<std::string, uint64_t> &stats) override;
+
+private:
+    // Splits positions of keys by shards, keeps relative order of keys
+    void groupByShard(const std::size_t *hashes, std::size_t count,
+                      std::vector<std::vector<std::size_t>> &by_shard) const;
+
+    inline SimpleLRU &shard(const std::string &key) { return *_shards[ShardOf(key)]; }
+
+    // Shards hash keys by the same function, see SimpleLRU::hashOf, so hashes are passed to them as is
+    std::vector<std::unique_ptr<SimpleLRU>> _shards;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_SHARDED_LRU_H
@@ -1,148 +1,841 @@
 #include "SimpleLRU.h"
+#include <afina/allocator/Slab.h>
+
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <time.h>
 
 namespace Afina {
 namespace Backend {
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Put(const std::string &key, const std::string &value) { 
+bool SimpleLRU::Put(const std::string &key, const std::string &value, const ItemMeta &meta) {
+    return put(key, hashOf(key), value, meta);
+}
+
+bool SimpleLRU::put(const std::string &key, std::size_t hash, const std::string &value, const ItemMeta &meta) {
     std::size_t put_size = key.size() + value.size();
     if (put_size > _max_size){
-        return false; 
+        return false;
     }
-    auto it = _lru_index.find(key);
-    if (it == _lru_index.end()){
-        while (put_size > _cur_available){
-            deleteOneFromHead();
-        }
-        addNode(key, value);
+    expireItems();
+    recordAccess(hash);
+    lru_node *node = findNode(key, hash);
+    if (node == nullptr){
+        reserve(put_size);
+        addNode(key, value, hash, meta);
         return true;
     } else {
-        changeValue(it->second.get(), value);
+        changeValue(*node, value, meta);
         return true;
     }
 }
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::PutIfAbsent(const std::string &key, const std::string &value) { 
+bool SimpleLRU::PutIfAbsent(const std::string &key, const std::string &value, const ItemMeta &meta) {
+    return putIfAbsent(key, hashOf(key), value, meta);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Put(const std::string &key, std::size_t hash, const std::string &value, const ItemMeta &meta) {
+    return put(key, hash, value, meta);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::PutIfAbsent(const std::string &key, std::size_t hash, const std::string &value,
+                            const ItemMeta &meta) {
+    return putIfAbsent(key, hash, value, meta);
+}
+
+bool SimpleLRU::putIfAbsent(const std::string &key, std::size_t hash, const std::string &value,
+                            const ItemMeta &meta) {
     std::size_t put_size = key.size() + value.size();
     if (put_size > _max_size){
         return false;
     }
-    if (_lru_index.find(key) != _lru_index.end()){
+    expireItems();
+    recordAccess(hash);
+    if (findNode(key, hash) != nullptr){
         return false;
     }
-    while (put_size > _cur_available){
-        deleteOneFromHead();
-    }
-    addNode(key, value);
+    reserve(put_size);
+    addNode(key, value, hash, meta);
     return true;
 }
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Set(const std::string &key, const std::string &value) { 
+bool SimpleLRU::Set(const std::string &key, const std::string &value, const ItemMeta &meta) {
     if (key.size() + value.size() > _max_size){
         return false;
     }
-    auto it = _lru_index.find(key);
-    if (it == _lru_index.end()){
+    expireItems();
+    std::size_t hash = hashOf(key);
+    recordAccess(hash);
+    lru_node *node = findNode(key, hash);
+    if (node == nullptr){
         return false;
     }
-    changeValue(it->second.get(), value);
+    changeValue(*node, value, meta);
     return true;
 }
 
 // See MapBasedGlobalLockImpl.h
 bool SimpleLRU::Delete(const std::string &key) {
-    auto it = _lru_index.find(key);
-    if (it == _lru_index.end()){
+    expireItems();
+    lru_node *node = findNode(key, hashOf(key));
+    if (node == nullptr){
         return false;
     }
-    lru_node& node = it->second.get();
-    if (node.prev == nullptr){
-        deleteOneFromHead();
-    } else {
-        _lru_index.erase(it);
-        _cur_available += key.size() + node.value.size();
-        if (node.next == nullptr){
-            _lru_tail = node.prev;
-            _lru_tail->next.reset();
-        } else {
-            node.next->prev = node.prev;
-            node.prev->next = std::move(node.next);
-        }
+    deleteNode(*node);
+    returnCredit();
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Get(const std::string &key, std::string &value) {
+    lru_node *node = lookupNode(key, hashOf(key));
+    if (node == nullptr){
+        return false;
     }
+    value.assign(node->value(), node->value_size);
     return true;
 }
 
 // See MapBasedGlobalLockImpl.h
-bool SimpleLRU::Get(const std::string &key, std::string &value) { 
-    auto it = _lru_index.find(key);
-    if (it == _lru_index.end()){
+bool SimpleLRU::Get(const std::string &key, Value &value) {
+    lru_node *node = lookupNode(key, hashOf(key));
+    if (node == nullptr){
+        return false;
+    }
+    value = Value(node, node->value(), node->value_size);
+    return true;
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Get(const std::string &key, Value &value, ItemMeta &meta) {
+    lru_node *node = lookupNode(key, hashOf(key));
+    if (node == nullptr){
         return false;
     }
-    value = it->second.get().value;
-    moveToTail(it->second.get());
+    value = Value(node, node->value(), node->value_size);
+    meta = ItemMeta(node->flags, node->expire, node->cas);
     return true;
 }
 
-void SimpleLRU::addNode(const std::string& key, const std::string& value){
-    lru_node* node = new lru_node {key, value, nullptr, nullptr};
-    if (_lru_head != nullptr){
-        node->prev = _lru_tail;
-        _lru_tail->next.reset(node);
-        _lru_tail = node;
+// See MapBasedGlobalLockImpl.h
+CasResult SimpleLRU::CompareAndSet(const std::string &key, const std::string &value, const ItemMeta &meta,
+                                   uint64_t cas) {
+    if (key.size() + value.size() > _max_size){
+        return CasResult::NotStored;
+    }
+    expireItems();
+    std::size_t hash = hashOf(key);
+    recordAccess(hash);
+    lru_node *node = findNode(key, hash);
+    if (node == nullptr){
+        return CasResult::NotFound;
+    }
+    if (node->cas != cas){
+        return CasResult::Exists;
+    }
+    changeValue(*node, value, meta);
+    return CasResult::Stored;
+}
+
+// See MapBasedGlobalLockImpl.h
+CasResult SimpleLRU::CompareAndDelete(const std::string &key, uint64_t cas) {
+    expireItems();
+    lru_node *node = findNode(key, hashOf(key));
+    if (node == nullptr){
+        return CasResult::NotFound;
+    }
+    if (node->cas != cas){
+        return CasResult::Exists;
+    }
+    deleteNode(*node);
+    returnCredit();
+    return CasResult::Stored;
+}
+
+// See MapBasedGlobalLockImpl.h
+IncrResult SimpleLRU::Increment(const std::string &key, uint64_t delta, uint64_t &result) {
+    return addNumber(key, delta, false, result);
+}
+
+// See MapBasedGlobalLockImpl.h
+IncrResult SimpleLRU::Decrement(const std::string &key, uint64_t delta, uint64_t &result) {
+    return addNumber(key, delta, true, result);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Append(const std::string &key, const std::string &data) {
+    return concat(key, data, false);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool SimpleLRU::Prepend(const std::string &key, const std::string &data) {
+    return concat(key, data, true);
+}
+
+// See MapBasedGlobalLockImpl.h
+void SimpleLRU::GetMany(const std::vector<std::string> &keys, std::vector<LookupResult> &results) {
+    std::vector<std::size_t> hashes(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i){
+        hashes[i] = hashOf(keys[i]);
+    }
+    GetMany(keys, hashes, results);
+}
+
+// See MapBasedGlobalLockImpl.h
+void SimpleLRU::GetMany(const std::vector<std::string> &keys, const std::vector<std::size_t> &hashes,
+                        std::vector<LookupResult> &results) {
+    std::vector<StringView> views(keys.begin(), keys.end());
+    GetMany(views, hashes, results);
+}
+
+// See MapBasedGlobalLockImpl.h
+void SimpleLRU::GetMany(const std::vector<StringView> &keys, const std::vector<std::size_t> &hashes,
+                        std::vector<LookupResult> &results) {
+    results.clear();
+    results.resize(keys.size());
+    GetMany(keys.data(), hashes.data(), keys.size(), results.data());
+}
+
+// See MapBasedGlobalLockImpl.h
+void SimpleLRU::GetMany(const StringView *keys, const std::size_t *hashes, std::size_t count,
+                        LookupResult *results) {
+    std::vector<std::size_t> pos(count);
+    for (std::size_t i = 0; i < count; ++i){
+        pos[i] = i;
+    }
+    GetBatch(keys, hashes, pos, results);
+}
+
+// See MapBasedGlobalLockImpl.h
+void SimpleLRU::PutMany(const std::vector<std::string> &keys, const std::vector<std::string> &values,
+                        const std::vector<ItemMeta> &metas, std::vector<bool> &stored) {
+    std::vector<std::size_t> hashes(keys.size());
+    std::vector<std::size_t> pos(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i){
+        hashes[i] = hashOf(keys[i]);
+        pos[i] = i;
+    }
+    stored.assign(keys.size(), false);
+    PutBatch(keys, values, metas, hashes, pos, stored);
+}
+
+// See SimpleLRU.h
+void SimpleLRU::GetBatch(const StringView *keys, const std::size_t *hashes, const std::vector<std::size_t> &pos,
+                         LookupResult *results) {
+    for (std::size_t i = 0; i < pos.size(); ++i){
+        prefetchBatch(hashes, pos, i);
+        std::size_t k = pos[i];
+        lru_node *node = lookupNode(keys[k], hashes[k]);
+        if (node == nullptr){
+            continue;
+        }
+        results[k].found = true;
+        results[k].value = Value(node, node->value(), node->value_size);
+        results[k].meta = ItemMeta(node->flags, node->expire, node->cas);
+    }
+}
+
+// See SimpleLRU.h
+void SimpleLRU::PutBatch(const std::vector<std::string> &keys, const std::vector<std::string> &values,
+                         const std::vector<ItemMeta> &metas, const std::vector<std::size_t> &hashes,
+                         const std::vector<std::size_t> &pos, std::vector<bool> &stored) {
+    for (std::size_t i = 0; i < pos.size(); ++i){
+        prefetchBatch(hashes.data(), pos, i);
+        std::size_t k = pos[i];
+        stored[k] = put(keys[k], hashes[k], values[k], metas[k]);
+    }
+}
+
+// See SimpleLRU.h
+void SimpleLRU::prefetchBatch(const std::size_t *hashes, const std::vector<std::size_t> &pos,
+                              std::size_t i) const {
+    if (_index_type != IndexType::Hash){
+        return;
+    }
+    if (i == 0){
+        for (std::size_t j = 0; j < PrefetchDistance && j < pos.size(); ++j){
+            _hash_index.PrefetchSlot(hashes[pos[j]]);
+        }
+    }
+    if (i + PrefetchDistance < pos.size()){
+        _hash_index.PrefetchSlot(hashes[pos[i + PrefetchDistance]]);
+    }
+    // Slot of the key half way ahead was requested a few steps ago and is likely in cache by now
+    if (i + PrefetchDistance / 2 < pos.size()){
+        _hash_index.PrefetchNode(hashes[pos[i + PrefetchDistance / 2]]);
+    }
+}
+
+// See SimpleLRU.h
+void SimpleLRU::enableConcurrentReads(Concurrency::Epoch *epoch) {
+    if (_index_type != IndexType::Hash || _policy != EvictionPolicy::Clock){
+        throw std::runtime_error("Concurrent reads require hash index and clock policy");
+    }
+    _epoch = epoch;
+    _hash_index.SetEpoch(epoch);
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::peek(const StringView &key, std::size_t hash, Value &value) {
+    lru_node *node = peekNode(key, hash);
+    if (node == nullptr){
+        return false;
+    }
+    // Node is unlinked but alive while reader is inside of epoch, list reference is still there
+    value = Value(node, node->value(), node->value_size);
+    return true;
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::peek(const StringView &key, std::size_t hash, std::string &value) {
+    lru_node *node = peekNode(key, hash);
+    if (node == nullptr){
+        return false;
+    }
+    value.assign(node->value(), node->value_size);
+    return true;
+}
+
+// See SimpleLRU.h
+bool SimpleLRU::peek(const StringView &key, std::size_t hash, Value &value, ItemMeta &meta) {
+    lru_node *node = peekNode(key, hash);
+    if (node == nullptr){
+        return false;
+    }
+    value = Value(node, node->value(), node->value_size);
+    meta = ItemMeta(node->flags, node->expire, node->cas);
+    return true;
+}
+
+// See SimpleLRU.h
+std::size_t SimpleLRU::ItemOverhead() const {
+    std::size_t overhead = sizeof(lru_node);
+    std::size_t items = 0;
+    if (_index_type == IndexType::Hash){
+        items = std::max<std::size_t>(_hash_index.Size(), 1);
+        overhead += _hash_index.MemoryUsage() / items;
     } else {
-        node->prev = nullptr;
-        _lru_tail = node;
-        _lru_head.reset(node);
+        items = std::max<std::size_t>(_lru_index.size(), 1);
+        // Red-black tree node: color, parent, left and right links followed by the value
+        overhead += 4 * sizeof(void *) + sizeof(decltype(_lru_index)::value_type);
+    }
+    if (_policy == EvictionPolicy::TinyLFU){
+        overhead += _sketch.MemoryUsage() / items;
     }
+    return overhead;
+}
+
+SimpleLRU::lru_node *SimpleLRU::allocNode(const char *key, std::size_t key_size, const std::string &value,
+                                          std::size_t hash, const ItemMeta &meta){
+    lru_node *node = allocNode(key, key_size, value.size(), value.size(), hash, meta);
+    std::memcpy(node->value(), value.data(), value.size());
+    return node;
+}
+
+SimpleLRU::lru_node *SimpleLRU::allocNode(const char *key, std::size_t key_size, std::size_t value_size,
+                                          std::size_t capacity, std::size_t hash, const ItemMeta &meta){
+    // Block of the size class could be larger than requested, the rest is left for the value to grow
+    std::size_t size = Allocator::Slab::UsableSize(sizeof(lru_node) + key_size + capacity);
+    capacity = std::min<std::size_t>(size - sizeof(lru_node) - key_size, UINT32_MAX);
+    lru_node *node = new (Allocator::Slab::Default().Allocate(size)) lru_node;
+    node->refs.store(1, std::memory_order_relaxed);
+    node->destroy = &SimpleLRU::destroyNode;
+    node->TimerWheel::Hook::prev = nullptr;
+    node->TimerWheel::Hook::next = nullptr;
+    node->expire = meta.expire;
+    node->flags = meta.flags;
+    node->cas = 0;
+    node->prev = nullptr;
+    node->next = nullptr;
+    node->hash = hash;
+    node->key_size = key_size;
+    node->value_size = value_size;
+    node->capacity = capacity;
+    node->referenced.store(false, std::memory_order_relaxed);
+    node->segment = Main;
+    std::memcpy(node->key(), key, key_size);
+    return node;
+}
+
+void SimpleLRU::releaseNode(lru_node *node){
+    if (node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1){
+        destroyNode(node);
+    }
+}
+
+void SimpleLRU::destroyNode(Value::Buffer *buffer){
+    lru_node *node = static_cast<lru_node *>(buffer);
+    std::size_t size = sizeof(lru_node) + node->key_size + node->capacity;
+    node->~lru_node();
+    Allocator::Slab::Release(node, size);
+}
+
+void SimpleLRU::releaseRetired(void *node){
+    releaseNode(static_cast<lru_node *>(node));
+}
+
+void SimpleLRU::retireNode(lru_node &node){
+    if (_epoch != nullptr){
+        _epoch->Retire(&node, &SimpleLRU::releaseRetired);
+    } else {
+        releaseNode(&node);
+    }
+}
+
+SimpleLRU::lru_node *SimpleLRU::findNode(const StringView &key, std::size_t hash){
+    if (_index_type == IndexType::Hash){
+        return _hash_index.Find(key, hash);
+    }
+    auto it = _lru_index.find(key_ref{hash, key.data(), key.size()});
+    if (it == _lru_index.end()){
+        return nullptr;
+    }
+    return it->second;
+}
+
+SimpleLRU::lru_node *SimpleLRU::lookupNode(const StringView &key, std::size_t hash){
+    recordAccess(hash);
+    lru_node *node = findNode(key, hash);
+    if (node == nullptr || isExpired(*node)){
+        return nullptr;
+    }
+    touchNode(*node);
+    return node;
+}
+
+SimpleLRU::lru_node *SimpleLRU::peekNode(const StringView &key, std::size_t hash){
+    lru_node *node = _hash_index.Find(key, hash);
+    if (node == nullptr || isExpired(*node)){
+        return nullptr;
+    }
+    touchNode(*node);
+    return node;
+}
+
+uint32_t SimpleLRU::now(){
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return static_cast<uint32_t>(ts.tv_sec);
+}
+
+bool SimpleLRU::isExpired(const lru_node &node){
+    // Clock is read only for items that could expire at all
+    return node.expire != 0 && node.expire <= now();
+}
+
+void SimpleLRU::expireItems(){
+    _timers.Advance(now(), [this](TimerWheel::Hook &hook){
+        deleteNode(static_cast<lru_node &>(hook));
+    });
+    returnCredit();
+}
+
+void SimpleLRU::indexNode(lru_node &node){
+    if (_index_type == IndexType::Hash){
+        _hash_index.Insert(&node);
+    } else {
+        _lru_index.insert(std::make_pair(key_ref{node.hash, node.key(), node.key_size}, &node));
+    }
+}
+
+void SimpleLRU::unindexNode(lru_node &node){
+    if (_index_type == IndexType::Hash){
+        _hash_index.Erase(&node);
+    } else {
+        _lru_index.erase(key_ref{node.hash, node.key(), node.key_size});
+    }
+}
+
+void SimpleLRU::addNode(const std::string& key, const std::string& value, std::size_t hash, const ItemMeta &meta){
+    lru_node* node = allocNode(key.data(), key.size(), value, hash, meta);
+    node->cas = ++_last_cas;
+    if (node->expire != 0){
+        _timers.Schedule(*node);
+    }
+    linkNode(*node, _policy == EvictionPolicy::TinyLFU ? Window : Main);
     _cur_available -= key.size() + value.size();
-    _lru_index.insert(std::make_pair(std::reference_wrapper<const std::string>(_lru_tail->key), std::reference_wrapper<lru_node>(*_lru_tail)));
+    countItems(1, key.size() + value.size());
+    indexNode(*node);
+    if (_policy == EvictionPolicy::TinyLFU){
+        _sketch.EnsureCapacity(_index_type == IndexType::Hash ? _hash_index.Size() : _lru_index.size());
+    }
 }
 
-void SimpleLRU::changeValue(lru_node& node, const std::string& value){
-    moveToTail(node);
+SimpleLRU::Segment SimpleLRU::detachNode(lru_node& node, std::size_t value_size){
+    // Node leaves the list for the time of eviction, so that eviction never reaches the node itself. It
+    // goes back to the tail of the same list
+    Segment segment = static_cast<Segment>(node.segment);
+    unlinkNode(node);
     std::size_t diff_in_size  = 0;
-    if (node.value.size() > value.size()){
-        diff_in_size = node.value.size() - value.size();
+    if (node.value_size > value_size){
+        diff_in_size = node.value_size - value_size;
         _cur_available += diff_in_size;
+        countItems(0, -int64_t(diff_in_size));
     } else {
-        diff_in_size = value.size() - node.value.size();
-        while (diff_in_size > _cur_available){
-            deleteOneFromHead();
-        }
+        diff_in_size = value_size - node.value_size;
+        reserve(diff_in_size);
         _cur_available -= diff_in_size;
+        countItems(0, diff_in_size);
     }
-    node.value = value;
+    return segment;
 }
 
-void SimpleLRU::moveToTail(lru_node& node){
-    if (node.next == nullptr){
+bool SimpleLRU::isWritable(const lru_node& node, std::size_t value_size) const{
+    // Values referenced by handles are immutable, so block shared with some reader can't be reused.
+    // Concurrent reader could take a reference right now: it does so before checking sequence counter the
+    // caller has made odd, so either the reference is seen here or the reader sees the counter and retries
+    if (_epoch != nullptr){
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+    return value_size <= node.capacity && node.refs.load(std::memory_order_acquire) == 1;
+}
+
+void SimpleLRU::changeValue(lru_node& node, const std::string& value, const ItemMeta &meta){
+    _timers.Cancel(node);
+    Segment segment = detachNode(node, value.size());
+
+    // Reuse memory block if value fits and doesn't waste more than a half of it
+    if (isWritable(node, value.size()) && value.size() >= node.capacity / 2){
+        std::memcpy(node.value(), value.data(), value.size());
+        node.value_size = value.size();
+        node.flags = meta.flags;
+        node.expire = meta.expire;
+        node.cas = ++_last_cas;
+        if (node.expire != 0){
+            _timers.Schedule(node);
+        }
+        linkNode(node, segment);
         return;
     }
+
+    // Otherwise node gets moved into a new block of the right size
+    replaceNode(node, *allocNode(node.key(), node.key_size, value, node.hash, meta), segment);
+}
+
+bool SimpleLRU::concat(const std::string &key, const std::string &data, bool front){
+    expireItems();
+    std::size_t hash = hashOf(key);
+    recordAccess(hash);
+    lru_node *node = findNode(key, hash);
+    if (node == nullptr){
+        return false;
+    }
+    std::size_t value_size = node->value_size + data.size();
+    if (node->key_size + value_size > _max_size){
+        return false;
+    }
+
+    Segment segment = detachNode(*node, value_size);
+    if (isWritable(*node, value_size)){
+        if (front){
+            std::memmove(node->value() + data.size(), node->value(), node->value_size);
+            std::memcpy(node->value(), data.data(), data.size());
+        } else {
+            std::memcpy(node->value() + node->value_size, data.data(), data.size());
+        }
+        node->value_size = value_size;
+        node->cas = ++_last_cas;
+        linkNode(*node, segment);
+        return true;
+    }
+
+    // Block grows by a half, so series of appends copies each byte a few times at most. Spare bytes aren't
+    // accounted in max_size, just like the ones changeValue leaves
+    std::size_t capacity = value_size + value_size / 2;
+    lru_node *fresh = allocNode(node->key(), node->key_size, value_size, capacity, hash,
+                                ItemMeta(node->flags, node->expire, node->cas));
+    if (front){
+        std::memcpy(fresh->value(), data.data(), data.size());
+        std::memcpy(fresh->value() + data.size(), node->value(), node->value_size);
+    } else {
+        std::memcpy(fresh->value(), node->value(), node->value_size);
+        std::memcpy(fresh->value() + node->value_size, data.data(), data.size());
+    }
+    replaceNode(*node, *fresh, segment);
+    return true;
+}
+
+IncrResult SimpleLRU::addNumber(const std::string &key, uint64_t delta, bool decrement, uint64_t &result){
+    expireItems();
+    std::size_t hash = hashOf(key);
+    recordAccess(hash);
+    lru_node *node = findNode(key, hash);
+    if (node == nullptr){
+        return IncrResult::NotFound;
+    }
+    uint64_t number;
+    if (!parseNumber(node->value(), node->value_size, number)){
+        return IncrResult::NotNumber;
+    }
+    result = applyDelta(number, delta, decrement);
+    char digits[MaxNumberLength];
+    std::size_t value_size = formatNumber(result, digits);
+    if (node->key_size + value_size > _max_size){
+        return IncrResult::NotStored;
+    }
+
+    Segment segment = detachNode(*node, value_size);
+    if (isWritable(*node, value_size)){
+        std::memcpy(node->value(), digits, value_size);
+        node->value_size = value_size;
+        node->cas = ++_last_cas;
+        linkNode(*node, segment);
+        return IncrResult::Stored;
+    }
+
+    // Counter gets block of the maximum number length, so that next changes happen in place
+    std::size_t capacity = MaxNumberLength;
+    lru_node *fresh = allocNode(node->key(), node->key_size, value_size, capacity, hash,
+                                ItemMeta(node->flags, node->expire, node->cas));
+    std::memcpy(fresh->value(), digits, value_size);
+    replaceNode(*node, *fresh, segment);
+    return IncrResult::Stored;
+}
+
+void SimpleLRU::replaceNode(lru_node &node, lru_node &fresh, Segment segment){
+    fresh.cas = ++_last_cas;
+    _timers.Cancel(node);
+    if (fresh.expire != 0){
+        _timers.Schedule(fresh);
+    }
+    linkNode(fresh, segment);
+    if (_index_type == IndexType::Hash){
+        _hash_index.Replace(&node, &fresh);
+    } else {
+        unindexNode(node);
+        indexNode(fresh);
+    }
+    retireNode(node);
+}
+
+void SimpleLRU::linkNode(lru_node& node, Segment segment){
+    lru_list &list = _lists[segment];
+    node.segment = segment;
+    node.prev = list.tail;
+    node.next = nullptr;
+    if (list.tail != nullptr){
+        list.tail->next = &node;
+    } else {
+        list.head = &node;
+    }
+    list.tail = &node;
+    list.size += node.key_size + node.value_size;
+    if (_budget != nullptr){
+        node.stamp = MemoryBudget<SimpleLRU>::Stamp();
+        publishColdest();
+    }
+}
+
+void SimpleLRU::unlinkNode(lru_node& node){
+    lru_list &list = _lists[node.segment];
     if (node.prev == nullptr){
-        node.next->prev = nullptr;
-        _lru_tail->next = std::move(_lru_head);
-        _lru_head = std::move(node.next);
+        list.head = node.next;
+    } else {
+        node.prev->next = node.next;
+    }
+    if (node.next == nullptr){
+        list.tail = node.prev;
     } else {
-        _lru_tail->next = std::move(node.prev->next);
         node.next->prev = node.prev;
-        node.prev->next = std::move(node.next);
     }
-    node.prev = _lru_tail;
-    node.next = nullptr;
-    _lru_tail = &node;
+    list.size -= node.key_size + node.value_size;
+    if (_budget != nullptr){
+        publishColdest();
+    }
+}
+
+void SimpleLRU::moveToTail(lru_node& node){
+    if (node.next == nullptr){
+        return;
+    }
+    unlinkNode(node);
+    linkNode(node, static_cast<Segment>(node.segment));
+}
+
+void SimpleLRU::touchNode(lru_node& node){
+    if (_policy == EvictionPolicy::LRU){
+        moveToTail(node);
+    } else if (_policy == EvictionPolicy::Clock){
+        if (!node.referenced.load(std::memory_order_relaxed)){
+            // Check first to not bounce cache line of hot item between readers
+            node.referenced.store(true, std::memory_order_relaxed);
+        }
+    } else if (node.segment == Main){
+        // Second hit promotes item from probation to protected, which pushes the oldest protected
+        // items back to probation
+        unlinkNode(node);
+        linkNode(node, Protected);
+        lru_list &protect = _lists[Protected];
+        while (protect.size > _protected_limit && protect.head != &node){
+            lru_node *demoted = protect.head;
+            unlinkNode(*demoted);
+            linkNode(*demoted, Main);
+        }
+    } else {
+        moveToTail(node);
+    }
+}
+
+void SimpleLRU::recordAccess(std::size_t hash){
+    if (_policy == EvictionPolicy::TinyLFU){
+        _sketch.Increment(hash);
+    }
+}
+
+void SimpleLRU::deleteNode(lru_node& node){
+    _timers.Cancel(node);
+    unindexNode(node);
+    _cur_available += node.key_size + node.value_size;
+    countItems(-1, -int64_t(node.key_size + node.value_size));
+    unlinkNode(node);
+    retireNode(node);
+}
+
+void SimpleLRU::evictNode(lru_node& node){
+    _evictions.fetch_add(1, std::memory_order_relaxed);
+    deleteNode(node);
 }
 
 void SimpleLRU::deleteOneFromHead(){
-    _cur_available += _lru_head->key.size() + _lru_head->value.size();
-    _lru_index.erase(_lru_head->key);
-    if (_lru_head->next == nullptr){
-        _lru_tail = nullptr;
-        _lru_head.reset();
+    if (_policy == EvictionPolicy::TinyLFU){
+        evictTinyLFU();
+        return;
+    }
+    lru_list &list = _lists[Main];
+    if (_policy == EvictionPolicy::Clock){
+        // Give referenced items second chance, loop ends as marks are cleared on the way
+        while (list.head->referenced.load(std::memory_order_relaxed)){
+            list.head->referenced.store(false, std::memory_order_relaxed);
+            moveToTail(*list.head);
+        }
+    }
+    evictNode(*list.head);
+}
+
+void SimpleLRU::ShareBudget(MemoryBudget<SimpleLRU> *budget){
+    _budget = budget;
+    _max_size = budget->Size();
+    _cur_available = 0;
+    publishColdest();
+    budget->Join(this);
+}
+
+std::size_t SimpleLRU::Reclaim(std::size_t bytes){
+    if (_budget == nullptr){
+        return 0;
+    }
+    expireItems();
+    while (bytes > _cur_available && ColdestStamp() != UINT32_MAX){
+        deleteOneFromHead();
+    }
+    std::size_t spare = _cur_available;
+    _cur_available = 0;
+    _budget->Return(spare);
+    return spare;
+}
+
+void SimpleLRU::reserve(std::size_t size){
+    bool direct = false;
+    while (size > _cur_available){
+        if (_budget != nullptr){
+            std::size_t borrowed = _budget->Borrow(size - _cur_available);
+            if (borrowed > 0){
+                _cur_available += borrowed;
+                continue;
+            }
+        }
+        if (!direct){
+            direct = true;
+            _direct_reclaims.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (_budget != nullptr && reclaimShared(size - _cur_available)){
+            continue;
+        }
+        deleteOneFromHead();
+    }
+}
+
+bool SimpleLRU::reclaimShared(std::size_t size){
+    // Budget is over, the globally coldest item goes away. If it belongs to another storage, that one is
+    // asked to give bytes back, own item is evicted if the other storage is busy
+    bool empty = ColdestStamp() == UINT32_MAX;
+    SimpleLRU *victim = _budget->Coldest(this);
+    uint32_t now = MemoryBudget<SimpleLRU>::Stamp();
+    if (victim != nullptr && (empty || now - victim->ColdestStamp() > now - ColdestStamp())){
+        if (victim->Reclaim(size) > 0){
+            return true;
+        }
+    }
+    if (!empty){
+        return false;
+    }
+
+    // Nothing to evict here, bytes are spare credit of other storages or their items are under lock
+    for (SimpleLRU *member : _budget->Members()){
+        if (member != this){
+            member->Reclaim(0);
+        }
+    }
+    std::this_thread::yield();
+    return true;
+}
+
+void SimpleLRU::CollectStats(std::map<std::string, uint64_t> &stats){
+    stats["curr_items"] += _items.load(std::memory_order_relaxed);
+    stats["bytes"] += _bytes.load(std::memory_order_relaxed);
+    stats["limit_maxbytes"] += _max_size;
+    stats["evictions"] += _evictions.load(std::memory_order_relaxed);
+    stats["direct_reclaims"] += _direct_reclaims.load(std::memory_order_relaxed);
+}
+
+void SimpleLRU::returnCredit(){
+    if (_budget != nullptr && _cur_available > 2 * _budget->Chunk()){
+        _budget->Return(_cur_available - _budget->Chunk());
+        _cur_available = _budget->Chunk();
+    }
+}
+
+void SimpleLRU::publishColdest(){
+    const lru_node *head = _lists[Main].head;
+    if (head == nullptr){
+        head = _lists[Protected].head;
+    }
+    if (head == nullptr){
+        head = _lists[Window].head;
+    }
+    _coldest.store(head != nullptr ? head->stamp : UINT32_MAX, std::memory_order_relaxed);
+}
+
+void SimpleLRU::evictTinyLFU(){
+    lru_node *candidate = _lists[Window].head;
+    lru_node *victim = _lists[Main].head != nullptr ? _lists[Main].head : _lists[Protected].head;
+    if (candidate == nullptr){
+        evictNode(*victim);
+        return;
+    }
+
+    std::size_t main_size = _lists[Main].size + _lists[Protected].size;
+    if (_lists[Window].size > _window_limit &&
+        main_size + candidate->key_size + candidate->value_size <= _max_size - _window_limit){
+        // Main LRU has room, item leaving the window is admitted without competition. Nothing is freed
+        // yet, so caller comes back once more
+        unlinkNode(*candidate);
+        linkNode(*candidate, Main);
+        return;
+    }
+
+    // Admission: the oldest item of the window competes with eviction candidate of the main LRU, only
+    // the one requested more often stays
+    if (victim != nullptr && _sketch.Frequency(candidate->hash) > _sketch.Frequency(victim->hash)){
+        evictNode(*victim);
     } else {
-        _lru_head = std::move(_lru_head->next);
-        _lru_head->prev = nullptr;
+        evictNode(*candidate);
     }
 }
 
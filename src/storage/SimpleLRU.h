@@ -1,12 +1,24 @@
 #ifndef AFINA_STORAGE_SIMPLE_LRU_H
 #define AFINA_STORAGE_SIMPLE_LRU_H
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <afina/Storage.h>
+#include <afina/concurrency/Epoch.h>
+
+#include "FrequencySketch.h"
+#include "HashIndex.h"
+#include "MemoryBudget.h"
+#include "TimerWheel.h"
 
 namespace Afina {
 namespace Backend {
@@ -17,47 +29,296 @@ namespace Backend {
  */
 class SimpleLRU : public Afina::Storage {
 public:
-    SimpleLRU(size_t max_size = 1024) :
+    // Data structure used to find nodes by key
+    enum class IndexType {
+        // Red-black tree, O(log n) string comparisons per lookup
+        Map,
+
+        // Open addressing hash table, see HashIndex.h
+        Hash
+    };
+
+    // Which item gets evicted when there is no space for a new one
+    enum class EvictionPolicy {
+        // Exact LRU: each hit moves item to the tail of the list
+        LRU,
+
+        // CLOCK (second chance): hit only marks item as referenced and doesn't change the list, so Get
+        // could run concurrently with other Gets. Eviction moves marked items from the head to the tail
+        // clearing the mark and removes the first unmarked one
+        Clock,
+
+        // W-TinyLFU: new items go to a small window LRU (1% of size), items leaving the window compete
+        // with eviction candidates of the main segmented LRU and get admitted only if they were requested
+        // more often according to FrequencySketch. Burst of one-off keys stays in the window and can't
+        // flush the hot set. Main LRU has probation and protected (80%) segments, second hit moves item
+        // from probation to protected
+        TinyLFU
+    };
+
+    SimpleLRU(size_t max_size = 1024, IndexType index_type = IndexType::Map,
+              EvictionPolicy policy = EvictionPolicy::LRU) :
         _max_size(max_size),
         _cur_available(max_size),
-        _lru_head(nullptr),
-        _lru_tail(nullptr)
+        _window_limit(max_size / 100),
+        _protected_limit((max_size - max_size / 100) / 10 * 8),
+        _lists(),
+        _index_type(index_type),
+        _policy(policy),
+        _epoch(nullptr),
+        _timers(now()),
+        _last_cas(0),
+        _budget(nullptr),
+        _coldest(UINT32_MAX),
+        _items(0),
+        _bytes(0),
+        _evictions(0),
+        _direct_reclaims(0)
         {}
 
     ~SimpleLRU() {
         _lru_index.clear();
-        if (_lru_tail){
-            _lru_tail = _lru_tail->prev;
-            while (_lru_tail){
-                _lru_tail->next.reset();
-                _lru_tail = _lru_tail->prev;
+        _hash_index.Clear();
+        for (auto &list : _lists){
+            while (list.head){
+                lru_node *next = list.head->next;
+                releaseNode(list.head);
+                list.head = next;
             }
-            _lru_head.reset();
         }
     }
 
     // Implements Afina::Storage interface
-    bool Put(const std::string &key, const std::string &value) override;
+    bool Put(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) override;
 
     // Implements Afina::Storage interface
-    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+    bool PutIfAbsent(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) override;
+
+    // Implements Afina::Storage interface, hash is used by the index as is
+    bool Put(const std::string &key, std::size_t hash, const std::string &value, const ItemMeta &meta) override;
+
+    // Implements Afina::Storage interface, see Put above
+    bool PutIfAbsent(const std::string &key, std::size_t hash, const std::string &value,
+                     const ItemMeta &meta) override;
 
     // Implements Afina::Storage interface
-    bool Set(const std::string &key, const std::string &value) override;
+    bool Set(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) override;
 
     // Implements Afina::Storage interface
     bool Delete(const std::string &key) override;
 
     // Implements Afina::Storage interface
+    //
+    // With Clock policy changes nothing but atomic mark of the item, so it is safe to call concurrently
+    // with other Gets
     bool Get(const std::string &key, std::string &value) override;
 
+    // Implements Afina::Storage interface, see Get above
+    bool Get(const std::string &key, Value &value) override;
+
+    // Implements Afina::Storage interface, see Get above
+    bool Get(const std::string &key, Value &value, ItemMeta &meta) override;
+
+    // Implements Afina::Storage interface
+    CasResult CompareAndSet(const std::string &key, const std::string &value, const ItemMeta &meta,
+                            uint64_t cas) override;
+
+    // Implements Afina::Storage interface
+    CasResult CompareAndDelete(const std::string &key, uint64_t cas) override;
+
+    // Implements Afina::Storage interface
+    //
+    // Values stay decimal text, so that Get hands them out without conversion. Number is rewritten in place
+    // unless somebody holds a handle to the old value, also with concurrent readers. Counter moved to a new
+    // block gets room for the longest number, so it is allocated once
+    IncrResult Increment(const std::string &key, uint64_t delta, uint64_t &result) override;
+
+    // Implements Afina::Storage interface, see Increment above
+    IncrResult Decrement(const std::string &key, uint64_t delta, uint64_t &result) override;
+
+    // Implements Afina::Storage interface
+    //
+    // Data is added in place when the block has spare capacity, otherwise value moves to a block with
+    // room for further appends
+    bool Append(const std::string &key, const std::string &data) override;
+
+    // Implements Afina::Storage interface, see Append above
+    bool Prepend(const std::string &key, const std::string &data) override;
+
+    // Implements Afina::Storage interface, hashes keys and passes them all to GetBatch
+    void GetMany(const std::vector<std::string> &keys, std::vector<LookupResult> &results) override;
+
+    // Implements Afina::Storage interface, passes all the keys to GetBatch
+    void GetMany(const std::vector<std::string> &keys, const std::vector<std::size_t> &hashes,
+                 std::vector<LookupResult> &results) override;
+
+    // Implements Afina::Storage interface, see above
+    void GetMany(const std::vector<StringView> &keys, const std::vector<std::size_t> &hashes,
+                 std::vector<LookupResult> &results) override;
+
+    // Implements Afina::Storage interface, see above
+    void GetMany(const StringView *keys, const std::size_t *hashes, std::size_t count,
+                 LookupResult *results) override;
+
+    // Implements Afina::Storage interface, hashes keys and passes them all to PutBatch
+    void PutMany(const std::vector<std::string> &keys, const std::vector<std::string> &values,
+                 const std::vector<ItemMeta> &metas, std::vector<bool> &stored) override;
+
+    /**
+     * Part of GetMany: looks up keys[k] for each k in pos, hashes[k] is hashOf(keys[k]), result goes to
+     * results[k]. Arrays are sized by the caller. Thread safe versions take the lock once per call, so that
+     * sharded storage locks each shard once per batch
+     *
+     * Index slots are prefetched a few keys ahead, so that lookups overlap their cache misses
+     */
+    virtual void GetBatch(const StringView *keys, const std::size_t *hashes, const std::vector<std::size_t> &pos,
+                          LookupResult *results);
+
+    /**
+     * Part of PutMany, see GetBatch
+     */
+    virtual void PutBatch(const std::vector<std::string> &keys, const std::vector<std::string> &values,
+                          const std::vector<ItemMeta> &metas, const std::vector<std::size_t> &hashes,
+                          const std::vector<std::size_t> &pos, std::vector<bool> &stored);
+
+    inline EvictionPolicy Policy() const { return _policy; }
+
+    /**
+     * Returns how many bytes storage spends on each item in addition to key and value bytes: node
+     * header plus average share of the index. Those bytes are not accounted in max_size, so it could be
+     * used to estimate real memory footprint as count * (item size + overhead). Rounding up to the slab
+     * size class isn't included, it is below a quarter of the block
+     */
+    std::size_t ItemOverhead() const;
+
+    /**
+     * Makes storage take bytes from the given budget instead of having max_size of its own, so that storages
+     * sharing the budget grow and shrink at the expense of each other, see MemoryBudget. Any item up to the
+     * budget size fits, TinyLFU segments keep sizes of max_size given to constructor. Must be called while
+     * storage is empty, budget must outlive it
+     */
+    void ShareBudget(MemoryBudget<SimpleLRU> *budget);
+
+    /**
+     * Evicts items until there are the given number of spare bytes or no items at all, then returns all spare
+     * bytes to the budget. Called by other storages of the budget when it is empty, returns number of bytes
+     * given back. Thread safe versions don't wait for the lock and return 0 if it is busy, so that two
+     * storages reclaiming from each other never deadlock
+     */
+    virtual std::size_t Reclaim(std::size_t bytes);
+
+    /**
+     * Last access time of the item that would be evicted first in MemoryBudget::Stamp units, UINT32_MAX if
+     * storage is empty. Maintained only while storage shares the budget, could be read from any thread
+     */
+    inline uint32_t ColdestStamp() const { return _coldest.load(std::memory_order_relaxed); }
+
+    // Implements Afina::Storage interface: curr_items and bytes of keys and values stored, limit_maxbytes,
+    // evictions counts items evicted to make room, direct_reclaims counts writes that had to evict themselves,
+    // no matter how many items
+    void CollectStats(std::map<std::string, uint64_t> &stats) override;
+
+protected:
+    /**
+     * Lets peek run concurrently with writers, which are still serialized by the caller: unlinked nodes
+     * and replaced index tables are retired through the epoch instead of being released right away. Value
+     * is changed in place only if nobody holds a reference to it, so caller must make a sequence counter
+     * odd for the time of each write and reader must check it after peek took the reference, dropping the
+     * hit if counter has changed. Requires hash index and Clock policy, must be called while storage is empty
+     */
+    void enableConcurrentReads(Concurrency::Epoch *epoch);
+
+    /**
+     * Get for concurrent readers, caller must hold epoch guard. Could miss existing item while writer
+     * moves index slots around, see HashIndex::Find
+     */
+    bool peek(const StringView &key, std::size_t hash, Value &value);
+
+    // See peek above. Node is alive inside of epoch, so it is copied without taking a reference, the copy
+    // is torn if sequence counter has changed
+    bool peek(const StringView &key, std::size_t hash, std::string &value);
+
+    // See peek above
+    bool peek(const StringView &key, std::size_t hash, Value &value, ItemMeta &meta);
+
+    static inline std::size_t hashOf(const std::string &key) { return KeyHash(key); }
+
+    /**
+     * Prefetches index memory for the keys following i-th one of GetBatch or PutBatch. Must be called for
+     * each i in order. Concurrent readers must hold epoch guard
+     */
+    void prefetchBatch(const std::size_t *hashes, const std::vector<std::size_t> &pos, std::size_t i) const;
+
 private:
-    // LRU cache node
-    using lru_node = struct lru_node {
-        const std::string key;
-        std::string value;
+    // How many keys ahead batch lookups prefetch index slots, nodes are prefetched half way
+    static const std::size_t PrefetchDistance = 4;
+
+    // LRU cache node. Header, key and value share the single memory block:
+    //
+    // [lru_node][key bytes][value bytes][spare bytes up to capacity]
+    //
+    // Links of the list and the hash used by HashIndex live inside of the header, so with hash index
+    // item costs exactly one allocation. Blocks come from Allocator::Slab::Default, rounded up to its size
+    // class, and the rounding goes to the spare capacity.
+    //
+    // Node is a reference counted buffer for Value handles: list holds one reference and each handle
+    // returned by Get holds one more. Node unlinked from the list stays alive until the last handle is gone.
+    //
+    // Item attributes are kept in the header as well, expiration time lives in the timer hook, items that
+    // expire are in the timer wheel.
+    struct lru_node : public Value::Buffer, public TimerWheel::Hook {
         lru_node* prev;
-        std::unique_ptr<lru_node> next;
+        lru_node* next;
+        std::size_t hash;
+        uint64_t cas;
+        uint32_t key_size;
+        uint32_t value_size;
+        // Number of bytes reserved for the value
+        uint32_t capacity;
+        uint32_t flags;
+        // Item was accessed since clock hand passed it last time, see EvictionPolicy::Clock
+        std::atomic<bool> referenced;
+        // List the node belongs to, see Segment
+        uint8_t segment;
+        // When node was linked to its list last time, see ColdestStamp. Set only if budget is shared
+        uint32_t stamp;
+
+        inline char *key() { return reinterpret_cast<char *>(this + 1); }
+        inline const char *key() const { return reinterpret_cast<const char *>(this + 1); }
+        inline char *value() { return key() + key_size; }
+        inline const char *value() const { return key() + key_size; }
+
+        inline bool hasKey(const StringView &k) const {
+            return k.size() == key_size && std::memcmp(key(), k.data(), key_size) == 0;
+        }
+    };
+
+    // Lists of nodes. LRU and Clock keep all nodes in Main, TinyLFU uses Main as the probation segment
+    enum Segment { Main = 0, Protected, Window, SegmentsCount };
+
+    // Doubly linked list, elements ordered descending by "freshness": in the head element that wasn't
+    // used for longest time
+    struct lru_list {
+        lru_node *head;
+        lru_node *tail;
+        // Total size of keys and values in the list
+        std::size_t size;
+    };
+
+    // Key bytes of some node or lookup request, used by map index as there is no std::string in the node.
+    // Keys are ordered by hash first, so that search compares bytes only of the key with the same hash
+    struct key_ref {
+        std::size_t hash;
+        const char *data;
+        std::size_t size;
+
+        bool operator<(const key_ref &other) const {
+            if (hash != other.hash) {
+                return hash < other.hash;
+            }
+            int cmp = std::memcmp(data, other.data, std::min(size, other.size));
+            return cmp < 0 || (cmp == 0 && size < other.size);
+        }
     };
 
     // Maximum number of bytes could be stored in this cache.
@@ -68,27 +329,167 @@ private:
     // must be less than _max_size
     std::size_t _cur_available;
 
-    // Main storage of lru_nodes, elements in this list ordered descending by "freshness": in the head
-    // element that wasn't used for longest time.
-    //
-    // List owns all nodes
-    std::unique_ptr<lru_node> _lru_head;
-    lru_node* _lru_tail;
+    // TinyLFU sizes of the window and protected segments, the rest belongs to probation
+    std::size_t _window_limit;
+    std::size_t _protected_limit;
+
+    // Main storage of lru_nodes, see Segment. Lists own all nodes
+    lru_list _lists[SegmentsCount];
 
     // Index of nodes from list above, allows fast random access to elements by lru_node#key
-    std::map<std::reference_wrapper<const std::string>, std::reference_wrapper<lru_node>, std::less<std::string>> _lru_index;
+    std::map<key_ref, lru_node*> _lru_index;
+    HashIndex<lru_node> _hash_index;
+
+    // Which one of indexes above is in use
+    IndexType _index_type;
+
+    EvictionPolicy _policy;
+
+    // Access frequencies for TinyLFU admission
+    FrequencySketch _sketch;
+
+    // Items with expiration time. Writers advance it before doing anything else, so expired items get
+    // reclaimed before any live item is evicted
+    TimerWheel _timers;
+
+    // Defers release of unlinked nodes if there are concurrent readers, see enableConcurrentReads
+    Concurrency::Epoch *_epoch;
+
+    // Version given to the last written item. Versions only grow, so item deleted and stored again never
+    // gets version some client has seen before
+    uint64_t _last_cas;
+
+    // Shared source of bytes, see ShareBudget. With budget _cur_available is the credit borrowed from it
+    MemoryBudget<SimpleLRU> *_budget;
+
+    // See ColdestStamp
+    std::atomic<uint32_t> _coldest;
+
+    // See CollectStats. Changed by writers only, atomic so that stats could be read without lock
+    std::atomic<uint64_t> _items;
+    std::atomic<uint64_t> _bytes;
+    std::atomic<uint64_t> _evictions;
+    std::atomic<uint64_t> _direct_reclaims;
+
+    // Allocates node with enough space for the key and value and copies them in
+    static lru_node *allocNode(const char *key, std::size_t key_size, const std::string &value, std::size_t hash,
+                               const ItemMeta &meta);
+
+    // Allocates node with room for capacity bytes of value and copies key in, value bytes are left to the
+    // caller
+    static lru_node *allocNode(const char *key, std::size_t key_size, std::size_t value_size, std::size_t capacity,
+                               std::size_t hash, const ItemMeta &meta);
+
+    // Drops list reference to the node, releases memory allocated by allocNode if it was the last one
+    static void releaseNode(lru_node *node);
+
+    // Value::Buffer::destroy for nodes
+    static void destroyNode(Value::Buffer *buffer);
+
+    // Epoch deleter dropping list reference of the retired node
+    static void releaseRetired(void *node);
+
+    // Drops list reference to the node unlinked from list and index, see enableConcurrentReads
+    void retireNode(lru_node &node);
+
+    // Returns node for the given key or nullptr if there is no such node
+    lru_node *findNode(const StringView &key, std::size_t hash);
+
+    // Finds node for Get: records access and returns nullptr for expired items
+    lru_node *lookupNode(const StringView &key, std::size_t hash);
+
+    // Put with precomputed hash
+    bool put(const std::string &key, std::size_t hash, const std::string &value, const ItemMeta &meta);
+
+    // PutIfAbsent with precomputed hash
+    bool putIfAbsent(const std::string &key, std::size_t hash, const std::string &value, const ItemMeta &meta);
+
+    // Finds node for peek, see above
+    lru_node *peekNode(const StringView &key, std::size_t hash);
+
+    // Current unix time in seconds, coarse and cheap
+    static uint32_t now();
+
+    // Item is expired already, expiration is checked lazily on access as timer wheel is advanced by
+    // writers only
+    static bool isExpired(const lru_node &node);
+
+    // Reclaims items expired by now
+    void expireItems();
+
+    // Adds node to the index in use
+    void indexNode(lru_node &node);
+
+    // Removes node from the index in use
+    void unindexNode(lru_node &node);
+
+    // Appends node to the tail of the given list
+    void linkNode(lru_node& node, Segment segment);
+
+    // Removes node from its list
+    void unlinkNode(lru_node& node);
 
     // Moves node to tail of the list, so that node becomes "the freshest".
     void moveToTail(lru_node& node);
 
+    // Records read access to the node according to eviction policy
+    void touchNode(lru_node& node);
+
+    // Counts request of the key for TinyLFU, hits and misses alike
+    void recordAccess(std::size_t hash);
+
     // Adds a new node to the tail of the list.
-    void addNode(const std::string& key, const std::string& value);
+    void addNode(const std::string& key, const std::string& value, std::size_t hash, const ItemMeta &meta);
+
+    // Unlinks node from the list and index and releases it
+    void deleteNode(lru_node& node);
+
+    // Changes curr_items and bytes of CollectStats
+    inline void countItems(int64_t items, int64_t bytes){
+        _items.store(_items.load(std::memory_order_relaxed) + items, std::memory_order_relaxed);
+        _bytes.store(_bytes.load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+    }
+
+    // Deletes node to make room for another one
+    void evictNode(lru_node& node);
 
     // Deletes an element that wasn;t used for the longest time.
     void deleteOneFromHead();
 
-    // Changes value of existing node. This node moves to the tail of the list.
-    void changeValue(lru_node& node, const std::string& value);
+    // Makes room for the given number of bytes: borrows them from the budget, takes them from the storage
+    // with the coldest items or evicts own items
+    void reserve(std::size_t size);
+
+    // Part of reserve, budget is over. Returns false if storage should evict own item instead
+    bool reclaimShared(std::size_t size);
+
+    // Gives spare credit above two chunks back to the budget
+    void returnCredit();
+
+    // Updates ColdestStamp after list heads have changed
+    void publishColdest();
+
+    // TinyLFU eviction step: either moves window overflow to the main LRU or evicts one item
+    void evictTinyLFU();
+
+    // Changes value and attributes of existing node. This node moves to the tail of the list.
+    void changeValue(lru_node& node, const std::string& value, const ItemMeta &meta);
+
+    // Append or Prepend, depending on front
+    bool concat(const std::string &key, const std::string &data, bool front);
+
+    // Increment or Decrement
+    IncrResult addNumber(const std::string &key, uint64_t delta, bool decrement, uint64_t &result);
+
+    // Unlinks node for the time its value changes size and evicts other items to make room for the new size,
+    // returns list the node should go back to
+    Segment detachNode(lru_node& node, std::size_t value_size);
+
+    // Value of the given size could be written over the node one
+    bool isWritable(const lru_node& node, std::size_t value_size) const;
+
+    // Puts fresh node to the place of unlinked node in the given list and in the index, retires the old one
+    void replaceNode(lru_node &node, lru_node &fresh, Segment segment);
 };
 
 } // namespace Backend
@@ -3,39 +3,205 @@
 namespace Afina {
 namespace Backend {
 
-StripedLockLRU::StripedLockLRU(std::size_t max_size, std::size_t n_shards) : _n_shards(n_shards) {
-    std::size_t shard_limit = max_size / n_shards;
-    if (shard_limit < 1024 * 1024) {
+StripedLockLRU::StripedLockLRU(std::size_t max_size, std::size_t n_shards, IndexType index_type,
+                               EvictionPolicy policy, bool lock_free_reads, bool background_eviction)
+    : _n_shards(n_shards), _background_eviction(background_eviction), _running(false), _reclaimer_runs(0),
+      _reclaimer_bytes(0) {
+    // Shards borrow from the shared budget, so there is no floor on the size of each one: the only limit is
+    // that every shard must be able to hold at least one chunk of credit
+    const std::size_t min_chunk = 1024;
+    if (n_shards == 0 || max_size / n_shards < min_chunk) {
         throw std::runtime_error("STORAGE CREATION ERROR: too many shards");
     }
+    // Fair share of a shard, it only sizes TinyLFU segments and lock free shards, memory comes from the budget
+    std::size_t shard_limit = max_size / n_shards;
+    // Chunks are small enough to leave little memory idle as spare credit of shards and large enough for
+    // shard to touch the shared counter once per many writes
+    std::size_t chunk = std::max<std::size_t>(min_chunk, std::min<std::size_t>(64 * 1024, shard_limit / 16));
+    _memory.reset(new MemoryBudget<SimpleLRU>(max_size, chunk));
     for (std::size_t i = 0; i < n_shards; ++i){
-        shards.emplace_back(new ThreadSafeSimplLRU(shard_limit));
+        if (lock_free_reads) {
+            shards.emplace_back(new LockFreeReadLRU(shard_limit));
+        } else {
+            shards.emplace_back(new ThreadSafeSimplLRU(shard_limit, index_type, policy));
+        }
+        shards.back()->ShareBudget(_memory.get());
+    }
+    if (background_eviction) {
+        _memory->SetLowWatermark(max_size / 32);
+    }
+}
+
+StripedLockLRU::~StripedLockLRU() { Stop(); }
+
+// See MapBasedGlobalLockImpl.h
+void StripedLockLRU::Start() {
+    if (_background_eviction && !_reclaimer.joinable()) {
+        _running.store(true);
+        _reclaimer = std::thread(&StripedLockLRU::reclaimInBackground, this);
     }
 }
 
 // See MapBasedGlobalLockImpl.h
-bool StripedLockLRU::Put(const std::string &key, const std::string &value) { 
-    return shards[hash(key) % _n_shards]->Put(key, value);
+void StripedLockLRU::Stop() {
+    if (_reclaimer.joinable()) {
+        _running.store(false);
+        _memory->Wake();
+        _reclaimer.join();
+    }
+}
+
+// See MapBasedGlobalLockImpl.h
+bool StripedLockLRU::Put(const std::string &key, const std::string &value, const ItemMeta &meta) {
+    return shards[hashOf(key) % _n_shards]->Put(key, value, meta);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool StripedLockLRU::PutIfAbsent(const std::string &key, const std::string &value, const ItemMeta &meta) {
+    return shards[hashOf(key) % _n_shards]->PutIfAbsent(key, value, meta);
 }
 
 // See MapBasedGlobalLockImpl.h
-bool StripedLockLRU::PutIfAbsent(const std::string &key, const std::string &value) { 
-    return shards[hash(key) % _n_shards]->PutIfAbsent(key, value);
+bool StripedLockLRU::Put(const std::string &key, std::size_t hash, const std::string &value, const ItemMeta &meta) {
+    return shards[hash % _n_shards]->Put(key, hash, value, meta);
 }
 
 // See MapBasedGlobalLockImpl.h
-bool StripedLockLRU::Set(const std::string &key, const std::string &value) { 
-    return shards[hash(key) % _n_shards]->Set(key, value);
+bool StripedLockLRU::PutIfAbsent(const std::string &key, std::size_t hash, const std::string &value,
+                                 const ItemMeta &meta) {
+    return shards[hash % _n_shards]->PutIfAbsent(key, hash, value, meta);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool StripedLockLRU::Set(const std::string &key, const std::string &value, const ItemMeta &meta) {
+    return shards[hashOf(key) % _n_shards]->Set(key, value, meta);
 }
 
 // See MapBasedGlobalLockImpl.h
 bool StripedLockLRU::Delete(const std::string &key) {
-    return shards[hash(key) % _n_shards]->Delete(key);
+    return shards[hashOf(key) % _n_shards]->Delete(key);
+}
+
+// See MapBasedGlobalLockImpl.h
+CasResult StripedLockLRU::CompareAndSet(const std::string &key, const std::string &value, const ItemMeta &meta,
+                                        uint64_t cas) {
+    return shards[hashOf(key) % _n_shards]->CompareAndSet(key, value, meta, cas);
+}
+
+// See MapBasedGlobalLockImpl.h
+CasResult StripedLockLRU::CompareAndDelete(const std::string &key, uint64_t cas) {
+    return shards[hashOf(key) % _n_shards]->CompareAndDelete(key, cas);
+}
+
+// See MapBasedGlobalLockImpl.h
+IncrResult StripedLockLRU::Increment(const std::string &key, uint64_t delta, uint64_t &result) {
+    return shards[hashOf(key) % _n_shards]->Increment(key, delta, result);
+}
+
+// See MapBasedGlobalLockImpl.h
+IncrResult StripedLockLRU::Decrement(const std::string &key, uint64_t delta, uint64_t &result) {
+    return shards[hashOf(key) % _n_shards]->Decrement(key, delta, result);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool StripedLockLRU::Append(const std::string &key, const std::string &data) {
+    return shards[hashOf(key) % _n_shards]->Append(key, data);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool StripedLockLRU::Prepend(const std::string &key, const std::string &data) {
+    return shards[hashOf(key) % _n_shards]->Prepend(key, data);
 }
 
 // See MapBasedGlobalLockImpl.h
 bool StripedLockLRU::Get(const std::string &key, std::string &value) { 
-    return shards[hash(key) % _n_shards]->Get(key, value);
+    return shards[hashOf(key) % _n_shards]->Get(key, value);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool StripedLockLRU::Get(const std::string &key, Value &value) {
+    return shards[hashOf(key) % _n_shards]->Get(key, value);
+}
+
+// See MapBasedGlobalLockImpl.h
+bool StripedLockLRU::Get(const std::string &key, Value &value, ItemMeta &meta) {
+    return shards[hashOf(key) % _n_shards]->Get(key, value, meta);
+}
+
+// See StripedLockLRU.h
+void StripedLockLRU::GetBatch(const StringView *keys, const std::size_t *hashes, const std::vector<std::size_t> &pos,
+                              LookupResult *results) {
+    std::vector<std::vector<std::size_t>> by_shard;
+    groupByShard(hashes, pos, by_shard);
+    for (std::size_t i = 0; i < _n_shards; ++i){
+        if (!by_shard[i].empty()) {
+            shards[i]->GetBatch(keys, hashes, by_shard[i], results);
+        }
+    }
+}
+
+// See StripedLockLRU.h
+void StripedLockLRU::PutBatch(const std::vector<std::string> &keys, const std::vector<std::string> &values,
+                              const std::vector<ItemMeta> &metas, const std::vector<std::size_t> &hashes,
+                              const std::vector<std::size_t> &pos, std::vector<bool> &stored) {
+    std::vector<std::vector<std::size_t>> by_shard;
+    groupByShard(hashes.data(), pos, by_shard);
+    for (std::size_t i = 0; i < _n_shards; ++i){
+        if (!by_shard[i].empty()) {
+            shards[i]->PutBatch(keys, values, metas, hashes, by_shard[i], stored);
+        }
+    }
+}
+
+void StripedLockLRU::groupByShard(const std::size_t *hashes, const std::vector<std::size_t> &pos,
+                                  std::vector<std::vector<std::size_t>> &by_shard) const {
+    // Shards hash keys by the same function, see SimpleLRU::hashOf
+    by_shard.assign(_n_shards, std::vector<std::size_t>());
+    for (std::size_t k : pos){
+        by_shard[hashes[k] % _n_shards].push_back(k);
+    }
+}
+
+// See MapBasedGlobalLockImpl.h
+void StripedLockLRU::CollectStats(std::map<std::string, uint64_t> &stats) {
+    uint64_t limit = stats["limit_maxbytes"];
+    for (auto &shard : shards) {
+        shard->CollectStats(stats);
+    }
+    // Shards share the budget, each one reports the whole of it
+    stats["limit_maxbytes"] = limit + _memory->Size();
+    if (_background_eviction) {
+        stats["reclaimer_runs"] += _reclaimer_runs.load(std::memory_order_relaxed);
+        stats["reclaimer_bytes"] += _reclaimer_bytes.load(std::memory_order_relaxed);
+        stats["reclaimer_free"] += _memory->Free();
+    }
+}
+
+void StripedLockLRU::reclaimInBackground() {
+    // Memory is freed up to the high watermark at once, so that writers don't wake reclaimer on every chunk
+    std::size_t low = _memory->LowWatermark();
+    std::size_t high = 2 * low;
+    while (_running.load()) {
+        _memory->WaitPressure(std::chrono::milliseconds(10));
+        if (_memory->Free() >= low) {
+            continue;
+        }
+        _reclaimer_runs.fetch_add(1, std::memory_order_relaxed);
+
+        // Shard lock is taken for one chunk at a time, writers of the shard wait for a short while only
+        while (_running.load() && _memory->Free() < high) {
+            SimpleLRU *victim = _memory->Coldest(nullptr);
+            if (victim == nullptr) {
+                break;
+            }
+            std::size_t bytes = victim->Reclaim(_memory->Chunk());
+            if (bytes == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            _reclaimer_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        }
+    }
 }
 
 } // namespace Backend
@@ -1,12 +1,15 @@
 #ifndef AFINA_STORAGE_STRIPED_LOCK_LRU_H
 #define AFINA_STORAGE_STRIPED_LOCK_LRU_H
 
+#include <atomic>
 #include <map>
 #include <mutex>
 #include <string>
-#include <functional>
+#include <thread>
 #include <vector>
 
+#include "LockFreeReadLRU.h"
+#include "MemoryBudget.h"
 #include "ThreadSafeSimpleLRU.h"
 
 namespace Afina {
@@ -14,31 +17,112 @@ namespace Backend {
 
 /**
  * # SimpleLRU thread safe version
+ * Keys are spread over independent shards, each one has own lock. With lock_free_reads shards are
+ * LockFreeReadLRU, so Get takes no lock at all, index type and policy are ignored in this case.
+ *
+ * Shards share max_size through MemoryBudget instead of getting a fixed part of it, so that skewed keys
+ * don't overflow one shard while others stay half empty. Once memory is over, item evicted is the oldest
+ * head among all shards, which is close to what a single LRU of the same size would evict. As memory isn't split
+ * up front, small instance could have many shards: each one needs only a 1KB chunk of max_size.
+ *
+ * With background_eviction a thread started by Start keeps 3-6% of max_size free evicting the coldest items
+ * in small steps, so that writers almost never evict under the shard lock themselves. Writer that takes free
+ * bytes below the low watermark wakes it up
  */
 class StripedLockLRU : public ThreadSafeSimplLRU {
 public:
-    StripedLockLRU(std::size_t max_size = 1024 * 1024 * 8, std::size_t n_shards = 4);
-    ~StripedLockLRU() {}
+    StripedLockLRU(std::size_t max_size = 1024 * 1024 * 8, std::size_t n_shards = 4,
+                   IndexType index_type = IndexType::Map, EvictionPolicy policy = EvictionPolicy::LRU,
+                   bool lock_free_reads = false, bool background_eviction = false);
+    ~StripedLockLRU();
+
+    // Implements Afina::Storage interface, starts background reclaimer if it is enabled
+    void Start() override;
+
+    // Implements Afina::Storage interface, stops background reclaimer
+    void Stop() override;
+
+    // see SimpleLRU.h
+    bool Put(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) override;
 
     // see SimpleLRU.h
-    bool Put(const std::string &key, const std::string &value) override;
+    bool PutIfAbsent(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) override;
 
     // see SimpleLRU.h
-    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+    bool Put(const std::string &key, std::size_t hash, const std::string &value, const ItemMeta &meta) override;
 
     // see SimpleLRU.h
-    bool Set(const std::string &key, const std::string &value) override;
+    bool PutIfAbsent(const std::string &key, std::size_t hash, const std::string &value,
+                     const ItemMeta &meta) override;
+
+    // see SimpleLRU.h
+    bool Set(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) override;
 
     // see SimpleLRU.h
     bool Delete(const std::string &key) override;
 
+    // see SimpleLRU.h
+    CasResult CompareAndSet(const std::string &key, const std::string &value, const ItemMeta &meta,
+                            uint64_t cas) override;
+
+    // see SimpleLRU.h
+    CasResult CompareAndDelete(const std::string &key, uint64_t cas) override;
+
+    // see SimpleLRU.h
+    IncrResult Increment(const std::string &key, uint64_t delta, uint64_t &result) override;
+
+    // see SimpleLRU.h
+    IncrResult Decrement(const std::string &key, uint64_t delta, uint64_t &result) override;
+
+    // see SimpleLRU.h
+    bool Append(const std::string &key, const std::string &data) override;
+
+    // see SimpleLRU.h
+    bool Prepend(const std::string &key, const std::string &data) override;
+
     // see SimpleLRU.h
     bool Get(const std::string &key, std::string &value) override;
 
+    // see SimpleLRU.h
+    bool Get(const std::string &key, Value &value) override;
+
+    // see SimpleLRU.h
+    bool Get(const std::string &key, Value &value, ItemMeta &meta) override;
+
+    // see SimpleLRU.h, keys are grouped by shard and each shard gets its part of the batch at once
+    void GetBatch(const StringView *keys, const std::size_t *hashes, const std::vector<std::size_t> &pos,
+                  LookupResult *results) override;
+
+    // see GetBatch
+    void PutBatch(const std::vector<std::string> &keys, const std::vector<std::string> &values,
+                  const std::vector<ItemMeta> &metas, const std::vector<std::size_t> &hashes,
+                  const std::vector<std::size_t> &pos, std::vector<bool> &stored) override;
+
+    // see SimpleLRU.h, sums counters of all shards, reclaimer_runs counts wakeups of background reclaimer
+    // that found memory below the low watermark, reclaimer_bytes counts bytes it gave back to the budget,
+    // reclaimer_free is the number of bytes free in the budget right now
+    void CollectStats(std::map<std::string, uint64_t> &stats) override;
+
 private:
-    std::hash<std::string> hash;
-    std::vector<std::unique_ptr<ThreadSafeSimplLRU>> shards;
+    // Body of the background reclaimer thread
+    void reclaimInBackground();
+
+    // Splits batch positions by shards, keeps relative order of keys
+    void groupByShard(const std::size_t *hashes, const std::vector<std::size_t> &pos,
+                      std::vector<std::vector<std::size_t>> &by_shard) const;
+
+    // Shared by all shards, so it is destroyed after them
+    std::unique_ptr<MemoryBudget<SimpleLRU>> _memory;
+
+    std::vector<std::unique_ptr<SimpleLRU>> shards;
     std::size_t _n_shards;
+
+    // Background reclaimer, see reclaimInBackground
+    bool _background_eviction;
+    std::thread _reclaimer;
+    std::atomic<bool> _running;
+    std::atomic<uint64_t> _reclaimer_runs;
+    std::atomic<uint64_t> _reclaimer_bytes;
 };
 
 } // namespace Backend
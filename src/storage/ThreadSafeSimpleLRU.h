@@ -4,6 +4,9 @@
 #include <map>
 #include <mutex>
 #include <string>
+#include <vector>
+
+#include <afina/concurrency/SharedMutex.h>
 
 #include "SimpleLRU.h"
 
@@ -12,44 +15,150 @@ namespace Backend {
 
 /**
  * # SimpleLRU thread safe version
+ * Operations are serialized by a global lock. With Clock eviction policy Get doesn't change the list, so it
+ * takes the lock in shared mode and reads proceed concurrently
  */
 class ThreadSafeSimplLRU : public SimpleLRU {
 public:
-    ThreadSafeSimplLRU(size_t max_size = 1024) : SimpleLRU(max_size) {}
+    ThreadSafeSimplLRU(size_t max_size = 1024, IndexType index_type = IndexType::Map,
+                       EvictionPolicy policy = EvictionPolicy::LRU) : SimpleLRU(max_size, index_type, policy) {}
     ~ThreadSafeSimplLRU() {}
 
     // see SimpleLRU.h
-    bool Put(const std::string &key, const std::string &value) override {
-        std::unique_lock<std::mutex> lock(_m);
-        return SimpleLRU::Put(key, value);
+    bool Put(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) override {
+        std::unique_lock<Concurrency::SharedMutex> lock(_m);
+        return SimpleLRU::Put(key, value, meta);
+    }
+
+    // see SimpleLRU.h
+    bool PutIfAbsent(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) override {
+        std::unique_lock<Concurrency::SharedMutex> lock(_m);
+        return SimpleLRU::PutIfAbsent(key, value, meta);
+    }
+
+    // see SimpleLRU.h
+    bool Put(const std::string &key, std::size_t hash, const std::string &value, const ItemMeta &meta) override {
+        std::unique_lock<Concurrency::SharedMutex> lock(_m);
+        return SimpleLRU::Put(key, hash, value, meta);
     }
 
     // see SimpleLRU.h
-    bool PutIfAbsent(const std::string &key, const std::string &value) override {
-        std::unique_lock<std::mutex> lock(_m);
-        return SimpleLRU::PutIfAbsent(key, value);
+    bool PutIfAbsent(const std::string &key, std::size_t hash, const std::string &value,
+                     const ItemMeta &meta) override {
+        std::unique_lock<Concurrency::SharedMutex> lock(_m);
+        return SimpleLRU::PutIfAbsent(key, hash, value, meta);
     }
 
     // see SimpleLRU.h
-    bool Set(const std::string &key, const std::string &value) override {
-        std::unique_lock<std::mutex> lock(_m);
-        return SimpleLRU::Set(key, value);
+    bool Set(const std::string &key, const std::string &value, const ItemMeta &meta = ItemMeta()) override {
+        std::unique_lock<Concurrency::SharedMutex> lock(_m);
+        return SimpleLRU::Set(key, value, meta);
     }
 
     // see SimpleLRU.h
     bool Delete(const std::string &key) override {
-        std::unique_lock<std::mutex> lock(_m);
+        std::unique_lock<Concurrency::SharedMutex> lock(_m);
         return SimpleLRU::Delete(key);
     }
 
+    // see SimpleLRU.h
+    CasResult CompareAndSet(const std::string &key, const std::string &value, const ItemMeta &meta,
+                            uint64_t cas) override {
+        std::unique_lock<Concurrency::SharedMutex> lock(_m);
+        return SimpleLRU::CompareAndSet(key, value, meta, cas);
+    }
+
+    // see SimpleLRU.h
+    CasResult CompareAndDelete(const std::string &key, uint64_t cas) override {
+        std::unique_lock<Concurrency::SharedMutex> lock(_m);
+        return SimpleLRU::CompareAndDelete(key, cas);
+    }
+
+    // see SimpleLRU.h
+    IncrResult Increment(const std::string &key, uint64_t delta, uint64_t &result) override {
+        std::unique_lock<Concurrency::SharedMutex> lock(_m);
+        return SimpleLRU::Increment(key, delta, result);
+    }
+
+    // see SimpleLRU.h
+    IncrResult Decrement(const std::string &key, uint64_t delta, uint64_t &result) override {
+        std::unique_lock<Concurrency::SharedMutex> lock(_m);
+        return SimpleLRU::Decrement(key, delta, result);
+    }
+
+    // see SimpleLRU.h
+    bool Append(const std::string &key, const std::string &data) override {
+        std::unique_lock<Concurrency::SharedMutex> lock(_m);
+        return SimpleLRU::Append(key, data);
+    }
+
+    // see SimpleLRU.h
+    bool Prepend(const std::string &key, const std::string &data) override {
+        std::unique_lock<Concurrency::SharedMutex> lock(_m);
+        return SimpleLRU::Prepend(key, data);
+    }
+
     // see SimpleLRU.h
     bool Get(const std::string &key, std::string &value) override {
-        std::unique_lock<std::mutex> lock(_m);
+        if (Policy() == EvictionPolicy::Clock) {
+            Concurrency::SharedLock lock(_m);
+            return SimpleLRU::Get(key, value);
+        }
+        std::unique_lock<Concurrency::SharedMutex> lock(_m);
         return SimpleLRU::Get(key, value);
     }
 
+    // see SimpleLRU.h
+    bool Get(const std::string &key, Value &value) override {
+        if (Policy() == EvictionPolicy::Clock) {
+            Concurrency::SharedLock lock(_m);
+            return SimpleLRU::Get(key, value);
+        }
+        std::unique_lock<Concurrency::SharedMutex> lock(_m);
+        return SimpleLRU::Get(key, value);
+    }
+
+    // see SimpleLRU.h
+    bool Get(const std::string &key, Value &value, ItemMeta &meta) override {
+        if (Policy() == EvictionPolicy::Clock) {
+            Concurrency::SharedLock lock(_m);
+            return SimpleLRU::Get(key, value, meta);
+        }
+        std::unique_lock<Concurrency::SharedMutex> lock(_m);
+        return SimpleLRU::Get(key, value, meta);
+    }
+
+    // see SimpleLRU.h
+    void GetBatch(const StringView *keys, const std::size_t *hashes, const std::vector<std::size_t> &pos,
+                  LookupResult *results) override {
+        if (Policy() == EvictionPolicy::Clock) {
+            Concurrency::SharedLock lock(_m);
+            SimpleLRU::GetBatch(keys, hashes, pos, results);
+            return;
+        }
+        std::unique_lock<Concurrency::SharedMutex> lock(_m);
+        SimpleLRU::GetBatch(keys, hashes, pos, results);
+    }
+
+    // see SimpleLRU.h
+    void PutBatch(const std::vector<std::string> &keys, const std::vector<std::string> &values,
+                  const std::vector<ItemMeta> &metas, const std::vector<std::size_t> &hashes,
+                  const std::vector<std::size_t> &pos, std::vector<bool> &stored) override {
+        std::unique_lock<Concurrency::SharedMutex> lock(_m);
+        SimpleLRU::PutBatch(keys, values, metas, hashes, pos, stored);
+    }
+
+    // see SimpleLRU.h, called by another storage holding its own lock, so it never waits for this one
+    std::size_t Reclaim(std::size_t bytes) override {
+        std::unique_lock<Concurrency::SharedMutex> lock(_m, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            return 0;
+        }
+        return SimpleLRU::Reclaim(bytes);
+    }
+
 private:
-    std::mutex _m;
+    Concurrency::SharedMutex _m;
 };
 
 } // namespace Backend
@@ -0,0 +1,158 @@
+#ifndef AFINA_STORAGE_TIMER_WHEEL_H
+#define AFINA_STORAGE_TIMER_WHEEL_H
+
+#include <cstdint>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Hierarchical timer wheel
+ * Tracks expiration times with one second resolution. There are 4 levels of 64 slots: level 0 slot
+ * covers one second, each next level slot covers 64 slots of the previous one, so wheel spans about
+ * 194 days, more distant timers are parked in the farthest slot and rescheduled once it comes.
+ *
+ * Schedule and Cancel are O(1). Advance visits each passed second once, when it reaches the beginning
+ * of higher level slot, timers of that slot get spread over lower levels. Timer fires in the second
+ * it expires.
+ *
+ * Timers are intrusive: owner embeds Hook into its objects, so wheel never allocates.
+ *
+ * That is NOT thread safe implementation!!
+ */
+class TimerWheel {
+public:
+    // Part of the object that gets scheduled
+    struct Hook {
+        Hook *prev;
+        Hook *next;
+        // Time in seconds when timer fires, 0 if there is no timer
+        uint32_t expire;
+
+        // Timer is in the wheel
+        inline bool scheduled() const { return next != nullptr; }
+    };
+
+    explicit TimerWheel(uint32_t now = 0) : _now(now), _size(0) {
+        for (auto &level : _slots) {
+            for (auto &slot : level) {
+                slot.prev = slot.next = &slot;
+                slot.expire = 0;
+            }
+        }
+    }
+
+    /**
+     * Adds timer firing at hook.expire. Timer that is already due fires on the next Advance
+     */
+    void Schedule(Hook &hook) {
+        place(hook, _now + 1);
+        _size++;
+    }
+
+    /**
+     * Removes timer from the wheel if it is there
+     */
+    void Cancel(Hook &hook) {
+        if (hook.scheduled()) {
+            unlink(hook);
+            _size--;
+        }
+    }
+
+    /**
+     * Moves wheel to the given time and calls expired(hook) for every timer due, hook is removed from
+     * the wheel already. Callback must not schedule new timers
+     */
+    template <typename F> void Advance(uint32_t now, F expired) {
+        if (_size == 0 && now > _now) {
+            _now = now;
+            return;
+        }
+        while (_now < now) {
+            _now++;
+            // Higher levels first: their timers could land in lower level slot that starts now
+            int top = 0;
+            while (top + 1 < Levels && (_now & ((uint32_t(1) << (SlotBits * (top + 1))) - 1)) == 0) {
+                top++;
+            }
+            for (int level = top; level > 0; --level) {
+                cascade(level);
+            }
+
+            Hook &slot = _slots[0][_now & SlotMask];
+            while (slot.next != &slot) {
+                Hook *hook = slot.next;
+                unlink(*hook);
+                _size--;
+                expired(*hook);
+            }
+        }
+    }
+
+    inline uint32_t Now() const { return _now; }
+
+    inline std::size_t Size() const { return _size; }
+
+private:
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    static const int Levels = 4;
+    static const int SlotBits = 6;
+    static const uint32_t SlotMask = (1 << SlotBits) - 1;
+
+    // Puts timer to the slot that comes not earlier than max(expire, earliest)
+    void place(Hook &hook, uint32_t earliest) {
+        uint32_t when = hook.expire > earliest ? hook.expire : earliest;
+        uint32_t delta = when - _now;
+        if (delta >= uint32_t(1) << (SlotBits * Levels)) {
+            // Too far, timer gets rescheduled once the last reachable slot comes
+            delta = (uint32_t(1) << (SlotBits * Levels)) - 1;
+            when = _now + delta;
+        }
+        int level = 0;
+        while (level + 1 < Levels && delta >= uint32_t(1) << (SlotBits * (level + 1))) {
+            level++;
+        }
+        link(_slots[level][(when >> (SlotBits * level)) & SlotMask], hook);
+    }
+
+    // Spreads timers of the level slot starting now over lower levels
+    void cascade(int level) {
+        Hook &slot = _slots[level][(_now >> (SlotBits * level)) & SlotMask];
+        Hook *hook = slot.next;
+        slot.prev = slot.next = &slot;
+        while (hook != &slot) {
+            Hook *next = hook->next;
+            place(*hook, _now);
+            hook = next;
+        }
+    }
+
+    static void link(Hook &slot, Hook &hook) {
+        hook.prev = slot.prev;
+        hook.next = &slot;
+        slot.prev->next = &hook;
+        slot.prev = &hook;
+    }
+
+    static void unlink(Hook &hook) {
+        hook.prev->next = hook.next;
+        hook.next->prev = hook.prev;
+        hook.prev = hook.next = nullptr;
+    }
+
+    // Circular lists with slots as sentinels
+    Hook _slots[Levels][1 << SlotBits];
+
+    // Last second processed
+    uint32_t _now;
+
+    std::size_t _size;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_TIMER_WHEEL_H
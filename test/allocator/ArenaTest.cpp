@@ -0,0 +1,89 @@
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <afina/allocator/Arena.h>
+#include <afina/allocator/Slab.h>
+#include <afina/allocator/StlAllocator.h>
+
+using namespace Afina::Allocator;
+
+TEST(ArenaTest, BlocksAreAligned) {
+    Arena arena(256);
+    std::vector<char *> blocks;
+    for (std::size_t i = 0; i < 1000; ++i) {
+        std::size_t size = i % 77 + 1;
+        char *block = static_cast<char *>(arena.Allocate(size));
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(block) % alignof(std::max_align_t), 0);
+        std::memset(block, i % 251, size);
+        blocks.push_back(block);
+    }
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+        for (std::size_t j = 0; j < i % 77 + 1; ++j) {
+            ASSERT_EQ(blocks[i][j], static_cast<char>(i % 251));
+        }
+    }
+}
+
+TEST(ArenaTest, ResetReusesMemory) {
+    Arena arena(1024);
+    void *first = arena.Allocate(100);
+    arena.Allocate(200);
+    EXPECT_EQ(arena.Used(), 300);
+    arena.Reset();
+    EXPECT_EQ(arena.Used(), 0);
+    EXPECT_EQ(arena.Allocate(100), first);
+
+    // Round that needed several chunks leaves one chunk large enough for it
+    for (int i = 0; i < 100; ++i) {
+        arena.Allocate(500);
+    }
+    arena.Reset();
+    std::size_t capacity = arena.Capacity();
+    EXPECT_GE(capacity, 50000);
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < 100; ++i) {
+            arena.Allocate(500);
+        }
+        arena.Reset();
+        EXPECT_EQ(arena.Capacity(), capacity);
+    }
+}
+
+TEST(ArenaTest, RetainedIsLimited) {
+    Arena arena(1024, 8192);
+    arena.Allocate(100000);
+    arena.Reset();
+    EXPECT_EQ(arena.Capacity(), 8192);
+}
+
+TEST(ArenaTest, Containers) {
+    Arena arena;
+    ArenaVector<ArenaString> strings{StlAllocator<ArenaString, Arena>(&arena)};
+    for (int i = 0; i < 100; ++i) {
+        strings.emplace_back(std::string(i, 'a').c_str(), StlAllocator<char, Arena>(&arena));
+    }
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(strings[i].size(), i);
+        EXPECT_EQ(strings[i].get_allocator().resource(), &arena);
+    }
+    EXPECT_GT(arena.Used(), 100 * 99 / 2);
+
+    ArenaVector<ArenaString> other{StlAllocator<ArenaString, Arena>(&arena)};
+    other.swap(strings);
+    EXPECT_EQ(other.size(), 100);
+    EXPECT_TRUE(strings.empty());
+}
+
+TEST(ArenaTest, SlabResource) {
+    Slab slab;
+    std::vector<int, StlAllocator<int, Slab>> numbers{StlAllocator<int, Slab>(&slab)};
+    for (int i = 0; i < 10000; ++i) {
+        numbers.push_back(i);
+    }
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_EQ(numbers[i], i);
+    }
+    EXPECT_GT(slab.MemoryUsage(), 0);
+}
@@ -322,3 +322,78 @@ TEST(SimpleTest, ReallocGrow) {
     a.free(p);
     a.free(p2);
 }
+
+TEST(SimpleTest, DefragInSlices) {
+    Simple a(buf, sizeof(buf));
+
+    vector<Pointer> ptrs;
+    int size = 135;
+
+    ASSERT_TRUE(fillUp(a, size, ptrs));
+    for (size_t i = 0; i < ptrs.size(); i += 2) {
+        a.free(ptrs[i]);
+    }
+    EXPECT_GT(a.holes(), 0);
+
+    // Blocks are allocated and freed in between the slices
+    vector<Pointer> more;
+    int slices = 0;
+    while (!a.defrag(1024)) {
+        slices++;
+        if (slices % 3 == 0) {
+            more.push_back(a.alloc(size));
+            writeTo(more.back(), size);
+        }
+        if (slices % 5 == 0 && ptrs.size() > 1) {
+            a.free(ptrs[ptrs.size() - 1]);
+            ptrs.pop_back();
+        }
+    }
+    EXPECT_GT(slices, 1);
+    EXPECT_EQ(a.holes(), 0);
+
+    for (Pointer &p : ptrs) {
+        if (p.get() != nullptr) {
+            EXPECT_TRUE(isDataOk(p, size));
+        }
+    }
+    for (Pointer &p : more) {
+        EXPECT_TRUE(isDataOk(p, size));
+    }
+}
+
+TEST(SimpleTest, InvalidFree) {
+    Simple a(buf, sizeof(buf));
+
+    Pointer p = a.alloc(100);
+    Pointer copy = p;
+    a.free(p);
+    EXPECT_EQ(p.get(), nullptr);
+
+    try {
+        a.free(copy);
+        EXPECT_TRUE(false);
+    } catch (AllocError &e) {
+        EXPECT_EQ(e.getType(), AllocErrorType::InvalidFree);
+    }
+
+    // Slot released last links to the one released before it, neither is a block
+    Pointer first = a.alloc(100), second = a.alloc(100);
+    Pointer stale_first = first, stale_second = second;
+    a.free(first);
+    a.free(second);
+    for (Pointer *stale : {&stale_first, &stale_second}) {
+        try {
+            a.free(*stale);
+            EXPECT_TRUE(false);
+        } catch (AllocError &e) {
+            EXPECT_EQ(e.getType(), AllocErrorType::InvalidFree);
+        }
+        try {
+            a.realloc(*stale, 200);
+            EXPECT_TRUE(false);
+        } catch (AllocError &e) {
+            EXPECT_EQ(e.getType(), AllocErrorType::InvalidFree);
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <afina/allocator/Slab.h>
+
+using namespace Afina::Allocator;
+
+TEST(SlabTest, SizeClasses) {
+    std::size_t last = 0;
+    for (std::size_t size = 0; size <= Slab::MaxSize; ++size) {
+        std::size_t usable = Slab::UsableSize(size);
+        EXPECT_GE(usable, std::max(size, Slab::MinSize));
+        EXPECT_GE(usable, last);
+        EXPECT_EQ(usable % Slab::Alignment, 0);
+        // Rounding wastes less than a quarter of the block
+        if (size > Slab::MinSize) {
+            EXPECT_LT((usable - size) * 4, usable);
+        }
+        last = usable;
+    }
+    EXPECT_EQ(Slab::UsableSize(Slab::MaxSize + 1), Slab::MaxSize + 1);
+}
+
+TEST(SlabTest, BlocksDontOverlap) {
+    Slab slab;
+    std::vector<std::pair<char *, std::size_t>> blocks;
+    for (std::size_t i = 0; i < 5000; ++i) {
+        std::size_t size = (i * 37) % (Slab::MaxSize + 1000);
+        char *block = static_cast<char *>(slab.Allocate(size));
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(block) % Slab::Alignment, 0);
+        std::memset(block, i % 251, size);
+        blocks.emplace_back(block, size);
+    }
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+        for (std::size_t j = 0; j < blocks[i].second; ++j) {
+            ASSERT_EQ(blocks[i].first[j], static_cast<char>(i % 251));
+        }
+    }
+    for (auto &block : blocks) {
+        Slab::Release(block.first, block.second);
+    }
+}
+
+TEST(SlabTest, MemoryIsReused) {
+    Slab slab;
+    for (int round = 0; round < 10; ++round) {
+        std::vector<void *> blocks;
+        for (int i = 0; i < 10000; ++i) {
+            blocks.push_back(slab.Allocate(100));
+        }
+        for (void *block : blocks) {
+            Slab::Release(block, 100);
+        }
+    }
+    // 10000 blocks of 112 bytes fit into 18 pages of one chunk
+    EXPECT_EQ(slab.MemoryUsage(), 64 * Slab::PageSize);
+}
+
+TEST(SlabTest, ReleasedByOtherThread) {
+    Slab slab;
+    std::vector<void *> blocks;
+    for (int i = 0; i < 1000; ++i) {
+        blocks.push_back(slab.Allocate(200));
+    }
+    std::thread([&blocks]() {
+        for (void *block : blocks) {
+            Slab::Release(block, 200);
+        }
+    }).join();
+
+    // Blocks given back by other thread are found again
+    std::set<void *> before(blocks.begin(), blocks.end());
+    std::size_t reused = 0;
+    for (int i = 0; i < 1000; ++i) {
+        reused += before.count(slab.Allocate(200));
+    }
+    EXPECT_GT(reused, 900);
+}
+
+TEST(SlabTest, Dump) {
+    Slab slab;
+    std::vector<void *> blocks;
+    for (int i = 0; i < 100; ++i) {
+        blocks.push_back(slab.Allocate(1000));
+    }
+    Slab::Release(blocks.back(), 1000);
+
+    std::string dump = slab.dump();
+    std::size_t line = dump.find('\n') + 1;
+    ASSERT_NE(dump.find("total: 2 pages"), std::string::npos) << dump;
+
+    unsigned size_class, size, pages, used, cached, free;
+    ASSERT_EQ(sscanf(dump.c_str() + line, "%u %u %u %u %u %u", &size_class, &size, &pages, &used, &cached, &free), 6)
+        << dump;
+    EXPECT_EQ(size, Slab::UsableSize(1000));
+    EXPECT_EQ(pages, 2);
+    EXPECT_EQ(used, 99);
+    EXPECT_EQ(used + cached + free, 2 * ((Slab::PageSize - 64) / size));
+}
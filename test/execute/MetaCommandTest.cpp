@@ -0,0 +1,90 @@
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+
+#include <afina/execute/MetaArithmetic.h>
+#include <afina/execute/MetaDelete.h>
+#include <afina/execute/MetaGet.h>
+#include <afina/execute/MetaNoOp.h>
+#include <afina/execute/MetaSet.h>
+
+#include "storage/SimpleLRU.h"
+
+using namespace Afina;
+using namespace Afina::Execute;
+
+// Runs command and returns its response
+static std::string run(Command &&command, Storage &storage, const std::string &args = "") {
+    std::string out;
+    command.Execute(storage, args, out);
+    return out;
+}
+
+TEST(MetaCommandTest, SetGet) {
+    Backend::SimpleLRU storage;
+    EXPECT_EQ("HD", run(MetaSet("foo", {"F5"}), storage, "bar"));
+
+    // Only asked attributes are returned, in the order of request
+    EXPECT_EQ("HD", run(MetaGet("foo", {}), storage));
+    EXPECT_EQ("VA 3 f5\r\nbar", run(MetaGet("foo", {"v", "f"}), storage));
+    EXPECT_EQ("HD s3 Oxyz kfoo t-1", run(MetaGet("foo", {"s", "Oxyz", "k", "t"}), storage));
+
+    EXPECT_EQ("EN", run(MetaGet("baz", {"v"}), storage));
+    EXPECT_EQ("", run(MetaGet("baz", {"v", "q"}), storage));
+    EXPECT_EQ("CLIENT_ERROR invalid flag", run(MetaGet("foo", {"x"}), storage));
+}
+
+TEST(MetaCommandTest, SetModes) {
+    Backend::SimpleLRU storage;
+    EXPECT_EQ("", run(MetaSet("foo", {"q"}), storage, "bar"));
+    EXPECT_EQ("NS Oa", run(MetaSet("foo", {"ME", "Oa", "q"}), storage, "new"));
+    EXPECT_EQ("HD", run(MetaSet("foo", {"MA"}), storage, "!"));
+    EXPECT_EQ("HD", run(MetaSet("foo", {"MP"}), storage, "<"));
+    EXPECT_EQ("NS", run(MetaSet("baz", {"MR"}), storage, "x"));
+    EXPECT_EQ("VA 5\r\n<bar!", run(MetaGet("foo", {"v"}), storage));
+
+    // Compare and swap with the version mg returns
+    std::string response = run(MetaGet("foo", {"c"}), storage);
+    std::string cas = response.substr(response.find('c') + 1);
+    EXPECT_EQ("HD", run(MetaSet("foo", {"C" + cas}), storage, "swapped"));
+    EXPECT_EQ("EX", run(MetaSet("foo", {"C" + cas}), storage, "again"));
+
+    EXPECT_EQ("CLIENT_ERROR bad token in command line format", run(MetaSet("foo", {"Tx"}), storage, "x"));
+    EXPECT_EQ("CLIENT_ERROR invalid mode for ms", run(MetaSet("foo", {"MZ"}), storage, "x"));
+}
+
+TEST(MetaCommandTest, Delete) {
+    Backend::SimpleLRU storage;
+    run(MetaSet("foo", {}), storage, "bar");
+    EXPECT_EQ("EX", run(MetaDelete("foo", {"C123456"}), storage));
+    EXPECT_EQ("HD kfoo", run(MetaDelete("foo", {"k"}), storage));
+    EXPECT_EQ("NF", run(MetaDelete("foo", {"q"}), storage));
+
+    run(MetaSet("foo", {}), storage, "bar");
+    EXPECT_EQ("", run(MetaDelete("foo", {"q"}), storage));
+    EXPECT_EQ("EN", run(MetaGet("foo", {}), storage));
+
+    // Newer version survives delete based on the stale one
+    run(MetaSet("foo", {}), storage, "bar");
+    std::string response = run(MetaGet("foo", {"c"}), storage);
+    std::string stale = response.substr(response.find('c') + 1);
+    run(MetaSet("foo", {}), storage, "newer");
+    EXPECT_EQ("EX", run(MetaDelete("foo", {"C" + stale}), storage));
+    EXPECT_EQ("VA 5\r\nnewer", run(MetaGet("foo", {"v"}), storage));
+    response = run(MetaGet("foo", {"c"}), storage);
+    EXPECT_EQ("HD", run(MetaDelete("foo", {"C" + response.substr(response.find('c') + 1)}), storage));
+    EXPECT_EQ("NF", run(MetaDelete("foo", {"C" + stale}), storage));
+}
+
+TEST(MetaCommandTest, Arithmetic) {
+    Backend::SimpleLRU storage;
+    EXPECT_EQ("NF", run(MetaArithmetic("n", {}), storage));
+    EXPECT_EQ("VA 2\r\n10", run(MetaArithmetic("n", {"N0", "J10", "v"}), storage));
+    EXPECT_EQ("HD", run(MetaArithmetic("n", {"D5"}), storage));
+    EXPECT_EQ("", run(MetaArithmetic("n", {"q"}), storage));
+    EXPECT_EQ("VA 1 Oz\r\n0", run(MetaArithmetic("n", {"MD", "D100", "v", "Oz"}), storage));
+
+    run(MetaSet("s", {}), storage, "abc");
+    EXPECT_EQ("CLIENT_ERROR cannot increment or decrement non-numeric value", run(MetaArithmetic("s", {}), storage));
+    EXPECT_EQ("MN", run(MetaNoOp(), storage));
+}
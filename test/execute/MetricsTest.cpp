@@ -0,0 +1,120 @@
+#include "gtest/gtest.h"
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/ThreadLocal.h>
+#include <afina/execute/Get.h>
+#include <afina/execute/Metrics.h>
+#include <afina/execute/Set.h>
+#include <afina/execute/Stats.h>
+
+#include "storage/SimpleLRU.h"
+
+using namespace Afina;
+using namespace Afina::Execute;
+
+// Parses stats response into name -> value
+static std::map<std::string, uint64_t> parseStats(const std::string &out) {
+    std::map<std::string, uint64_t> stats;
+    std::size_t pos = 0;
+    while (out.compare(pos, 5, "STAT ") == 0) {
+        std::size_t name_end = out.find(' ', pos + 5);
+        std::size_t line_end = out.find("\r\n", name_end);
+        stats[out.substr(pos + 5, name_end - pos - 5)] = std::stoull(out.substr(name_end + 1, line_end - name_end - 1));
+        pos = line_end + 2;
+    }
+    EXPECT_EQ(out.substr(pos), "END");
+    return stats;
+}
+
+TEST(MetricsTest, HistogramBuckets) {
+    using Histogram = Metrics::Histogram;
+    std::size_t last = 0;
+    std::vector<uint64_t> values = {0, 1, 7, 8, 9, 15, 16, 17, 1000, 123456789, 1ull << 40, (1ull << 63) + 5, UINT64_MAX};
+    for (uint64_t value : values) {
+        std::size_t bucket = Histogram::BucketOf(value);
+        ASSERT_LT(bucket, Histogram::BucketsCount);
+        EXPECT_GE(bucket, last);
+        last = bucket;
+        EXPECT_LE(Histogram::LowerBound(bucket), value);
+        if (bucket + 1 < Histogram::BucketsCount) {
+            uint64_t next = Histogram::LowerBound(bucket + 1);
+            EXPECT_GT(next, value);
+            // Bucket is at most 1/8 of its lower bound wide
+            EXPECT_LE((next - Histogram::LowerBound(bucket)) * 8, std::max<uint64_t>(Histogram::LowerBound(bucket), 8));
+        }
+    }
+    EXPECT_EQ(Histogram::BucketOf(UINT64_MAX), Histogram::BucketsCount - 1);
+}
+
+TEST(MetricsTest, ThreadLocalValues) {
+    Concurrency::ThreadLocal<Metrics::Counter> counters;
+    std::vector<std::thread> threads;
+    for (int t = 1; t <= 4; ++t) {
+        threads.emplace_back([&counters, t]() {
+            for (int i = 0; i < 1000; ++i) {
+                counters.Get().Add(t);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    counters.Get().Add(5);
+
+    // Values of finished threads stay
+    std::size_t count = 0;
+    uint64_t sum = 0;
+    counters.ForEach([&](const Metrics::Counter &counter) {
+        count++;
+        sum += counter.Load();
+    });
+    EXPECT_EQ(count, 5);
+    EXPECT_EQ(sum, 10005);
+}
+
+TEST(MetricsTest, StatsCommand) {
+    Backend::SimpleLRU storage(1024 * 1024, Backend::SimpleLRU::IndexType::Hash);
+    std::string out;
+    Stats stats;
+    stats.Execute(storage, "", out);
+    std::map<std::string, uint64_t> before = parseStats(out);
+
+    std::thread([&storage, &out]() {
+        Set set("KEY", 0, 0);
+        {
+            Metrics::Timer timer(set.Type());
+            set.Execute(storage, "value", out);
+        }
+        Get get({"KEY", "MISSING", "KEY"});
+        {
+            Metrics::Timer timer(get.Type());
+            get.Execute(storage, "", out);
+        }
+    }).join();
+
+    stats.Execute(storage, "", out);
+    std::map<std::string, uint64_t> after = parseStats(out);
+    EXPECT_EQ(after["cmd_set"] - before["cmd_set"], 1);
+    EXPECT_EQ(after["cmd_get"] - before["cmd_get"], 3);
+    EXPECT_EQ(after["get_hits"] - before["get_hits"], 2);
+    EXPECT_EQ(after["get_misses"] - before["get_misses"], 1);
+    EXPECT_EQ(after["curr_items"], 1);
+    EXPECT_EQ(after["bytes"], 8);
+    EXPECT_EQ(after["limit_maxbytes"], 1024 * 1024);
+    EXPECT_GE(after["latency:get:count"], 1);
+    EXPECT_LE(after["latency:get:p50_ns"], after["latency:get:max_ns"]);
+    EXPECT_GT(after["latency:get:max_ns"], 0);
+
+    // Thread that executed commands has own counters
+    bool found = false;
+    for (auto &stat : after) {
+        if (stat.first.find("thread:") == 0 && stat.first.find(":get_misses") != std::string::npos &&
+            stat.second == 1) {
+            found = true;
+        }
+    }
+    EXPECT_TRUE(found);
+}
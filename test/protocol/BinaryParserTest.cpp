@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <afina/execute/Command.h>
+
+#include <protocol/BinaryCommand.h>
+#include <protocol/BinaryParser.h>
+#include <protocol/Parser.h>
+#include <storage/SimpleLRU.h>
+
+using namespace Afina;
+using Protocol::BinaryCommand;
+
+// Big endian number of the given width
+static std::string number(uint64_t value, std::size_t bytes) {
+    std::string out;
+    for (std::size_t i = bytes; i > 0; i--) {
+        out.push_back(static_cast<char>((value >> (8 * (i - 1))) & 0xff));
+    }
+    return out;
+}
+
+static uint64_t number(const std::string &in, std::size_t offset, std::size_t bytes) {
+    uint64_t value = 0;
+    for (std::size_t i = 0; i < bytes; i++) {
+        value = (value << 8) | static_cast<uint8_t>(in[offset + i]);
+    }
+    return value;
+}
+
+// Request header followed by extras and key, value is the body left for the caller
+static std::string request(uint8_t opcode, const std::string &key, const std::string &extras = "",
+                           std::size_t value_size = 0, uint32_t opaque = 0, uint64_t cas = 0) {
+    std::string out;
+    out.push_back(static_cast<char>(0x80));
+    out.push_back(static_cast<char>(opcode));
+    out.append(number(key.size(), 2));
+    out.push_back(static_cast<char>(extras.size()));
+    out.append(number(0, 3));
+    out.append(number(extras.size() + key.size() + value_size, 4));
+    out.append(number(opaque, 4));
+    out.append(number(cas, 8));
+    return out + extras + key;
+}
+
+// Parses request out and executes it, returns response
+static std::string run(Storage &storage, const std::string &input, const std::string &value = "") {
+    Protocol::BinaryParser parser;
+    size_t parsed = 0;
+    EXPECT_TRUE(parser.Parse(input.data(), input.size(), parsed));
+    EXPECT_EQ(input.size(), parsed);
+
+    size_t body_size = 0;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(body_size);
+    EXPECT_FALSE(cmd == nullptr);
+    EXPECT_EQ(value.size(), body_size);
+
+    std::string out;
+    cmd->Execute(storage, value, out);
+    return out;
+}
+
+static uint16_t status(const std::string &response) { return number(response, 6, 2); }
+
+TEST(BinaryParserTest, Detect) {
+    std::unique_ptr<Protocol::Frontend> binary = Protocol::Frontend::Create(static_cast<char>(0x80), true);
+    EXPECT_TRUE(dynamic_cast<Protocol::BinaryParser *>(binary.get()) != nullptr);
+    EXPECT_EQ(0, binary->BodyTrailer());
+    EXPECT_TRUE(binary->ResponseTrailer().empty());
+
+    std::unique_ptr<Protocol::Frontend> text = Protocol::Frontend::Create('g', true);
+    EXPECT_TRUE(dynamic_cast<Protocol::Parser *>(text.get()) != nullptr);
+    EXPECT_EQ(2, text->BodyTrailer());
+}
+
+TEST(BinaryParserTest, SimpleSet) {
+    Protocol::BinaryParser parser(true);
+    std::string input = request(BinaryCommand::Set, "foo", number(5, 4) + number(60, 4), 6, 0xdeadbeef) + "fooval";
+
+    size_t parsed = 0;
+    ASSERT_TRUE(parser.Parse(input.data(), input.size(), parsed));
+    ASSERT_EQ(24 + 8 + 3, parsed);
+    ASSERT_EQ("set", parser.Name());
+    ASSERT_EQ(1, parser.Keys().size());
+    // Key is a view into the input
+    ASSERT_EQ(input.data() + 32, parser.Keys()[0].data());
+
+    size_t body_size = 0;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(body_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ(6, body_size);
+
+    BinaryCommand *tmp = dynamic_cast<BinaryCommand *>(cmd.get());
+    ASSERT_TRUE(tmp != nullptr);
+    ASSERT_EQ(BinaryCommand::Set, tmp->opcode());
+    ASSERT_EQ(0xdeadbeef, tmp->opaque());
+    ASSERT_EQ("foo", tmp->key());
+    ASSERT_EQ(8, tmp->extras().size());
+}
+
+TEST(BinaryParserTest, SplitInput) {
+    std::string input = request(BinaryCommand::GetK, "some_key", "", 0, 7) + "rest";
+    for (std::size_t split = 1; split < input.size() - 4; ++split) {
+        Protocol::BinaryParser parser(true);
+        std::string first = input.substr(0, split);
+        std::string second = input.substr(split);
+
+        size_t parsed = 0;
+        ASSERT_FALSE(parser.Parse(first.data(), first.size(), parsed));
+        ASSERT_EQ(split, parsed);
+        // Nothing refers to the first piece once it is consumed
+        first.assign(first.size(), 'x');
+        ASSERT_TRUE(parser.Parse(second.data(), second.size(), parsed));
+        ASSERT_EQ(input.size() - 4 - split, parsed);
+        ASSERT_EQ("getk", parser.Name());
+        ASSERT_EQ("some_key", parser.Keys()[0].str());
+    }
+}
+
+TEST(BinaryParserTest, BadHeader) {
+    Protocol::BinaryParser parser;
+    std::string input = request(BinaryCommand::Get, "foo");
+    size_t parsed = 0;
+
+    input[0] = 'g';
+    ASSERT_THROW(parser.Parse(input.data(), input.size(), parsed), std::runtime_error);
+
+    // Body is shorter than extras and key
+    parser.Reset();
+    input = request(BinaryCommand::Get, "foo");
+    input[11] = 2;
+    ASSERT_THROW(parser.Parse(input.data(), input.size(), parsed), std::runtime_error);
+}
+
+TEST(BinaryParserTest, SetGet) {
+    Backend::SimpleLRU storage;
+    std::string response = run(storage, request(BinaryCommand::Set, "foo", number(5, 4) + number(0, 4), 3, 42), "bar");
+    ASSERT_EQ(24, response.size());
+    ASSERT_EQ(0x81, static_cast<uint8_t>(response[0]));
+    ASSERT_EQ(BinaryCommand::Set, response[1]);
+    ASSERT_EQ(BinaryCommand::Success, status(response));
+    ASSERT_EQ(42, number(response, 12, 4));
+
+    response = run(storage, request(BinaryCommand::GetK, "foo", "", 0, 43));
+    ASSERT_EQ(BinaryCommand::Success, status(response));
+    ASSERT_EQ(3, number(response, 2, 2));
+    ASSERT_EQ(4, static_cast<uint8_t>(response[4]));
+    ASSERT_EQ(4 + 3 + 3, number(response, 8, 4));
+    ASSERT_EQ(43, number(response, 12, 4));
+    ASSERT_EQ(5, number(response, 24, 4));
+    ASSERT_EQ("foobar", response.substr(28));
+
+    response = run(storage, request(BinaryCommand::Get, "baz"));
+    ASSERT_EQ(BinaryCommand::KeyNotFound, status(response));
+    ASSERT_EQ("Not found", response.substr(24));
+}
+
+TEST(BinaryParserTest, QuietCommands) {
+    Backend::SimpleLRU storage;
+    std::string extras = number(0, 4) + number(0, 4);
+    ASSERT_EQ("", run(storage, request(BinaryCommand::SetQ, "foo", extras, 3), "bar"));
+    ASSERT_EQ("", run(storage, request(BinaryCommand::GetQ, "baz")));
+    ASSERT_EQ(24 + 4 + 3, run(storage, request(BinaryCommand::GetQ, "foo")).size());
+
+    // Errors are sent anyway
+    std::string response = run(storage, request(BinaryCommand::AddQ, "foo", extras, 3), "new");
+    ASSERT_EQ(BinaryCommand::KeyExists, status(response));
+    ASSERT_EQ(BinaryCommand::AddQ, response[1]);
+
+    ASSERT_EQ("", run(storage, request(BinaryCommand::DeleteQ, "foo")));
+    response = run(storage, request(BinaryCommand::DeleteQ, "foo"));
+    ASSERT_EQ(BinaryCommand::KeyNotFound, status(response));
+
+    ASSERT_EQ(BinaryCommand::Success, status(run(storage, request(BinaryCommand::NoOp, ""))));
+}
+
+TEST(BinaryParserTest, IncrDecr) {
+    Backend::SimpleLRU storage;
+    // Missing item is created with the initial value
+    std::string response = run(storage, request(BinaryCommand::Increment, "n", number(5, 8) + number(10, 8) + number(0, 4)));
+    ASSERT_EQ(BinaryCommand::Success, status(response));
+    ASSERT_EQ(10, number(response, 24, 8));
+
+    response = run(storage, request(BinaryCommand::Increment, "n", number(5, 8) + number(10, 8) + number(0, 4)));
+    ASSERT_EQ(15, number(response, 24, 8));
+
+    response = run(storage, request(BinaryCommand::Decrement, "n", number(20, 8) + number(0, 8) + number(0, 4)));
+    ASSERT_EQ(0, number(response, 24, 8));
+
+    // Unless expire time is all ones
+    response = run(storage, request(BinaryCommand::Decrement, "m", number(1, 8) + number(0, 8) + number(0xffffffff, 4)));
+    ASSERT_EQ(BinaryCommand::KeyNotFound, status(response));
+}
+
+TEST(BinaryParserTest, Errors) {
+    Backend::SimpleLRU storage;
+    std::string response = run(storage, request(BinaryCommand::Version, ""));
+    ASSERT_EQ(BinaryCommand::UnknownCommand, status(response));
+    ASSERT_EQ("Unknown command", response.substr(24));
+
+    // Set needs flags and expire time
+    response = run(storage, request(BinaryCommand::Set, "foo", "", 3), "bar");
+    ASSERT_EQ(BinaryCommand::InvalidArguments, status(response));
+
+    response = run(storage, request(BinaryCommand::Replace, "foo", number(0, 8), 3), "bar");
+    ASSERT_EQ(BinaryCommand::KeyNotFound, status(response));
+}
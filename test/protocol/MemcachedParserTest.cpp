@@ -4,7 +4,16 @@
 #include <string>
 
 #include <afina/execute/Add.h>
+#include <afina/execute/Cas.h>
+#include <afina/execute/Decr.h>
+#include <afina/execute/Delete.h>
 #include <afina/execute/Get.h>
+#include <afina/execute/Incr.h>
+#include <afina/execute/MetaArithmetic.h>
+#include <afina/execute/MetaGet.h>
+#include <afina/execute/MetaNoOp.h>
+#include <afina/execute/MetaSet.h>
+#include <afina/execute/Replace.h>
 #include <afina/execute/Set.h>
 #include <afina/execute/Stats.h>
 
@@ -58,6 +67,84 @@ TEST(MemcachedParserTest, SimpleAdd) {
     ASSERT_EQ(-1, tmp->expire());
 }
 
+// Verify multi-digit expire time, both relative and negative
+TEST(MemcachedParserTest, ExpireTime) {
+    for (auto test : {std::make_pair(std::string("set foo 0 3600 1\r\n"), 3600),
+                      std::make_pair(std::string("set foo 0 1700000000 1\r\n"), 1700000000),
+                      std::make_pair(std::string("set foo 0 -120 1\r\n"), -120)}) {
+        Protocol::Parser parser;
+        size_t consumed = 0;
+        ASSERT_TRUE(parser.Parse(test.first, consumed));
+
+        size_t value_size;
+        std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+        ASSERT_FALSE(cmd == nullptr);
+        Execute::Set *tmp = reinterpret_cast<Execute::Set *>(cmd.get());
+        ASSERT_EQ(test.second, tmp->expire());
+    }
+}
+
+// Verify cas command with 64-bit version
+TEST(MemcachedParserTest, SimpleCas) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    bool cmd_avail = parser.Parse("cas foo 3 0 6 18446744073709551615\r\nfooval\r\n", consumed);
+    ASSERT_TRUE(cmd_avail);
+    ASSERT_EQ(36, consumed);
+    ASSERT_EQ("cas", parser.Name());
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ(6, value_size);
+
+    Execute::Cas *tmp = reinterpret_cast<Execute::Cas *>(cmd.get());
+    ASSERT_EQ("foo", tmp->key());
+    ASSERT_EQ(3, tmp->flags());
+    ASSERT_EQ(UINT64_MAX, tmp->cas());
+}
+
+// Verify gets command asks for versions
+TEST(MemcachedParserTest, SimpleGets) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    ASSERT_TRUE(parser.Parse("gets foo bar\r\n", consumed));
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    Execute::Get *tmp = reinterpret_cast<Execute::Get *>(cmd.get());
+    ASSERT_EQ(2, tmp->keys().size());
+    ASSERT_TRUE(tmp->withCas());
+}
+
+// Verify incr and decr commands
+TEST(MemcachedParserTest, IncrDecr) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    ASSERT_TRUE(parser.Parse("incr foo 18446744073709551615\r\n", consumed));
+    ASSERT_EQ(31, consumed);
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ(0, value_size);
+    Execute::Incr *incr = reinterpret_cast<Execute::Incr *>(cmd.get());
+    ASSERT_EQ("foo", incr->key());
+    ASSERT_EQ(UINT64_MAX, incr->delta());
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("decr bar 42\r\n", consumed));
+    cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    Execute::Decr *decr = reinterpret_cast<Execute::Decr *>(cmd.get());
+    ASSERT_EQ("bar", decr->key());
+    ASSERT_EQ(42, decr->delta());
+}
+
 // Verify simple get command passed in a single string
 TEST(MemcachedParserTest, SimpleGet) {
     Protocol::Parser parser;
@@ -74,11 +161,17 @@ TEST(MemcachedParserTest, SimpleGet) {
     ASSERT_EQ(0, value_size);
 
     Execute::Get *tmp = reinterpret_cast<Execute::Get *>(cmd.get());
-    std::vector<std::string> keys = tmp->keys();
+    const std::vector<StringView> &keys = tmp->keys();
     ASSERT_EQ(3, keys.size());
-    ASSERT_EQ("ke", keys[0]);
-    ASSERT_EQ("key2", keys[1]);
-    ASSERT_EQ("super_long_key", keys[2]);
+    ASSERT_EQ("ke", keys[0].str());
+    ASSERT_EQ("key2", keys[1].str());
+    ASSERT_EQ("super_long_key", keys[2].str());
+
+    // Hashes are computed by the parser and travel along with keys
+    ASSERT_EQ(3, tmp->hashes().size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        ASSERT_EQ(KeyHash(keys[i].str()), tmp->hashes()[i]);
+    }
 }
 
 TEST(MemcachedParserTest, Stats) {
@@ -98,3 +191,174 @@ TEST(MemcachedParserTest, Stats) {
     Execute::Stats *tmp = reinterpret_cast<Execute::Stats *>(cmd.get());
     ASSERT_FALSE(tmp == nullptr);
 }
+
+// Verify fields split between inputs at any position, as well as keys longer than a few blocks scanned at once
+TEST(MemcachedParserTest, SplitInput) {
+    std::string key(100, 'k');
+    key[37] = 'x';
+    std::string input = "cas " + key + " 4294967295 -1700000000 1048576 18446744073709551615\r\n";
+    for (size_t split = 0; split < input.size(); ++split) {
+        Protocol::Parser parser;
+        size_t consumed = 0;
+        ASSERT_FALSE(parser.Parse(input.data(), split, consumed));
+        ASSERT_EQ(split, consumed);
+        ASSERT_TRUE(parser.Parse(input.data() + split, input.size() - split, consumed)) << split;
+        ASSERT_EQ(input.size() - split, consumed);
+
+        size_t value_size;
+        std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+        ASSERT_FALSE(cmd == nullptr);
+        ASSERT_EQ(1048576, value_size);
+        Execute::Cas *tmp = reinterpret_cast<Execute::Cas *>(cmd.get());
+        ASSERT_EQ(key, tmp->key());
+        ASSERT_EQ(UINT32_MAX, tmp->flags());
+        ASSERT_EQ(-1700000000, tmp->expire());
+        ASSERT_EQ(UINT64_MAX, tmp->cas());
+    }
+}
+
+// Verify numbers not fitting their fields are rejected
+TEST(MemcachedParserTest, Overflow) {
+    for (auto input : {"set foo 4294967296 0 1\r\n", "set foo 0 2147483648 1\r\n", "set foo 0 0 4294967296\r\n",
+                       "cas foo 0 0 1 18446744073709551616\r\n", "incr foo 18446744073709551616\r\n"}) {
+        Protocol::Parser parser;
+        size_t consumed = 0;
+        ASSERT_THROW(parser.Parse(input, consumed), std::runtime_error) << input;
+    }
+}
+
+// Verify keys point into the input in views mode, unless command spans several inputs
+TEST(MemcachedParserTest, KeyViews) {
+    std::string input = "get";
+    for (int i = 0; i < 100; ++i) {
+        input += " key" + std::to_string(i);
+    }
+    input += "\r\n";
+
+    Protocol::Parser parser(true);
+    size_t consumed = 0;
+    ASSERT_TRUE(parser.Parse(input, consumed));
+    ASSERT_EQ(100, parser.Keys().size());
+    for (int i = 0; i < 100; ++i) {
+        StringView key = parser.Keys()[i];
+        ASSERT_EQ("key" + std::to_string(i), key.str());
+        ASSERT_TRUE(key.data() > input.data() && key.data() < input.data() + input.size());
+    }
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    Execute::Get *get = reinterpret_cast<Execute::Get *>(cmd.get());
+    ASSERT_EQ(parser.Keys()[42].data(), get->keys()[42].data());
+
+    // Input is changed after each part, as connection compacts its buffer
+    for (size_t split = 1; split < input.size(); split += 7) {
+        parser.Reset();
+        std::string first = input.substr(0, split), rest = input.substr(split);
+        ASSERT_FALSE(parser.Parse(first, consumed));
+        std::fill(first.begin(), first.end(), '#');
+        ASSERT_TRUE(parser.Parse(rest, consumed));
+        ASSERT_EQ(100, parser.Keys().size());
+        for (int i = 0; i < 100; ++i) {
+            ASSERT_EQ("key" + std::to_string(i), parser.Keys()[i].str()) << split;
+        }
+    }
+}
+
+// Verify meta commands keep their flags as tokens, ms data length goes to body size
+TEST(MemcachedParserTest, MetaCommands) {
+    Protocol::Parser parser;
+    std::string input = "ms foo 6 T30 F5 q Oab\r\nfooval\r\n";
+
+    // Same result whatever the input is cut into
+    for (size_t split = 1; split < 23; ++split) {
+        parser.Reset();
+        size_t consumed = 0, total = 0;
+        ASSERT_FALSE(parser.Parse(input.substr(0, split), consumed));
+        total += consumed;
+        ASSERT_TRUE(parser.Parse(input.substr(split), consumed));
+        total += consumed;
+        ASSERT_EQ(23, total);
+        ASSERT_EQ("ms", parser.Name());
+
+        size_t value_size;
+        std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+        ASSERT_EQ(6, value_size);
+        Execute::MetaSet *set = dynamic_cast<Execute::MetaSet *>(cmd.get());
+        ASSERT_TRUE(set != nullptr);
+        ASSERT_EQ("foo", set->key());
+        ASSERT_EQ(std::vector<std::string>({"T30", "F5", "q", "Oab"}), set->flags());
+    }
+
+    size_t consumed = 0, value_size = 0;
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("mg some_long_key_of_meta_get v f t c\r\n", consumed));
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    Execute::MetaGet *get = dynamic_cast<Execute::MetaGet *>(cmd.get());
+    ASSERT_TRUE(get != nullptr);
+    ASSERT_EQ("some_long_key_of_meta_get", get->key());
+    ASSERT_EQ(4, get->flags().size());
+    ASSERT_EQ(0, value_size);
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("ma counter\r\n", consumed));
+    cmd = parser.Build(value_size);
+    Execute::MetaArithmetic *ma = dynamic_cast<Execute::MetaArithmetic *>(cmd.get());
+    ASSERT_TRUE(ma != nullptr);
+    ASSERT_EQ("counter", ma->key());
+    ASSERT_TRUE(ma->flags().empty());
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("mn\r\n", consumed));
+    ASSERT_EQ(4, consumed);
+    cmd = parser.Build(value_size);
+    ASSERT_TRUE(dynamic_cast<Execute::MetaNoOp *>(cmd.get()) != nullptr);
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("ms foo T30\r\n", consumed));
+    ASSERT_THROW(parser.Build(value_size), std::runtime_error);
+}
+
+// Verify noreply token of storage commands and delete
+TEST(MemcachedParserTest, NoReply) {
+    Protocol::Parser parser;
+    size_t consumed = 0, value_size = 0;
+
+    ASSERT_TRUE(parser.Parse("set foo 0 0 6 noreply\r\nfooval\r\n", consumed));
+    ASSERT_EQ(23, consumed);
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_EQ(6, value_size);
+    ASSERT_TRUE(cmd->NoReply());
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("replace foo 1 0 3\r\n", consumed));
+    cmd = parser.Build(value_size);
+    ASSERT_TRUE(dynamic_cast<Execute::Replace *>(cmd.get()) != nullptr);
+    ASSERT_FALSE(cmd->NoReply());
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("cas foo 0 0 3 42 noreply\r\n", consumed));
+    cmd = parser.Build(value_size);
+    ASSERT_EQ(42, reinterpret_cast<Execute::Cas *>(cmd.get())->cas());
+    ASSERT_TRUE(cmd->NoReply());
+
+    // Token could be split between inputs
+    std::string input = "delete some_key noreply\r\n";
+    for (size_t split = 1; split < input.size(); ++split) {
+        parser.Reset();
+        ASSERT_FALSE(parser.Parse(input.substr(0, split), consumed));
+        ASSERT_TRUE(parser.Parse(input.substr(split), consumed));
+        cmd = parser.Build(value_size);
+        Execute::Delete *del = dynamic_cast<Execute::Delete *>(cmd.get());
+        ASSERT_TRUE(del != nullptr);
+        ASSERT_EQ("some_key", del->key());
+        ASSERT_TRUE(cmd->NoReply());
+    }
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("delete foo\r\n", consumed));
+    cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd->NoReply());
+
+    parser.Reset();
+    ASSERT_THROW(parser.Parse("delete foo please\r\n", consumed), std::runtime_error);
+}
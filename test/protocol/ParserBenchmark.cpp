@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <protocol/Parser.h>
+
+/**
+ * Measures throughput of the memcached text parser. Usage:
+ *
+ *   runParserBenchmark [commands count]
+ *
+ * Stream of get commands with 1 to 4 keys and headers of set commands, keys are 10 to 40 bytes long, is
+ * parsed as it would come from the socket: whole, then cut into pieces of 16 and of 1 byte that end in the
+ * middle of fields. Each line shows how many nanoseconds parsing of one command takes and input bytes
+ * per second.
+ *
+ * Build with CMAKE_BUILD_TYPE=Release
+ */
+
+static std::string make_input(std::size_t count) {
+    uint64_t seed = 88172645463325252ull;
+    auto rng = [&seed]() {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return seed;
+    };
+    auto key = [&rng]() {
+        std::string key = "key:";
+        std::size_t size = 10 + rng() % 31;
+        while (key.size() < size) {
+            key.push_back('a' + rng() % 26);
+        }
+        return key;
+    };
+
+    std::string input;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (rng() % 4 == 0) {
+            input += "set " + key() + " " + std::to_string(rng() % 65536) + " 3600 " + std::to_string(rng() % 4096) +
+                     "\r\n";
+        } else {
+            input += "get";
+            for (std::size_t n = 1 + rng() % 4; n > 0; --n) {
+                input += " " + key();
+            }
+            input += "\r\n";
+        }
+    }
+    return input;
+}
+
+static void run(const std::string &input, std::size_t count, std::size_t piece) {
+    Afina::Protocol::Parser parser;
+    std::size_t commands = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t pos = 0;
+    while (pos < input.size()) {
+        std::size_t end = std::min(input.size(), pos + piece);
+        while (pos < end) {
+            std::size_t parsed = 0;
+            if (parser.Parse(input.data() + pos, end - pos, parsed)) {
+                commands++;
+                parser.Reset();
+            }
+            pos += parsed;
+        }
+    }
+    auto done = std::chrono::steady_clock::now();
+
+    if (commands != count) {
+        std::cerr << "Parsed " << commands << " commands of " << count << std::endl;
+        std::exit(1);
+    }
+    double seconds = std::chrono::duration<double>(done - start).count();
+    std::cout << "piece=" << piece << "B\t" << seconds * 1e9 / count << " ns/command\t"
+              << input.size() / seconds / (1 << 20) << " MB/s" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    std::size_t count = 5000000;
+    if (argc > 1) {
+        count = std::strtoull(argv[1], nullptr, 10);
+    }
+
+    std::string input = make_input(count);
+    for (std::size_t piece : {input.size(), std::size_t(16), std::size_t(1)}) {
+        run(input, count, piece);
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/SimpleLRU.h"
+#include "storage/StripedLockLRU.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+#include "Workload.h"
+
+using namespace Afina::Backend;
+
+/**
+ * Compares exact LRU with CLOCK policy. Usage:
+ *
+ *   runClockBenchmark [keys count] [max threads]
+ *
+ * - hit ratio of both policies on Zipf(0.99) trace for caches of 1%, 5% and 10% of the key space
+ * - throughput of 95% reads workload on 1..32 threads for global lock, striped and lock free read storages
+ */
+
+static const std::string value(32, 'v');
+
+static double hit_ratio(SimpleLRU::EvictionPolicy policy, const std::vector<std::string> &trace, std::size_t size) {
+    SimpleLRU storage(size, SimpleLRU::IndexType::Hash, policy);
+    std::size_t hits = 0;
+    std::string out;
+    for (auto &key : trace) {
+        if (storage.Get(key, out)) {
+            hits++;
+        } else {
+            storage.Put(key, value);
+        }
+    }
+    return double(hits) / trace.size();
+}
+
+static double throughput(Afina::Storage &storage, const Zipf &zipf, std::size_t n_keys, int n_threads) {
+    for (std::size_t i = 0; i < n_keys; ++i) {
+        storage.Put(trace_key(i), value);
+    }
+
+    const std::size_t ops = 200000;
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n_threads; ++t) {
+        threads.emplace_back([&, t]() {
+            XorShift rnd(t + 1);
+            std::string out;
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            for (std::size_t i = 0; i < ops; ++i) {
+                std::string key = trace_key(zipf(rnd));
+                if (rnd() % 100 < 5) {
+                    storage.Put(key, value);
+                } else {
+                    storage.Get(key, out);
+                }
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true);
+    for (auto &t : threads) {
+        t.join();
+    }
+    double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return ops * n_threads / sec / 1e6;
+}
+
+int main(int argc, char **argv) {
+    std::size_t n_keys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    int max_threads = argc > 2 ? std::atoi(argv[2]) : 32;
+
+    Zipf zipf(n_keys, 0.99);
+    XorShift rnd;
+    std::vector<std::string> trace;
+    for (std::size_t i = 0; i < n_keys * 20; ++i) {
+        trace.push_back(trace_key(zipf(rnd)));
+    }
+
+    std::size_t item_size = trace_key(0).size() + value.size();
+    std::cout << "# hit ratio, zipf 0.99, " << n_keys << " keys, " << trace.size() << " requests" << std::endl;
+    for (int percent : {1, 5, 10}) {
+        std::size_t size = n_keys * item_size * percent / 100;
+        std::cout << "cache=" << percent << "%\tlru=" << hit_ratio(SimpleLRU::EvictionPolicy::LRU, trace, size)
+                  << "\tclock=" << hit_ratio(SimpleLRU::EvictionPolicy::Clock, trace, size) << std::endl;
+    }
+
+    std::cout << "# throughput, Mops/s, 95% reads" << std::endl;
+    // Everything fits, StripedLockLRU needs at least 1MB per shard
+    std::size_t size = std::max<std::size_t>(n_keys * item_size * 2, 16 << 20);
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        using P = SimpleLRU::EvictionPolicy;
+        ThreadSafeSimplLRU mt_lru(size, SimpleLRU::IndexType::Hash, P::LRU);
+        ThreadSafeSimplLRU mt_clock(size, SimpleLRU::IndexType::Hash, P::Clock);
+        StripedLockLRU mt_stl_lru(size, 8, SimpleLRU::IndexType::Hash, P::LRU);
+        StripedLockLRU mt_stl_clock(size, 8, SimpleLRU::IndexType::Hash, P::Clock);
+        StripedLockLRU mt_stl_lockfree(size, 8, SimpleLRU::IndexType::Hash, P::Clock, true);
+
+        std::cout << "threads=" << threads << "\tmt_lru=" << throughput(mt_lru, zipf, n_keys, threads)
+                  << "\tmt_clock=" << throughput(mt_clock, zipf, n_keys, threads)
+                  << "\tmt_stl_lru=" << throughput(mt_stl_lru, zipf, n_keys, threads)
+                  << "\tmt_stl_clock=" << throughput(mt_stl_clock, zipf, n_keys, threads)
+                  << "\tmt_stl_lockfree=" << throughput(mt_stl_lockfree, zipf, n_keys, threads) << std::endl;
+    }
+    return 0;
+}
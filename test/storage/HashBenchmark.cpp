@@ -0,0 +1,76 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <afina/KeyHash.h>
+
+#include "Workload.h"
+
+/**
+ * Measures hashing throughput of short keys, KeyHash against std::hash. Usage:
+ *
+ *   runHashBenchmark [hashes count]
+ *
+ * Keys are 10 to 40 bytes long, typical for memcached. Each line shows how many nanoseconds one hash takes
+ * and how many keys of 1M land into the fullest of 1024 buckets taken from the low bits, which is ~1100
+ * for the well mixed hash.
+ *
+ * Build with CMAKE_BUILD_TYPE=Release, otherwise KeyHash isn't inlined while std::hash comes optimized
+ * from the standard library
+ */
+
+static std::vector<std::string> make_keys(std::size_t size, std::size_t count) {
+    XorShift rng(size);
+    std::vector<std::string> keys(count);
+    for (auto &key : keys) {
+        key.assign("key:");
+        while (key.size() < size) {
+            key.push_back('a' + rng() % 26);
+        }
+    }
+    return keys;
+}
+
+template <typename Hash> static void run(const char *name, Hash hash, std::size_t size, std::size_t n_hashes) {
+    const std::size_t n_keys = 1 << 20;
+    std::vector<std::string> keys = make_keys(size, n_keys);
+
+    // Result is accumulated, so that compiler can't throw hashing away
+    std::size_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < n_hashes; ++i) {
+        sum += hash(keys[i & (n_keys - 1)]);
+    }
+    auto done = std::chrono::steady_clock::now();
+
+    std::vector<std::size_t> buckets(1024);
+    std::size_t fullest = 0;
+    for (auto &key : keys) {
+        std::size_t &bucket = buckets[hash(key) % buckets.size()];
+        if (++bucket > fullest) {
+            fullest = bucket;
+        }
+    }
+
+    double ns = std::chrono::duration<double, std::nano>(done - start).count() / n_hashes;
+    std::cout << name << "\tkey=" << size << "B\t" << ns << " ns/hash\tfullest bucket=" << fullest
+              << "\t(" << (sum & 1) << ")" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    std::size_t n_hashes = 50000000;
+    if (argc > 1) {
+        n_hashes = std::strtoull(argv[1], nullptr, 10);
+    }
+
+    std::hash<std::string> std_hash;
+    for (std::size_t size : {10, 16, 24, 32, 40}) {
+        run("KeyHash", [](const std::string &key) { return Afina::KeyHash(key); }, size, n_hashes);
+        run("std::hash", std_hash, size, n_hashes);
+    }
+    return 0;
+}
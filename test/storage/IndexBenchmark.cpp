@@ -0,0 +1,78 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "storage/SimpleLRU.h"
+
+using namespace Afina::Backend;
+
+/**
+ * Measures SimpleLRU lookup throughput for both index types. Usage:
+ *
+ *   runIndexBenchmark [keys count...]
+ *
+ * By default runs on 1M, 10M and 50M keys, the last one requires ~10GB of RAM for map index
+ */
+
+// Cheap PRNG, so that benchmark measures storage and not random generator
+static inline uint64_t xorshift(uint64_t &state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+static inline void make_key(std::string &key, uint64_t i) {
+    key.assign("key:");
+    key.append(std::to_string(i));
+}
+
+static void run(SimpleLRU::IndexType type, const char *name, std::size_t n_keys, std::size_t n_lookups) {
+    const std::string value = "value";
+    SimpleLRU storage(n_keys * 64, type);
+
+    std::string key;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < n_keys; ++i) {
+        make_key(key, i);
+        storage.Put(key, value);
+    }
+    auto loaded = std::chrono::steady_clock::now();
+
+    uint64_t state = 88172645463325252ull;
+    std::size_t hits = 0;
+    std::string out;
+    for (std::size_t i = 0; i < n_lookups; ++i) {
+        // Every 4th lookup is a miss
+        uint64_t r = xorshift(state);
+        make_key(key, (r & 3) == 0 ? n_keys + r % n_keys : r % n_keys);
+        hits += storage.Get(key, out);
+    }
+    auto done = std::chrono::steady_clock::now();
+
+    double load_sec = std::chrono::duration<double>(loaded - start).count();
+    double lookup_sec = std::chrono::duration<double>(done - loaded).count();
+    std::cout << name << "\tkeys=" << n_keys << "\tload=" << (n_keys / load_sec / 1e6) << " Mops/s"
+              << "\tget=" << (n_lookups / lookup_sec / 1e6) << " Mops/s"
+              << "\thits=" << hits << "/" << n_lookups << std::endl;
+}
+
+int main(int argc, char **argv) {
+    std::vector<std::size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) {
+        sizes = {1000000, 10000000, 50000000};
+    }
+
+    const std::size_t n_lookups = 10000000;
+    for (auto n : sizes) {
+        run(SimpleLRU::IndexType::Hash, "hash", n, n_lookups);
+        run(SimpleLRU::IndexType::Map, "map", n, n_lookups);
+    }
+    return 0;
+}
@@ -1,17 +1,34 @@
 #include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <ctime>
 #include <iomanip>
 #include <iostream>
 #include <set>
+#include <thread>
 #include <vector>
 
 #include <afina/execute/Add.h>
 #include <afina/execute/Append.h>
+#include <afina/execute/Cas.h>
+#include <afina/execute/Decr.h>
 #include <afina/execute/Delete.h>
 #include <afina/execute/Get.h>
+#include <afina/execute/Incr.h>
+#include <afina/execute/Prepend.h>
 #include <afina/execute/Set.h>
+#include <afina/execute/Stats.h>
 
+#include "storage/CompactLRU.h"
+#include "storage/HashIndex.h"
+#include "storage/LockFreeReadLRU.h"
+#include "storage/MemoryBudget.h"
+#include "storage/ShardedLRU.h"
 #include "storage/SimpleLRU.h"
+#include "storage/StripedLockLRU.h"
+#include "storage/TimerWheel.h"
 
+using namespace Afina;
 using namespace Afina::Backend;
 using namespace Afina::Execute;
 using namespace std;
@@ -195,3 +212,969 @@ TEST(StorageTest, MaxTest) {
         EXPECT_FALSE(storage.Get(key, res));
     }
 }
+
+TEST(StorageTest, HashIndexPutDeleteGet) {
+    SimpleLRU storage(1024, SimpleLRU::IndexType::Hash);
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_TRUE(storage.Put("KEY3", "val3"));
+    EXPECT_FALSE(storage.PutIfAbsent("KEY3", "val4"));
+    EXPECT_TRUE(storage.Set("KEY3", "val33"));
+
+    EXPECT_TRUE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Delete("KEY1"));
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_TRUE(value == "val2");
+    EXPECT_TRUE(storage.Get("KEY3", value));
+    EXPECT_TRUE(value == "val33");
+}
+
+TEST(StorageTest, HashIndexMaxTest) {
+    const size_t length = 20;
+    SimpleLRU storage(2 * 1000 * length, SimpleLRU::IndexType::Hash);
+
+    for (long i = 0; i < 1100; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        auto val = pad_space("Val " + std::to_string(i), length);
+        EXPECT_TRUE(storage.Put(key, val));
+    }
+
+    for (long i = 100; i < 1100; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        auto val = pad_space("Val " + std::to_string(i), length);
+
+        std::string res;
+        EXPECT_TRUE(storage.Get(key, res));
+        EXPECT_TRUE(val == res);
+    }
+
+    for (long i = 0; i < 100; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+
+        std::string res;
+        EXPECT_FALSE(storage.Get(key, res));
+    }
+}
+
+struct TestNode {
+    std::string key;
+    std::size_t hash;
+
+    bool hasKey(const std::string &k) const { return key == k; }
+};
+
+TEST(StorageTest, HashIndexCollisions) {
+    // All nodes share the same home bucket and fingerprint, so index has to deal with long
+    // probe sequences and shift them back on erase
+    HashIndex<TestNode> index;
+    std::vector<TestNode> nodes(1000);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        nodes[i].key = "Key " + std::to_string(i);
+        nodes[i].hash = 42;
+        index.Insert(&nodes[i]);
+    }
+    EXPECT_EQ(1000, index.Size());
+
+    for (size_t i = 0; i < nodes.size(); i += 2) {
+        EXPECT_TRUE(index.Erase(&nodes[i]));
+    }
+    EXPECT_FALSE(index.Erase(&nodes[0]));
+    EXPECT_EQ(500, index.Size());
+
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        TestNode *found = index.Find(nodes[i].key, 42);
+        if (i % 2 == 0) {
+            EXPECT_TRUE(found == nullptr);
+        } else {
+            EXPECT_TRUE(found == &nodes[i]);
+        }
+    }
+}
+
+TEST(StorageTest, ChangeValueSize) {
+    for (auto type : {SimpleLRU::IndexType::Map, SimpleLRU::IndexType::Hash}) {
+        SimpleLRU storage(1024, type);
+
+        EXPECT_TRUE(storage.Put("KEY1", "val1"));
+        EXPECT_TRUE(storage.Put("KEY2", "val2"));
+
+        // Grow: node moves into a bigger block
+        std::string value;
+        EXPECT_TRUE(storage.Set("KEY1", std::string(100, 'a')));
+        EXPECT_TRUE(storage.Get("KEY1", value));
+        EXPECT_TRUE(value == std::string(100, 'a'));
+
+        // Shrink a bit: reuses the block
+        EXPECT_TRUE(storage.Put("KEY1", std::string(60, 'b')));
+        EXPECT_TRUE(storage.Get("KEY1", value));
+        EXPECT_TRUE(value == std::string(60, 'b'));
+
+        // Shrink a lot: block released
+        EXPECT_TRUE(storage.Put("KEY1", "c"));
+        EXPECT_TRUE(storage.Get("KEY1", value));
+        EXPECT_TRUE(value == "c");
+
+        EXPECT_TRUE(storage.Get("KEY2", value));
+        EXPECT_TRUE(value == "val2");
+        EXPECT_TRUE(storage.Delete("KEY1"));
+        EXPECT_TRUE(storage.Delete("KEY2"));
+        EXPECT_GT(storage.ItemOverhead(), 0);
+    }
+}
+
+TEST(StorageTest, ValueHandleOutlivesItem) {
+    for (auto type : {SimpleLRU::IndexType::Map, SimpleLRU::IndexType::Hash}) {
+        SimpleLRU storage(1024, type);
+        EXPECT_TRUE(storage.Put("KEY1", "val1"));
+
+        Afina::Value before;
+        EXPECT_TRUE(storage.Get("KEY1", before));
+        EXPECT_EQ("val1", before.str());
+
+        // Same size value: block is shared with the handle, so can't be overwritten in place
+        EXPECT_TRUE(storage.Set("KEY1", "VAL1"));
+        Afina::Value after;
+        EXPECT_TRUE(storage.Get("KEY1", after));
+        EXPECT_EQ("VAL1", after.str());
+        EXPECT_EQ("val1", before.str());
+
+        EXPECT_TRUE(storage.Delete("KEY1"));
+        EXPECT_FALSE(storage.Get("KEY1", before));
+        EXPECT_EQ("VAL1", after.str());
+    }
+
+    Afina::Value copy = Afina::Value::Copy("abc");
+    Afina::Value other = copy;
+    copy = Afina::Value();
+    EXPECT_EQ("abc", other.str());
+}
+
+TEST(StorageTest, ClockSecondChance) {
+    const size_t length = 20;
+    SimpleLRU storage(3 * 2 * length, SimpleLRU::IndexType::Hash, SimpleLRU::EvictionPolicy::Clock);
+
+    auto key = [length](int i) { return pad_space("Key " + std::to_string(i), length); };
+    auto val = [length](int i) { return pad_space("Val " + std::to_string(i), length); };
+
+    EXPECT_TRUE(storage.Put(key(1), val(1)));
+    EXPECT_TRUE(storage.Put(key(2), val(2)));
+    EXPECT_TRUE(storage.Put(key(3), val(3)));
+
+    // KEY1 is the oldest one, but referenced, so KEY2 gets evicted instead
+    std::string value;
+    EXPECT_TRUE(storage.Get(key(1), value));
+    EXPECT_TRUE(storage.Put(key(4), val(4)));
+
+    EXPECT_TRUE(storage.Get(key(1), value));
+    EXPECT_TRUE(value == val(1));
+    EXPECT_FALSE(storage.Get(key(2), value));
+    EXPECT_TRUE(storage.Get(key(3), value));
+    EXPECT_TRUE(storage.Get(key(4), value));
+
+    // Everything is referenced now: full round clears marks and evicts in insertion order
+    EXPECT_TRUE(storage.Put(key(5), val(5)));
+    EXPECT_FALSE(storage.Get(key(3), value));
+    EXPECT_TRUE(storage.Get(key(1), value));
+}
+
+TEST(StorageTest, LockFreeReadPutDeleteGet) {
+    LockFreeReadLRU storage(1024 * 1024);
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.PutIfAbsent("KEY2", "val2"));
+    EXPECT_FALSE(storage.PutIfAbsent("KEY2", "val3"));
+    EXPECT_TRUE(storage.Set("KEY1", "val4"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_TRUE(value == "val4");
+
+    // Handle keeps value even when item is replaced and deleted
+    Afina::Value handle;
+    EXPECT_TRUE(storage.Get("KEY2", handle));
+    EXPECT_TRUE(storage.Put("KEY2", "val5"));
+    EXPECT_TRUE(storage.Delete("KEY2"));
+    EXPECT_FALSE(storage.Get("KEY2", value));
+    EXPECT_TRUE(handle.str() == "val2");
+
+    // Enough items to rehash index and reclaim retired nodes a few times
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_TRUE(storage.Put("Key " + std::to_string(i), "Val " + std::to_string(i)));
+    }
+    for (int i = 0; i < 10000; i += 2) {
+        EXPECT_TRUE(storage.Delete("Key " + std::to_string(i)));
+    }
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_EQ(storage.Get("Key " + std::to_string(i), value), i % 2 == 1);
+    }
+}
+
+TEST(StorageTest, LockFreeReadConcurrentWriter) {
+    LockFreeReadLRU storage(1024 * 1024);
+
+    // Stable keys are never deleted, so reader must always find them despite writer moving index slots
+    const int n_stable = 1000;
+    for (int i = 0; i < n_stable; ++i) {
+        storage.Put("Stable " + std::to_string(i), "Val " + std::to_string(i));
+    }
+
+    std::atomic<bool> stop(false);
+    std::atomic<int> errors(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&, t]() {
+            std::string value;
+            for (int i = t; !stop.load(); i = (i + 7) % n_stable) {
+                if (!storage.Get("Stable " + std::to_string(i), value) || value != "Val " + std::to_string(i)) {
+                    errors++;
+                }
+                // Value of churned key is either absent or matches the key
+                if (storage.Get("Churn " + std::to_string(i), value) && value != "Churn " + std::to_string(i)) {
+                    errors++;
+                }
+            }
+        });
+    }
+
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < n_stable; ++i) {
+            storage.Put("Churn " + std::to_string(i), "Churn " + std::to_string(i));
+            storage.Set("Stable " + std::to_string(i), "Val " + std::to_string(i));
+        }
+        for (int i = 0; i < n_stable; ++i) {
+            storage.Delete("Churn " + std::to_string(i));
+        }
+        std::this_thread::yield();
+    }
+    stop.store(true);
+    for (auto &t : readers) {
+        t.join();
+    }
+    EXPECT_EQ(errors.load(), 0);
+}
+
+TEST(StorageTest, LockFreeReadCounterInPlace) {
+    LockFreeReadLRU storage(1024 * 1024);
+    storage.Put("Counter", "0");
+
+    // Counter is rewritten in place, handle taken by reader never changes and numbers only grow
+    std::atomic<bool> stop(false);
+    std::atomic<int> errors(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&, t]() {
+            uint64_t last = 0;
+            std::string copy;
+            while (!stop.load()) {
+                Value value;
+                if (!storage.Get("Counter", value)) {
+                    errors++;
+                    continue;
+                }
+                std::string seen = value.str();
+                uint64_t number = std::stoull(seen);
+                if (number < last || (t % 2 == 0 && (!storage.Get("Counter", copy) || std::stoull(copy) < number))) {
+                    errors++;
+                }
+                last = number;
+                std::this_thread::yield();
+                if (value.str() != seen) {
+                    errors++;
+                }
+            }
+        });
+    }
+
+    uint64_t result = 0;
+    for (int i = 0; i < 100000; ++i) {
+        storage.Increment("Counter", 1, result);
+    }
+    stop.store(true);
+    for (auto &t : readers) {
+        t.join();
+    }
+    EXPECT_EQ(result, 100000);
+    EXPECT_EQ(errors.load(), 0);
+}
+
+TEST(StorageTest, TinyLFUPutDeleteGet) {
+    for (auto index : {SimpleLRU::IndexType::Map, SimpleLRU::IndexType::Hash}) {
+        SimpleLRU storage(1024 * 1024, index, SimpleLRU::EvictionPolicy::TinyLFU);
+        for (int i = 0; i < 1000; ++i) {
+            EXPECT_TRUE(storage.Put("Key " + std::to_string(i), "Val " + std::to_string(i)));
+        }
+        for (int i = 0; i < 1000; i += 2) {
+            EXPECT_TRUE(storage.Delete("Key " + std::to_string(i)));
+        }
+        // Promote part of items to protected segment and change values of some of them
+        std::string value;
+        for (int i = 0; i < 1000; i += 3) {
+            EXPECT_EQ(storage.Get("Key " + std::to_string(i), value), i % 2 == 1);
+            storage.Set("Key " + std::to_string(i), "New " + std::to_string(i));
+        }
+        for (int i = 0; i < 1000; ++i) {
+            EXPECT_EQ(storage.Get("Key " + std::to_string(i), value), i % 2 == 1);
+            if (i % 2 == 1) {
+                EXPECT_EQ(value, (i % 3 == 0 ? "New " : "Val ") + std::to_string(i));
+            }
+        }
+    }
+}
+
+TEST(StorageTest, TinyLFUScanResistance) {
+    const size_t length = 20;
+    const int n_hot = 50;
+    auto key = [length](const std::string &prefix, int i) { return pad_space(prefix + std::to_string(i), length); };
+
+    // Hot set takes half of the storage and is in use all the time, while two one-off keys come for each
+    // hot access. Reuse distance of hot keys is 1.5 of storage size, so LRU loses them
+    auto hot_hits = [&](SimpleLRU::EvictionPolicy policy) {
+        SimpleLRU storage(2 * length * 100, SimpleLRU::IndexType::Hash, policy);
+        std::string value;
+        int hits = 0;
+        for (int i = 0; i < 20 * n_hot; ++i) {
+            for (auto k : {key("Hot ", i % n_hot), key("Scan ", 2 * i), key("Scan ", 2 * i + 1)}) {
+                if (storage.Get(k, value)) {
+                    hits += k[0] == 'H';
+                } else {
+                    storage.Put(k, k);
+                }
+            }
+        }
+        return hits;
+    };
+
+    EXPECT_LT(hot_hits(SimpleLRU::EvictionPolicy::LRU), n_hot);
+    EXPECT_GT(hot_hits(SimpleLRU::EvictionPolicy::TinyLFU), 18 * n_hot);
+}
+
+TEST(StorageTest, TimerWheelFiresOnTime) {
+    struct Timer : public TimerWheel::Hook {};
+    const uint32_t start = 1000000;
+    TimerWheel wheel(start);
+
+    // Distances hit every level of the wheel and the farthest parking slot
+    std::vector<uint32_t> delays = {1, 2, 63, 64, 65, 100, 4095, 4096, 4097, 300000, 20000000};
+    std::vector<Timer> timers(delays.size());
+    for (size_t i = 0; i < delays.size(); ++i) {
+        timers[i].prev = timers[i].next = nullptr;
+        timers[i].expire = start + delays[i];
+        wheel.Schedule(timers[i]);
+    }
+    // Canceled timer never fires
+    Timer canceled;
+    canceled.prev = canceled.next = nullptr;
+    canceled.expire = start + 10;
+    wheel.Schedule(canceled);
+    wheel.Cancel(canceled);
+    EXPECT_EQ(wheel.Size(), delays.size());
+
+    std::vector<uint32_t> fired(delays.size(), 0);
+    uint32_t now = start;
+    auto advance = [&](uint32_t to) {
+        for (; now < to; ++now) {
+            wheel.Advance(now + 1, [&](TimerWheel::Hook &hook) {
+                fired[static_cast<Timer *>(&hook) - timers.data()] = now + 1;
+            });
+        }
+    };
+    advance(start + 300001);
+    for (size_t i = 0; i + 1 < delays.size(); ++i) {
+        EXPECT_EQ(fired[i], start + delays[i]);
+    }
+    EXPECT_EQ(fired.back(), 0);
+
+    // Long jump fires the rest
+    wheel.Advance(start + 20000000, [&](TimerWheel::Hook &hook) {
+        fired[static_cast<Timer *>(&hook) - timers.data()] = start + 20000000;
+    });
+    EXPECT_EQ(fired.back(), start + 20000000);
+    EXPECT_EQ(wheel.Size(), 0);
+}
+
+TEST(StorageTest, ExpiredItemsAreInvisible) {
+    uint32_t now = std::time(nullptr);
+    SimpleLRU storage(1024, SimpleLRU::IndexType::Hash);
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1", ItemMeta(0, now - 1)));
+    EXPECT_TRUE(storage.Put("KEY2", "val2", ItemMeta(0, now + 1000)));
+    EXPECT_TRUE(storage.Put("KEY3", "val3"));
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_TRUE(storage.Get("KEY3", value));
+
+    Afina::Value handle;
+    ItemMeta meta;
+    EXPECT_TRUE(storage.Get("KEY2", handle, meta));
+    EXPECT_EQ(meta.expire, now + 1000);
+
+    // Update resets expiration
+    EXPECT_TRUE(storage.Set("KEY2", "val4", ItemMeta(0, now - 1)));
+    EXPECT_FALSE(storage.Get("KEY2", value));
+}
+
+TEST(StorageTest, ExpiredItemsAreReclaimedFirst) {
+    const size_t length = 20;
+    auto key = [length](int i) { return pad_space("Key " + std::to_string(i), length); };
+
+    uint32_t expire = std::time(nullptr) + 1;
+    SimpleLRU storage(10 * 2 * length, SimpleLRU::IndexType::Hash);
+    for (int i = 0; i < 10; ++i) {
+        // Oldest half is live, freshest one expires
+        EXPECT_TRUE(storage.Put(key(i), key(i), ItemMeta(0, i < 5 ? 0 : expire)));
+    }
+    while (uint32_t(std::time(nullptr)) <= expire) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    // New items take space of expired ones instead of evicting LRU victims
+    for (int i = 10; i < 15; ++i) {
+        EXPECT_TRUE(storage.Put(key(i), key(i)));
+    }
+    std::string value;
+    for (int i = 0; i < 15; ++i) {
+        EXPECT_EQ(storage.Get(key(i), value), i < 5 || i >= 10);
+    }
+}
+
+TEST(StorageTest, FlagsRoundTrip) {
+    SimpleLRU storage(1024, SimpleLRU::IndexType::Hash);
+    std::string out;
+
+    Afina::Execute::Set set("KEY1", 42, 0);
+    set.Execute(storage, "val1", out);
+    EXPECT_EQ(out, "STORED");
+    Afina::Execute::Add add("KEY2", 7, 0);
+    add.Execute(storage, "val2", out);
+    EXPECT_EQ(out, "STORED");
+
+    // Append keeps flags of the item
+    Afina::Execute::Append append("KEY1", 13, 0);
+    append.Execute(storage, "+", out);
+    EXPECT_EQ(out, "STORED");
+
+    Afina::Execute::Get get({"KEY1", "KEY3", "KEY2"});
+    get.Execute(storage, "", out);
+    EXPECT_EQ(out, "VALUE KEY1 42 5\r\nval1+\r\nVALUE KEY2 7 4\r\nval2\r\nEND");
+}
+
+TEST(StorageTest, BatchPutGet) {
+    std::vector<std::unique_ptr<SimpleLRU>> storages;
+    storages.emplace_back(new SimpleLRU(1024 * 1024, SimpleLRU::IndexType::Map));
+    storages.emplace_back(new SimpleLRU(1024 * 1024, SimpleLRU::IndexType::Hash, SimpleLRU::EvictionPolicy::TinyLFU));
+    storages.emplace_back(new LockFreeReadLRU(1024 * 1024));
+    storages.emplace_back(new StripedLockLRU(4 * 1024 * 1024, 4, SimpleLRU::IndexType::Hash));
+    storages.emplace_back(new StripedLockLRU(4 * 1024 * 1024, 4, SimpleLRU::IndexType::Map,
+                                             SimpleLRU::EvictionPolicy::LRU, true));
+
+    for (auto &storage : storages) {
+        std::vector<std::string> keys, values;
+        std::vector<ItemMeta> metas;
+        for (int i = 0; i < 100; ++i) {
+            keys.push_back("Key " + std::to_string(i));
+            values.push_back("Val " + std::to_string(i));
+            metas.push_back(ItemMeta(i));
+        }
+        std::vector<bool> stored;
+        storage->PutMany(keys, values, metas, stored);
+        ASSERT_EQ(stored.size(), keys.size());
+        for (bool ok : stored) {
+            EXPECT_TRUE(ok);
+        }
+
+        // Every third key is missing, keys come in order different from the one they were stored
+        std::vector<std::string> lookup;
+        for (int i = 149; i >= 0; --i) {
+            lookup.push_back((i % 3 == 0 ? "Missing " : "Key ") + std::to_string(i));
+        }
+        std::vector<LookupResult> results;
+        storage->GetMany(lookup, results);
+        ASSERT_EQ(results.size(), lookup.size());
+        for (std::size_t j = 0; j < lookup.size(); ++j) {
+            int i = 149 - j;
+            EXPECT_EQ(results[j].found, i % 3 != 0 && i < 100);
+            if (results[j].found) {
+                EXPECT_EQ(results[j].value.str(), "Val " + std::to_string(i));
+                EXPECT_EQ(results[j].meta.flags, i);
+            }
+        }
+    }
+}
+
+TEST(StorageTest, AppendPrepend) {
+    std::vector<std::unique_ptr<SimpleLRU>> storages;
+    storages.emplace_back(new SimpleLRU(1024, SimpleLRU::IndexType::Map));
+    storages.emplace_back(new SimpleLRU(1024, SimpleLRU::IndexType::Hash, SimpleLRU::EvictionPolicy::TinyLFU));
+    storages.emplace_back(new LockFreeReadLRU(1024));
+
+    for (auto &storage : storages) {
+        EXPECT_FALSE(storage->Append("KEY", "x"));
+        EXPECT_FALSE(storage->Prepend("KEY", "x"));
+        EXPECT_TRUE(storage->Put("KEY", "", ItemMeta(5)));
+
+        // Handle taken in between keeps seeing the value it was given
+        Value before;
+        std::string expected;
+        for (int i = 0; i < 100; ++i) {
+            std::string data = std::to_string(i % 10);
+            if (i % 2) {
+                EXPECT_TRUE(storage->Append("KEY", data));
+                expected += data;
+            } else {
+                EXPECT_TRUE(storage->Prepend("KEY", data));
+                expected = data + expected;
+            }
+            if (i == 50) {
+                EXPECT_TRUE(storage->Get("KEY", before));
+            }
+        }
+        EXPECT_EQ(before.size(), 51);
+
+        Value value;
+        ItemMeta meta;
+        EXPECT_TRUE(storage->Get("KEY", value, meta));
+        EXPECT_EQ(value.str(), expected);
+        EXPECT_EQ(meta.flags, 5);
+
+        // Value that outgrows storage isn't changed
+        EXPECT_FALSE(storage->Append("KEY", std::string(1024, 'x')));
+        EXPECT_TRUE(storage->Get("KEY", value));
+        EXPECT_EQ(value.str(), expected);
+    }
+
+    SimpleLRU storage(1024);
+    std::string out;
+    storage.Put("KEY", "val");
+    Afina::Execute::Prepend prepend("KEY", 0, 0);
+    prepend.Execute(storage, "pre-", out);
+    EXPECT_EQ(out, "STORED");
+    Afina::Execute::Append append("KEY", 0, 0);
+    append.Execute(storage, "-post", out);
+    EXPECT_EQ(out, "STORED");
+    prepend.Execute(storage, "x", out);
+    EXPECT_TRUE(storage.Get("KEY", out));
+    EXPECT_EQ(out, "xpre-val-post");
+}
+
+TEST(StorageTest, CompareAndSet) {
+    std::vector<std::unique_ptr<SimpleLRU>> storages;
+    storages.emplace_back(new SimpleLRU(1024, SimpleLRU::IndexType::Map));
+    storages.emplace_back(new LockFreeReadLRU(1024));
+    storages.emplace_back(new StripedLockLRU(4 * 1024 * 1024, 4, SimpleLRU::IndexType::Hash));
+
+    for (auto &storage : storages) {
+        Value value;
+        ItemMeta meta;
+        EXPECT_EQ(storage->CompareAndSet("KEY", "val", ItemMeta(), 0), CasResult::NotFound);
+
+        // Every write changes version, even the one of the same value
+        EXPECT_TRUE(storage->Put("KEY", "val1"));
+        EXPECT_TRUE(storage->Get("KEY", value, meta));
+        uint64_t first = meta.cas;
+        EXPECT_TRUE(storage->Set("KEY", "val1"));
+        EXPECT_TRUE(storage->Get("KEY", value, meta));
+        EXPECT_NE(meta.cas, first);
+        EXPECT_EQ(storage->CompareAndSet("KEY", "val2", ItemMeta(), first), CasResult::Exists);
+
+        EXPECT_EQ(storage->CompareAndSet("KEY", "val2", ItemMeta(7), meta.cas), CasResult::Stored);
+        EXPECT_EQ(storage->CompareAndSet("KEY", "val3", ItemMeta(), meta.cas), CasResult::Exists);
+        EXPECT_TRUE(storage->Get("KEY", value, meta));
+        EXPECT_EQ(value.str(), "val2");
+        EXPECT_EQ(meta.flags, 7);
+
+        // Append is a write too, as well as delete and put back
+        EXPECT_TRUE(storage->Append("KEY", "+"));
+        EXPECT_EQ(storage->CompareAndSet("KEY", "val4", ItemMeta(), meta.cas), CasResult::Exists);
+        EXPECT_TRUE(storage->Get("KEY", value, meta));
+        EXPECT_TRUE(storage->Delete("KEY"));
+        EXPECT_TRUE(storage->Put("KEY", value.str()));
+        EXPECT_EQ(storage->CompareAndSet("KEY", "val4", ItemMeta(), meta.cas), CasResult::Exists);
+
+        // Newer version survives delete based on the stale one
+        EXPECT_EQ(storage->CompareAndDelete("NONE", meta.cas), CasResult::NotFound);
+        EXPECT_EQ(storage->CompareAndDelete("KEY", meta.cas), CasResult::Exists);
+        EXPECT_TRUE(storage->Get("KEY", value, meta));
+        EXPECT_EQ(storage->CompareAndDelete("KEY", meta.cas), CasResult::Stored);
+        EXPECT_FALSE(storage->Get("KEY", value));
+    }
+
+    SimpleLRU storage(1024);
+    std::string out;
+    Afina::Execute::Set set("KEY", 1, 0);
+    set.Execute(storage, "val", out);
+    Afina::Execute::Get gets({"KEY"}, true);
+    gets.Execute(storage, "", out);
+    uint64_t cas = std::stoull(out.substr(std::string("VALUE KEY 1 3 ").size()));
+    EXPECT_EQ(out, "VALUE KEY 1 3 " + std::to_string(cas) + "\r\nval\r\nEND");
+
+    Afina::Execute::Cas swap("KEY", 2, 0, cas);
+    swap.Execute(storage, "new", out);
+    EXPECT_EQ(out, "STORED");
+    swap.Execute(storage, "newer", out);
+    EXPECT_EQ(out, "EXISTS");
+    Afina::Execute::Cas missing("NONE", 2, 0, cas);
+    missing.Execute(storage, "new", out);
+    EXPECT_EQ(out, "NOT_FOUND");
+
+    // Swap to the item that expires right away deletes it, unless version is stale
+    Afina::Execute::Cas stale("KEY", 2, -1, cas);
+    stale.Execute(storage, "gone", out);
+    EXPECT_EQ(out, "EXISTS");
+    EXPECT_TRUE(storage.Get("KEY", out));
+    EXPECT_EQ(out, "new");
+    Value value;
+    ItemMeta meta;
+    EXPECT_TRUE(storage.Get("KEY", value, meta));
+    Afina::Execute::Cas expire("KEY", 2, -1, meta.cas);
+    expire.Execute(storage, "gone", out);
+    EXPECT_EQ(out, "STORED");
+    EXPECT_FALSE(storage.Get("KEY", out));
+}
+
+TEST(StorageTest, IncrementDecrement) {
+    std::vector<std::unique_ptr<SimpleLRU>> storages;
+    storages.emplace_back(new SimpleLRU(1024, SimpleLRU::IndexType::Map));
+    storages.emplace_back(new LockFreeReadLRU(1024));
+    storages.emplace_back(new StripedLockLRU(4 * 1024 * 1024, 4, SimpleLRU::IndexType::Hash));
+
+    for (auto &storage : storages) {
+        uint64_t result = 0;
+        EXPECT_EQ(storage->Increment("KEY", 1, result), IncrResult::NotFound);
+        EXPECT_TRUE(storage->Put("KEY", "12a"));
+        EXPECT_EQ(storage->Increment("KEY", 1, result), IncrResult::NotNumber);
+        EXPECT_TRUE(storage->Put("KEY", "99999999999999999999"));
+        EXPECT_EQ(storage->Increment("KEY", 1, result), IncrResult::NotNumber);
+
+        EXPECT_TRUE(storage->Put("KEY", "9", ItemMeta(3)));
+        EXPECT_EQ(storage->Increment("KEY", 1, result), IncrResult::Stored);
+        EXPECT_EQ(result, 10);
+
+        // Handle keeps the value it was given while counter changes
+        Value before;
+        EXPECT_TRUE(storage->Get("KEY", before));
+        for (int i = 0; i < 100; ++i) {
+            EXPECT_EQ(storage->Increment("KEY", 1000, result), IncrResult::Stored);
+        }
+        EXPECT_EQ(result, 100010);
+        EXPECT_EQ(before.str(), "10");
+
+        EXPECT_EQ(storage->Decrement("KEY", 100000, result), IncrResult::Stored);
+        EXPECT_EQ(result, 10);
+        EXPECT_EQ(storage->Decrement("KEY", 11, result), IncrResult::Stored);
+        EXPECT_EQ(result, 0);
+        EXPECT_EQ(storage->Increment("KEY", UINT64_MAX, result), IncrResult::Stored);
+        EXPECT_EQ(storage->Increment("KEY", 2, result), IncrResult::Stored);
+        EXPECT_EQ(result, 1);
+
+        Value value;
+        ItemMeta meta;
+        EXPECT_TRUE(storage->Get("KEY", value, meta));
+        EXPECT_EQ(value.str(), "1");
+        EXPECT_EQ(meta.flags, 3);
+
+        // Once nobody holds the old value, counter changes in place
+        const char *block = value.data();
+        value = Value();
+        EXPECT_EQ(storage->Increment("KEY", 41, result), IncrResult::Stored);
+        EXPECT_TRUE(storage->Get("KEY", value));
+        EXPECT_EQ(value.data(), block);
+        EXPECT_EQ(value.str(), "42");
+    }
+
+    SimpleLRU storage(1024);
+    std::string out;
+    Afina::Execute::Incr incr("KEY", 5);
+    incr.Execute(storage, "", out);
+    EXPECT_EQ(out, "NOT_FOUND");
+    storage.Put("KEY", "10");
+    incr.Execute(storage, "", out);
+    EXPECT_EQ(out, "15");
+    Afina::Execute::Decr decr("KEY", 20);
+    decr.Execute(storage, "", out);
+    EXPECT_EQ(out, "0");
+    storage.Put("KEY", "text");
+    decr.Execute(storage, "", out);
+    EXPECT_EQ(out, "CLIENT_ERROR cannot increment or decrement non-numeric value");
+}
+
+TEST(StorageTest, ShardedPutGet) {
+    ShardedLRU storage(4 * 1024 * 1024, 4, SimpleLRU::IndexType::Hash);
+    ASSERT_EQ(storage.ShardsCount(), 4);
+
+    // Each thread works with keys of its own shards only, as shard-per-thread server does
+    std::vector<std::vector<std::string>> keys(2);
+    for (int i = 0; i < 1000; ++i) {
+        std::string key = "Key " + std::to_string(i);
+        ASSERT_LT(storage.ShardOf(key), 4);
+        keys[storage.ShardOf(key) % 2].push_back(key);
+    }
+    EXPECT_FALSE(keys[0].empty());
+    EXPECT_FALSE(keys[1].empty());
+
+    std::vector<std::thread> threads;
+    for (auto &own : keys) {
+        threads.emplace_back([&storage, &own]() {
+            for (auto &key : own) {
+                EXPECT_TRUE(storage.Put(key, "Val" + key));
+                EXPECT_TRUE(storage.Append(key, "!"));
+            }
+            for (std::size_t i = 0; i < own.size(); i += 2) {
+                EXPECT_TRUE(storage.Delete(own[i]));
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    std::vector<std::string> lookup(keys[0]);
+    lookup.insert(lookup.end(), keys[1].begin(), keys[1].end());
+    std::vector<LookupResult> results;
+    storage.GetMany(lookup, results);
+    ASSERT_EQ(results.size(), lookup.size());
+    for (std::size_t i = 0; i < lookup.size(); ++i) {
+        std::size_t pos = i < keys[0].size() ? i : i - keys[0].size();
+        EXPECT_EQ(results[i].found, pos % 2 == 1);
+        if (results[i].found) {
+            EXPECT_EQ(results[i].value.str(), "Val" + lookup[i] + "!");
+        }
+    }
+}
+
+TEST(StorageTest, KeyHash) {
+    // Any single byte change of keys of all sizes around the read boundaries changes the hash
+    std::string base(100, 'k');
+    std::set<std::size_t> seen;
+    for (std::size_t size = 0; size <= base.size(); ++size) {
+        std::string key = base.substr(0, size);
+        EXPECT_EQ(KeyHash(key), KeyHash(key.data(), key.size()));
+        EXPECT_TRUE(seen.insert(KeyHash(key)).second);
+        for (std::size_t i = 0; i < size; ++i) {
+            key[i] = 'x';
+            EXPECT_TRUE(seen.insert(KeyHash(key)).second) << "size " << size << " byte " << i;
+            key[i] = 'k';
+        }
+    }
+
+    // Storages take the hash computed by the caller as is
+    std::vector<std::unique_ptr<Storage>> storages;
+    storages.emplace_back(new SimpleLRU(1024 * 1024, SimpleLRU::IndexType::Map));
+    storages.emplace_back(new LockFreeReadLRU(1024 * 1024));
+    storages.emplace_back(new StripedLockLRU(4 * 1024 * 1024, 4, SimpleLRU::IndexType::Hash));
+    storages.emplace_back(new ShardedLRU(4 * 1024 * 1024, 4));
+    for (auto &storage : storages) {
+        std::vector<std::string> keys;
+        std::vector<std::size_t> hashes;
+        for (int i = 0; i < 100; ++i) {
+            keys.push_back("Key " + std::to_string(i));
+            hashes.push_back(KeyHash(keys.back()));
+            EXPECT_TRUE(storage->Put(keys.back(), hashes.back(), "Val " + std::to_string(i), ItemMeta(i)));
+        }
+        EXPECT_FALSE(storage->PutIfAbsent(keys[5], hashes[5], "New", ItemMeta()));
+        EXPECT_TRUE(storage->PutIfAbsent("Key 100", KeyHash("Key 100"), "New", ItemMeta()));
+
+        std::vector<LookupResult> results;
+        storage->GetMany(keys, hashes, results);
+        ASSERT_EQ(results.size(), keys.size());
+        for (int i = 0; i < 100; ++i) {
+            ASSERT_TRUE(results[i].found);
+            EXPECT_EQ(results[i].value.str(), "Val " + std::to_string(i));
+            EXPECT_EQ(results[i].meta.flags, i);
+
+            std::string value;
+            EXPECT_TRUE(storage->Get(keys[i], value));
+            EXPECT_EQ(value, "Val " + std::to_string(i));
+        }
+    }
+}
+
+TEST(StorageTest, SharedMemoryBudget) {
+    // Shard takes more than its half of the budget while the other one is empty
+    MemoryBudget<SimpleLRU> budget(4000, 100);
+    SimpleLRU first(2000, SimpleLRU::IndexType::Hash), second(2000, SimpleLRU::IndexType::Hash);
+    first.ShareBudget(&budget);
+    second.ShareBudget(&budget);
+    std::string value(97, 'v');
+    for (int i = 10; i < 40; ++i) {
+        EXPECT_TRUE(first.Put("A" + std::to_string(i), value));
+    }
+    EXPECT_EQ(budget.Free(), 1000);
+
+    // Once budget is over, the oldest items of the other shard go first
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    for (int i = 10; i < 30; ++i) {
+        EXPECT_TRUE(second.Put("B" + std::to_string(i), value));
+    }
+    std::string out;
+    for (int i = 10; i < 40; ++i) {
+        EXPECT_EQ(first.Get("A" + std::to_string(i), out), i >= 20) << i;
+    }
+    for (int i = 10; i < 30; ++i) {
+        EXPECT_TRUE(second.Get("B" + std::to_string(i), out)) << i;
+    }
+
+    // Deleted items give bytes back to the budget
+    for (int i = 20; i < 40; ++i) {
+        EXPECT_TRUE(first.Delete("A" + std::to_string(i)));
+    }
+    EXPECT_GE(budget.Free(), 1800);
+
+    // All the keys of striped storage land into one shard, it grows beyond max_size / n_shards
+    StripedLockLRU striped(4 * 1024 * 1024, 4, SimpleLRU::IndexType::Hash);
+    std::vector<std::string> keys;
+    for (int i = 0; keys.size() < 2500; ++i) {
+        std::string key = "Key " + std::to_string(i);
+        if (KeyHash(key) % 4 == 0) {
+            keys.push_back(key);
+        }
+    }
+    std::string big(1024, 'x');
+    for (auto &key : keys) {
+        EXPECT_TRUE(striped.Put(key, big));
+    }
+    for (auto &key : keys) {
+        EXPECT_TRUE(striped.Get(key, out)) << key;
+    }
+}
+
+TEST(StorageTest, ManySmallShards) {
+    // Shards borrow from the budget, so small instance could have many of them
+    EXPECT_THROW(StripedLockLRU(4 * 1024 * 1024, 8192), std::runtime_error);
+    std::vector<std::unique_ptr<StripedLockLRU>> storages;
+    storages.emplace_back(new StripedLockLRU(4 * 1024 * 1024, 64, SimpleLRU::IndexType::Hash));
+    storages.emplace_back(new StripedLockLRU(4 * 1024 * 1024, 64, SimpleLRU::IndexType::Hash,
+                                             SimpleLRU::EvictionPolicy::TinyLFU));
+    storages.emplace_back(new StripedLockLRU(4 * 1024 * 1024, 64, SimpleLRU::IndexType::Map,
+                                             SimpleLRU::EvictionPolicy::LRU, true));
+
+    std::string value(1000, 'v'), out;
+    for (auto &storage : storages) {
+        for (int i = 0; i < 8000; ++i) {
+            EXPECT_TRUE(storage->Put("Key " + std::to_string(i), value));
+        }
+        std::map<std::string, uint64_t> stats;
+        storage->CollectStats(stats);
+        EXPECT_EQ(stats["limit_maxbytes"], 4 * 1024 * 1024);
+        EXPECT_LE(stats["bytes"], 4 * 1024 * 1024);
+        EXPECT_GT(stats["bytes"], 3 * 1024 * 1024);
+        EXPECT_GT(stats["evictions"], 3000);
+
+        // Items written last are there
+        for (int i = 7900; i < 8000; ++i) {
+            EXPECT_TRUE(storage->Get("Key " + std::to_string(i), out)) << i;
+        }
+    }
+}
+
+TEST(StorageTest, BackgroundEviction) {
+    // Single shard borrows one chunk of 64KB at a time, so writes below show exactly what headroom is for
+    StripedLockLRU storage(4 * 1024 * 1024, 1, SimpleLRU::IndexType::Hash, SimpleLRU::EvictionPolicy::LRU, false,
+                           true);
+    storage.Start();
+    std::string value(1000, 'v');
+    for (int i = 0; i < 8000; ++i) {
+        EXPECT_TRUE(storage.Put("Key " + std::to_string(i), value));
+    }
+
+    // Wait for reclaimer to free memory up to the low watermark of 1/32 budget, it only grows from there
+    std::map<std::string, uint64_t> stats;
+    do {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        stats.clear();
+        storage.CollectStats(stats);
+    } while (stats["reclaimer_free"] < 4 * 1024 * 1024 / 32);
+    EXPECT_GT(stats["reclaimer_runs"], 0);
+    EXPECT_GT(stats["evictions"], 3000);
+
+    // Writes that fit into the headroom never evict, 50KB take at most two chunks
+    uint64_t direct_reclaims = stats["direct_reclaims"];
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_TRUE(storage.Put("Fresh " + std::to_string(i), value));
+    }
+    stats.clear();
+    storage.CollectStats(stats);
+    EXPECT_EQ(stats["direct_reclaims"], direct_reclaims);
+    storage.Stop();
+
+    Afina::Execute::Stats command;
+    std::string out;
+    command.Execute(storage, "", out);
+    EXPECT_NE(out.find("\r\nSTAT direct_reclaims "), std::string::npos);
+    EXPECT_NE(out.find("\r\nSTAT reclaimer_runs "), std::string::npos);
+    EXPECT_EQ(out.substr(out.size() - 5), "\r\nEND");
+}
+
+TEST(StorageTest, CompactPutGet) {
+    CompactLRU storage(1024);
+    std::string value;
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_TRUE(storage.Put("KEY1", "val1", ItemMeta(7)));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_FALSE(storage.PutIfAbsent("KEY1", "other"));
+    EXPECT_FALSE(storage.Set("KEY3", "val3"));
+    EXPECT_TRUE(storage.Set("KEY2", "longer value"));
+
+    Value handle;
+    ItemMeta meta;
+    EXPECT_TRUE(storage.Get("KEY1", handle, meta));
+    EXPECT_EQ(handle.str(), "val1");
+    EXPECT_EQ(meta.flags, 7);
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ(value, "longer value");
+
+    EXPECT_TRUE(storage.Append("KEY1", "-post"));
+    EXPECT_TRUE(storage.Prepend("KEY1", "pre-"));
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ(value, "pre-val1-post");
+
+    EXPECT_TRUE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Put("KEY4", std::string(2000, 'x')));
+}
+
+TEST(StorageTest, CompactNeverFragments) {
+    const std::size_t size = 64 * 1024;
+    CompactLRU storage(size);
+
+    // Sizes churn all the time, values that don't fit into holes in between force compaction rather than
+    // eviction, so the most recent items stay
+    std::vector<std::string> keys;
+    for (int i = 0; i < 100; ++i) {
+        keys.push_back("KEY" + std::to_string(i));
+    }
+    for (int round = 0; round < 200; ++round) {
+        for (int i = 0; i < 100; ++i) {
+            std::size_t len = (round * 37 + i * 101) % 400;
+            ASSERT_TRUE(storage.Put(keys[i], std::string(len, 'a' + i % 26)));
+        }
+    }
+
+    std::map<std::string, uint64_t> stats;
+    storage.CollectStats(stats);
+    EXPECT_EQ(stats["curr_items"], 100);
+    EXPECT_EQ(stats["evictions"], 0);
+    EXPECT_EQ(stats["limit_maxbytes"], size);
+    for (int i = 0; i < 100; ++i) {
+        std::string value;
+        ASSERT_TRUE(storage.Get(keys[i], value));
+        EXPECT_EQ(value, std::string((199 * 37 + i * 101) % 400, 'a' + i % 26));
+    }
+
+    // Once values don't fit anymore the oldest ones go
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(storage.Put("NEW" + std::to_string(i), std::string(300, 'n')));
+    }
+    stats.clear();
+    storage.CollectStats(stats);
+    EXPECT_GT(stats["evictions"], 0);
+    EXPECT_LE(stats["bytes"], size);
+    std::string value;
+    EXPECT_FALSE(storage.Get(keys[0], value));
+    EXPECT_TRUE(storage.Get("NEW999", value));
+}
@@ -0,0 +1,75 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "storage/SimpleLRU.h"
+
+#include "Workload.h"
+
+using namespace Afina::Backend;
+
+/**
+ * Compares hit ratio of W-TinyLFU admission with LRU and CLOCK. Usage:
+ *
+ *   runTinyLFUBenchmark [keys count]
+ *
+ * - Zipf(0.99) trace
+ * - the same trace with a scan of one-off keys mixed in: every fourth request is a key never seen before,
+ *   like a batch job walking over ids. Hit ratio is counted for Zipf requests only
+ *
+ * Caches of 1%, 5% and 10% of the key space are measured for both traces
+ */
+
+static const std::string value(32, 'v');
+
+static double hit_ratio(SimpleLRU::EvictionPolicy policy, const std::vector<std::string> &trace, std::size_t size) {
+    SimpleLRU storage(size, SimpleLRU::IndexType::Hash, policy);
+    std::size_t hits = 0, requests = 0;
+    std::string out;
+    for (auto &key : trace) {
+        bool hit = storage.Get(key, out);
+        if (!hit) {
+            storage.Put(key, value);
+        }
+        // Scan keys are the only ones starting with 's'
+        if (key[0] != 's') {
+            hits += hit;
+            requests++;
+        }
+    }
+    return double(hits) / requests;
+}
+
+static void report(const std::string &name, const std::vector<std::string> &trace, std::size_t n_keys) {
+    using P = SimpleLRU::EvictionPolicy;
+    std::size_t item_size = trace_key(0).size() + value.size();
+    std::cout << "# " << name << ", " << n_keys << " keys, " << trace.size() << " requests" << std::endl;
+    for (int percent : {1, 5, 10}) {
+        std::size_t size = n_keys * item_size * percent / 100;
+        std::cout << "cache=" << percent << "%\tlru=" << hit_ratio(P::LRU, trace, size)
+                  << "\tclock=" << hit_ratio(P::Clock, trace, size) << "\ttinylfu=" << hit_ratio(P::TinyLFU, trace, size)
+                  << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    std::size_t n_keys = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+
+    Zipf zipf(n_keys, 0.99);
+    XorShift rnd;
+    std::vector<std::string> zipf_trace, scan_trace;
+    std::size_t scan_id = 0;
+    for (std::size_t i = 0; i < n_keys * 20; ++i) {
+        std::string key = trace_key(zipf(rnd));
+        zipf_trace.push_back(key);
+        scan_trace.push_back(key);
+        if (i % 3 == 0) {
+            scan_trace.push_back("scan:" + std::to_string(scan_id++));
+        }
+    }
+
+    report("hit ratio, zipf 0.99", zipf_trace, n_keys);
+    report("hit ratio of zipf requests, zipf 0.99 + 25% scan", scan_trace, n_keys);
+    return 0;
+}
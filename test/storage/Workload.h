@@ -0,0 +1,57 @@
+#ifndef AFINA_TEST_STORAGE_WORKLOAD_H
+#define AFINA_TEST_STORAGE_WORKLOAD_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Helpers to generate key traces for storage benchmarks
+
+// Cheap PRNG, so that benchmarks measure storage and not random generator
+class XorShift {
+public:
+    explicit XorShift(uint64_t seed = 88172645463325252ull) : _state(seed ? seed : 1) {}
+
+    inline uint64_t operator()() {
+        _state ^= _state << 13;
+        _state ^= _state >> 7;
+        _state ^= _state << 17;
+        return _state;
+    }
+
+    // Uniform double in [0, 1)
+    inline double real() { return ((*this)() >> 11) * (1.0 / 9007199254740992.0); }
+
+private:
+    uint64_t _state;
+};
+
+// Generates key ranks in [0, n) with P(k) ~ 1 / (k + 1)^s
+class Zipf {
+public:
+    Zipf(std::size_t n, double s) : _cdf(n) {
+        double sum = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            sum += 1.0 / std::pow(double(i + 1), s);
+            _cdf[i] = sum;
+        }
+        for (auto &p : _cdf) {
+            p /= sum;
+        }
+    }
+
+    inline std::size_t operator()(XorShift &rnd) const {
+        auto it = std::lower_bound(_cdf.begin(), _cdf.end(), rnd.real());
+        return std::min<std::size_t>(it - _cdf.begin(), _cdf.size() - 1);
+    }
+
+private:
+    std::vector<double> _cdf;
+};
+
+// Key for the given rank, ranks are scrambled so that popular keys don't share prefix
+inline std::string trace_key(uint64_t rank) { return "key:" + std::to_string(rank * 0x9E3779B97F4A7C15ull); }
+
+#endif // AFINA_TEST_STORAGE_WORKLOAD_H